@@ -26,8 +26,6 @@
  */
 #include "aodv-id-cache.h"
 
-#include <algorithm>
-
 namespace ns3
 {
 namespace aodv
@@ -36,30 +34,81 @@ bool
 IdCache::IsDuplicate(Ipv4Address addr, uint32_t id)
 {
     Purge();
-    for (auto i = m_idCache.begin(); i != m_idCache.end(); ++i)
+    UniqueId uniqueId = {addr, id};
+    auto i = m_idCache.find(uniqueId);
+    if (i != m_idCache.end() && i->second >= Simulator::Now())
     {
-        if (i->m_context == addr && i->m_id == id)
-        {
-            return true;
-        }
+        return true;
     }
-    UniqueId uniqueId = {addr, id, m_lifetime + Simulator::Now()};
-    m_idCache.push_back(uniqueId);
+    Time expire = m_lifetime + Simulator::Now();
+    m_idCache[uniqueId] = expire;
+    m_buckets[GetBucket(expire)].push_back(uniqueId);
     return false;
 }
 
 void
 IdCache::Purge()
 {
-    m_idCache.erase(remove_if(m_idCache.begin(), m_idCache.end(), IsExpired()), m_idCache.end());
+    // All the records of the buckets before the current one have expired.
+    int64_t current = GetBucket(Simulator::Now());
+    while (!m_buckets.empty() && m_buckets.begin()->first < current)
+    {
+        for (const auto& uniqueId : m_buckets.begin()->second)
+        {
+            auto i = m_idCache.find(uniqueId);
+            if (i != m_idCache.end() && i->second < Simulator::Now())
+            {
+                m_idCache.erase(i);
+            }
+        }
+        m_buckets.erase(m_buckets.begin());
+    }
 }
 
 uint32_t
 IdCache::GetSize()
 {
     Purge();
+    if (m_buckets.empty() || m_buckets.begin()->first != GetBucket(Simulator::Now()))
+    {
+        return m_idCache.size();
+    }
+    // Also remove the expired records of the current bucket.
+    std::vector<UniqueId>& bucket = m_buckets.begin()->second;
+    std::vector<UniqueId> remaining;
+    for (const auto& uniqueId : bucket)
+    {
+        auto i = m_idCache.find(uniqueId);
+        if (i != m_idCache.end() && i->second < Simulator::Now())
+        {
+            m_idCache.erase(i);
+        }
+        else if (i != m_idCache.end())
+        {
+            remaining.push_back(uniqueId);
+        }
+    }
+    bucket.swap(remaining);
     return m_idCache.size();
 }
 
+void
+IdCache::SetLifetime(Time lifetime)
+{
+    m_lifetime = lifetime;
+    Time width = GetBucketWidth(lifetime);
+    if (width == m_bucketWidth)
+    {
+        return;
+    }
+    // The bucket indexes depend on their width, so sort the records again.
+    m_bucketWidth = width;
+    m_buckets.clear();
+    for (const auto& [uniqueId, expire] : m_idCache)
+    {
+        m_buckets[GetBucket(expire)].push_back(uniqueId);
+    }
+}
+
 } // namespace aodv
 } // namespace ns3
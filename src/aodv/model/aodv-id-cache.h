@@ -31,6 +31,9 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/simulator.h"
 
+#include <functional>
+#include <map>
+#include <unordered_map>
 #include <vector>
 
 namespace ns3
@@ -41,6 +44,11 @@ namespace aodv
  * \ingroup aodv
  *
  * \brief Unique packets identification cache used for simple duplicate detection.
+ *
+ * The IDs are kept in a hash table, and their expiration times in buckets
+ * as wide as the current lifetime. Purging the cache drops whole buckets
+ * once they are over, without visiting the other entries;
+ * the entries of the current bucket that have expired are ignored until then.
  */
 class IdCache
 {
@@ -50,7 +58,8 @@ class IdCache
      * \param lifetime the lifetime for added entries
      */
     IdCache(Time lifetime)
-        : m_lifetime(lifetime)
+        : m_lifetime(lifetime),
+          m_bucketWidth(GetBucketWidth(lifetime))
     {
     }
 
@@ -61,7 +70,7 @@ class IdCache
      * \returns true if the pair exists
      */
     bool IsDuplicate(Ipv4Address addr, uint32_t id);
-    /// Remove all expired entries
+    /// Remove the expired entries of the buckets that are over
     void Purge();
     /**
      * \returns number of entries in cache
@@ -69,13 +78,10 @@ class IdCache
     uint32_t GetSize();
 
     /**
-     * Set lifetime for future added entries.
+     * Set lifetime for future added entries, and resize the buckets to it.
      * \param lifetime the lifetime for entries
      */
-    void SetLifetime(Time lifetime)
-    {
-        m_lifetime = lifetime;
-    }
+    void SetLifetime(Time lifetime);
 
     /**
      * Return lifetime for existing entries in cache
@@ -87,6 +93,15 @@ class IdCache
     }
 
   private:
+    /**
+     * \param lifetime a lifetime of the entries
+     * \returns the width of the buckets for this lifetime
+     */
+    static Time GetBucketWidth(Time lifetime)
+    {
+        return lifetime.IsStrictlyPositive() ? lifetime : Seconds(1);
+    }
+
     /// Unique packet ID
     struct UniqueId
     {
@@ -94,31 +109,53 @@ class IdCache
         Ipv4Address m_context;
         /// The id
         uint32_t m_id;
-        /// When record will expire
-        Time m_expire;
+
+        /**
+         * \brief Compare unique IDs
+         * \param o UniqueId to compare
+         * \return true if equal
+         */
+        bool operator==(const UniqueId& o) const
+        {
+            return m_context == o.m_context && m_id == o.m_id;
+        }
     };
 
-    /**
-     * \brief IsExpired structure
-     */
-    struct IsExpired
+    /// Hash function of unique IDs
+    struct UniqueIdHash
     {
         /**
-         * \brief Check if the entry is expired
-         *
-         * \param u UniqueId entry
-         * \return true if expired, false otherwise
+         * \brief Hash a unique ID
+         * \param u UniqueId to hash
+         * \return the hash
          */
-        bool operator()(const UniqueId& u) const
+        std::size_t operator()(const UniqueId& u) const
         {
-            return (u.m_expire < Simulator::Now());
+            return std::hash<uint64_t>()((static_cast<uint64_t>(u.m_context.Get()) << 32) |
+                                         u.m_id);
         }
     };
 
-    /// Already seen IDs
-    std::vector<UniqueId> m_idCache;
+    /**
+     * \param expire an expiration time
+     * \returns the index of the bucket of the expiration time
+     */
+    int64_t GetBucket(Time expire) const
+    {
+        return expire.GetTimeStep() / m_bucketWidth.GetTimeStep();
+    }
+
+    /// Already seen IDs, and when their records will expire
+    std::unordered_map<UniqueId, Time, UniqueIdHash> m_idCache;
+    /**
+     * IDs by bucket of expiration time. An ID may be listed in several
+     * buckets, only the one of its current expiration time is relevant.
+     */
+    std::map<int64_t, std::vector<UniqueId>> m_buckets;
     /// Default lifetime for ID records
     Time m_lifetime;
+    /// Width of the buckets of expiration times
+    Time m_bucketWidth;
 };
 
 } // namespace aodv
@@ -40,7 +40,8 @@ NS_LOG_COMPONENT_DEFINE("AodvNeighbors");
 namespace aodv
 {
 Neighbors::Neighbors(Time delay)
-    : m_ntimer(Timer::CANCEL_ON_DESTROY)
+    : m_ntimer(Timer::CANCEL_ON_DESTROY),
+      m_nextOrder(0)
 {
     m_ntimer.SetDelay(delay);
     m_ntimer.SetFunction(&Neighbors::Purge, this);
@@ -51,26 +52,17 @@ bool
 Neighbors::IsNeighbor(Ipv4Address addr)
 {
     Purge();
-    for (auto i = m_nb.begin(); i != m_nb.end(); ++i)
-    {
-        if (i->m_neighborAddress == addr)
-        {
-            return true;
-        }
-    }
-    return false;
+    return m_nb.find(addr) != m_nb.end();
 }
 
 Time
 Neighbors::GetExpireTime(Ipv4Address addr)
 {
     Purge();
-    for (auto i = m_nb.begin(); i != m_nb.end(); ++i)
+    auto i = m_nb.find(addr);
+    if (i != m_nb.end())
     {
-        if (i->m_neighborAddress == addr)
-        {
-            return (i->m_expireTime - Simulator::Now());
-        }
+        return (i->second.m_neighbor.m_expireTime - Simulator::Now());
     }
     return Seconds(0);
 }
@@ -78,42 +70,41 @@ Neighbors::GetExpireTime(Ipv4Address addr)
 void
 Neighbors::Update(Ipv4Address addr, Time expire)
 {
-    for (auto i = m_nb.begin(); i != m_nb.end(); ++i)
+    auto i = m_nb.find(addr);
+    if (i != m_nb.end())
     {
-        if (i->m_neighborAddress == addr)
+        // A later expiration time is found by Purge() at the record of the former one.
+        Neighbor& neighbor = i->second.m_neighbor;
+        neighbor.m_expireTime = std::max(expire + Simulator::Now(), neighbor.m_expireTime);
+        if (neighbor.m_hardwareAddress == Mac48Address())
         {
-            i->m_expireTime = std::max(expire + Simulator::Now(), i->m_expireTime);
-            if (i->m_hardwareAddress == Mac48Address())
+            Mac48Address hwaddr = LookupMacAddress(addr);
+            if (hwaddr != neighbor.m_hardwareAddress)
             {
-                i->m_hardwareAddress = LookupMacAddress(i->m_neighborAddress);
+                auto range = m_macIndex.equal_range(neighbor.m_hardwareAddress);
+                for (auto j = range.first; j != range.second; ++j)
+                {
+                    if (j->second == addr)
+                    {
+                        m_macIndex.erase(j);
+                        break;
+                    }
+                }
+                neighbor.m_hardwareAddress = hwaddr;
+                m_macIndex.emplace(hwaddr, addr);
             }
-            return;
         }
+        return;
     }
 
     NS_LOG_LOGIC("Open link to " << addr);
     Neighbor neighbor(addr, LookupMacAddress(addr), expire + Simulator::Now());
-    m_nb.push_back(neighbor);
+    m_nb.emplace(addr, Entry{neighbor, m_nextOrder++});
+    m_macIndex.emplace(neighbor.m_hardwareAddress, addr);
+    m_expiryQueue.emplace(neighbor.m_expireTime, addr);
     Purge();
 }
 
-/**
- * \brief CloseNeighbor structure
- */
-struct CloseNeighbor
-{
-    /**
-     * Check if the entry is expired
-     *
-     * \param nb Neighbors::Neighbor entry
-     * \return true if expired, false otherwise
-     */
-    bool operator()(const Neighbors::Neighbor& nb) const
-    {
-        return ((nb.m_expireTime < Simulator::Now()) || nb.close);
-    }
-};
-
 void
 Neighbors::Purge()
 {
@@ -122,19 +113,65 @@ Neighbors::Purge()
         return;
     }
 
-    CloseNeighbor pred;
+    // Lost neighbors, ranked in the order of insertion
+    std::vector<std::pair<uint64_t, Ipv4Address>> lost;
+    while (!m_expiryQueue.empty() && m_expiryQueue.top().first < Simulator::Now())
+    {
+        Ipv4Address addr = m_expiryQueue.top().second;
+        m_expiryQueue.pop();
+        auto i = m_nb.find(addr);
+        if (i == m_nb.end())
+        {
+            // Outdated record of a removed entry
+            continue;
+        }
+        if (i->second.m_neighbor.m_expireTime < Simulator::Now())
+        {
+            lost.emplace_back(i->second.m_order, addr);
+        }
+        else
+        {
+            // Outdated record of an extended entry
+            m_expiryQueue.emplace(i->second.m_neighbor.m_expireTime, addr);
+        }
+    }
+    for (const auto& addr : m_closed)
+    {
+        auto i = m_nb.find(addr);
+        if (i != m_nb.end())
+        {
+            lost.emplace_back(i->second.m_order, addr);
+        }
+    }
+    m_closed.clear();
+    std::sort(lost.begin(), lost.end());
+    lost.erase(std::unique(lost.begin(), lost.end()), lost.end());
+
     if (!m_handleLinkFailure.IsNull())
     {
-        for (auto j = m_nb.begin(); j != m_nb.end(); ++j)
+        for (const auto& neighbor : lost)
         {
-            if (pred(*j))
-            {
-                NS_LOG_LOGIC("Close link to " << j->m_neighborAddress);
-                m_handleLinkFailure(j->m_neighborAddress);
-            }
+            NS_LOG_LOGIC("Close link to " << neighbor.second);
+            m_handleLinkFailure(neighbor.second);
+        }
+    }
+    for (const auto& neighbor : lost)
+    {
+        auto i = m_nb.find(neighbor.second);
+        if (i == m_nb.end())
+        {
+            continue;
+        }
+        if (i->second.m_neighbor.m_expireTime < Simulator::Now() || i->second.m_neighbor.close)
+        {
+            Erase(i);
+        }
+        else
+        {
+            // Extended by the link failure callback
+            m_expiryQueue.emplace(i->second.m_neighbor.m_expireTime, neighbor.second);
         }
     }
-    m_nb.erase(std::remove_if(m_nb.begin(), m_nb.end(), pred), m_nb.end());
     m_ntimer.Cancel();
     m_ntimer.Schedule();
 }
@@ -179,14 +216,28 @@ Neighbors::ProcessTxError(const WifiMacHeader& hdr)
 {
     Mac48Address addr = hdr.GetAddr1();
 
-    for (auto i = m_nb.begin(); i != m_nb.end(); ++i)
+    auto range = m_macIndex.equal_range(addr);
+    for (auto i = range.first; i != range.second; ++i)
     {
-        if (i->m_hardwareAddress == addr)
+        m_nb.at(i->second).m_neighbor.close = true;
+        m_closed.push_back(i->second);
+    }
+    Purge();
+}
+
+void
+Neighbors::Erase(EntryMap::iterator i)
+{
+    auto range = m_macIndex.equal_range(i->second.m_neighbor.m_hardwareAddress);
+    for (auto j = range.first; j != range.second; ++j)
+    {
+        if (j->second == i->first)
         {
-            i->close = true;
+            m_macIndex.erase(j);
+            break;
         }
     }
-    Purge();
+    m_nb.erase(i);
 }
 
 } // namespace aodv
@@ -34,6 +34,11 @@
 #include "ns3/simulator.h"
 #include "ns3/timer.h"
 
+#include <functional>
+#include <map>
+#include <queue>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace ns3
@@ -49,6 +54,10 @@ class RoutingProtocol;
 /**
  * \ingroup aodv
  * \brief maintain list of active neighbors
+ *
+ * The neighbors are indexed by IPv4 and MAC address, and their expiration
+ * is driven by a queue ordered by expiration time, so that maintaining a
+ * neighbor does not visit the other ones.
  */
 class Neighbors
 {
@@ -114,6 +123,9 @@ class Neighbors
     void Clear()
     {
         m_nb.clear();
+        m_macIndex.clear();
+        m_expiryQueue = ExpiryQueue();
+        m_closed.clear();
     }
 
     /**
@@ -161,8 +173,36 @@ class Neighbors
     Callback<void, const WifiMacHeader&> m_txErrorCallback;
     /// Timer for neighbor's list. Schedule Purge().
     Timer m_ntimer;
-    /// vector of entries
-    std::vector<Neighbor> m_nb;
+
+    /// Neighbor and its rank in the order of insertion
+    struct Entry
+    {
+        Neighbor m_neighbor; //!< Neighbor
+        uint64_t m_order;    //!< Rank in the order of insertion
+    };
+
+    /// Map of entries
+    typedef std::unordered_map<Ipv4Address, Entry, Ipv4AddressHash> EntryMap;
+    /// Expiration time and address of a neighbor
+    typedef std::pair<Time, Ipv4Address> ExpiryRecord;
+    /// Min-heap of expiry records, ordered by expiration time
+    typedef std::priority_queue<ExpiryRecord, std::vector<ExpiryRecord>, std::greater<>>
+        ExpiryQueue;
+
+    /// entries, indexed by IPv4 address
+    EntryMap m_nb;
+    /// IPv4 addresses of the entries, indexed by MAC address
+    std::multimap<Mac48Address, Ipv4Address> m_macIndex;
+    /**
+     * Expiry queue of the entries. Records are not removed when an entry is
+     * extended; every entry has at least one record no later than its
+     * expiration time, and outdated records are skipped by Purge().
+     */
+    ExpiryQueue m_expiryQueue;
+    /// Addresses of the entries closed by layer 2 notifications
+    std::vector<Ipv4Address> m_closed;
+    /// Rank of the next inserted entry
+    uint64_t m_nextOrder;
     /// list of ARP cached to be used for layer 2 notifications processing
     std::vector<Ptr<ArpCache>> m_arp;
 
@@ -178,6 +218,11 @@ class Neighbors
      * \param hdr header of the packet
      */
     void ProcessTxError(const WifiMacHeader& hdr);
+    /**
+     * Remove an entry and its MAC address index
+     * \param i the entry
+     */
+    void Erase(EntryMap::iterator i);
 };
 
 } // namespace aodv
@@ -166,6 +166,13 @@ RoutingProtocol::RoutingProtocol()
       m_destinationOnly(false),
       m_gratuitousReply(true),
       m_enableHello(false),
+      m_enableLocalRepair(false),
+      m_maxRepairTtl(10),
+      m_enableMultipath(false),
+      m_enablePassiveLearning(false),
+      m_enableAdaptiveTtl(false),
+      m_maxHopCountHistory(64),
+      m_enableDirectDeferral(false),
       m_routingTable(m_deletePeriod),
       m_queue(m_maxQueueLen, m_maxQueueTime),
       m_requestId(0),
@@ -178,6 +185,7 @@ RoutingProtocol::RoutingProtocol()
       m_htimer(Timer::CANCEL_ON_DESTROY),
       m_rreqRateLimitTimer(Timer::CANCEL_ON_DESTROY),
       m_rerrRateLimitTimer(Timer::CANCEL_ON_DESTROY),
+      m_hopCountSamples(0),
       m_lastBcastTime(Seconds(0))
 {
     m_nb.SetCallback(MakeCallback(&RoutingProtocol::SendRerrWhenBreaksLinkToNextHop, this));
@@ -332,6 +340,50 @@ RoutingProtocol::GetTypeId()
                           MakeBooleanAccessor(&RoutingProtocol::SetBroadcastEnable,
                                               &RoutingProtocol::GetBroadcastEnable),
                           MakeBooleanChecker())
+            .AddAttribute("EnableLocalRepair",
+                          "Indicates whether a link break on an active route is repaired "
+                          "locally instead of being reported to the source (RFC 3561, 6.12).",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RoutingProtocol::m_enableLocalRepair),
+                          MakeBooleanChecker())
+            .AddAttribute("MaxRepairTtl",
+                          "Maximum number of hops to the destination for which a broken route "
+                          "is repaired locally.",
+                          UintegerValue(10),
+                          MakeUintegerAccessor(&RoutingProtocol::m_maxRepairTtl),
+                          MakeUintegerChecker<uint16_t>())
+            .AddAttribute("EnableMultipath",
+                          "Indicates whether several loop-free paths are kept per destination, "
+                          "as in AOMDV, to switch to another one when a link breaks.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RoutingProtocol::m_enableMultipath),
+                          MakeBooleanChecker())
+            .AddAttribute("EnablePassiveLearning",
+                          "Indicates whether routes are learned from the RREPs overheard in "
+                          "promiscuous mode and from the duplicate RREQs.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RoutingProtocol::m_enablePassiveLearning),
+                          MakeBooleanChecker())
+            .AddAttribute("EnableAdaptiveTtl",
+                          "Indicates whether the expanding ring search of a destination without "
+                          "route starts from the hop counts of the previous route discoveries "
+                          "instead of TtlStart.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RoutingProtocol::m_enableAdaptiveTtl),
+                          MakeBooleanChecker())
+            .AddAttribute("MaxHopCountHistory",
+                          "Maximum number of destinations whose last discovered hop count is "
+                          "kept for the adaptive expanding ring search.",
+                          UintegerValue(64),
+                          MakeUintegerAccessor(&RoutingProtocol::m_maxHopCountHistory),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("EnableDirectDeferral",
+                          "Indicates whether locally originated packets without route are "
+                          "queued as soon as the transport protocol sends them, instead of "
+                          "after a round trip through the loopback device.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RoutingProtocol::m_enableDirectDeferral),
+                          MakeBooleanChecker())
             .AddAttribute("UniformRv",
                           "Access to the underlying UniformRandomVariable",
                           StringValue("ns3::UniformRandomVariable"),
@@ -361,6 +413,16 @@ RoutingProtocol::~RoutingProtocol()
 void
 RoutingProtocol::DoDispose()
 {
+    // Give the transport protocols their former down targets back
+    for (const auto& target : m_downTargets)
+    {
+        Ptr<IpL4Protocol> protocol = m_ipv4->GetObject<Ipv4L3Protocol>()->GetProtocol(target.first);
+        if (protocol)
+        {
+            protocol->SetDownTarget(target.second);
+        }
+    }
+    m_downTargets.clear();
     m_ipv4 = nullptr;
     for (auto iter = m_socketAddresses.begin(); iter != m_socketAddresses.end(); iter++)
     {
@@ -374,6 +436,8 @@ RoutingProtocol::DoDispose()
         iter->first->Close();
     }
     m_socketSubnetBroadcastAddresses.clear();
+    m_localRepairs.clear();
+    UnregisterPromiscReceive();
     Ipv4RoutingProtocol::DoDispose();
 }
 
@@ -410,6 +474,21 @@ RoutingProtocol::Start()
 
     m_rerrRateLimitTimer.SetFunction(&RoutingProtocol::RerrRateLimitTimerExpire, this);
     m_rerrRateLimitTimer.Schedule(Seconds(1));
+
+    if (m_enableDirectDeferral)
+    {
+        // The transport protocols are installed by now; intercept what they send to IPv4
+        Ptr<Ipv4L3Protocol> l3 = m_ipv4->GetObject<Ipv4L3Protocol>();
+        for (int protocolNumber = 0; protocolNumber < 256; protocolNumber++)
+        {
+            Ptr<IpL4Protocol> protocol = l3->GetProtocol(protocolNumber);
+            if (protocol)
+            {
+                m_downTargets[protocolNumber] = protocol->GetDownTarget();
+                protocol->SetDownTarget(MakeCallback(&RoutingProtocol::SendDown, this));
+            }
+        }
+    }
 }
 
 Ptr<Ipv4Route>
@@ -435,10 +514,15 @@ RoutingProtocol::RouteOutput(Ptr<Packet> p,
     sockerr = Socket::ERROR_NOTERROR;
     Ptr<Ipv4Route> route;
     Ipv4Address dst = header.GetDestination();
-    RoutingTableEntry rt;
-    if (m_routingTable.LookupValidRoute(dst, rt))
+    const RoutingTableEntry* rt = m_routingTable.FindRoute(dst);
+    if (rt && rt->GetFlag() != VALID && m_enableMultipath &&
+        m_routingTable.SwitchToAlternatePath(dst))
     {
-        route = rt.GetRoute();
+        NS_LOG_DEBUG("Switched to an alternate path to " << dst);
+    }
+    if (rt && rt->GetFlag() == VALID)
+    {
+        route = rt->GetRoute();
         NS_ASSERT(route);
         NS_LOG_DEBUG("Exist route to " << route->GetDestination() << " from interface "
                                        << route->GetSource());
@@ -491,6 +575,61 @@ RoutingProtocol::DeferredRouteOutput(Ptr<const Packet> p,
     }
 }
 
+void
+RoutingProtocol::SendDown(Ptr<Packet> packet,
+                          Ipv4Address source,
+                          Ipv4Address destination,
+                          uint8_t protocol,
+                          Ptr<Ipv4Route> route)
+{
+    NS_LOG_FUNCTION(this << packet << source << destination);
+    DeferredRouteOutputTag tag;
+    if (route && route->GetOutputDevice() == m_lo && packet->PeekPacketTag(tag))
+    {
+        // The packet is fully formed: queue it without looping it back through RouteInput()
+        Ipv4Header header;
+        header.SetSource(source);
+        header.SetDestination(destination);
+        header.SetProtocol(protocol);
+        header.SetPayloadSize(packet->GetSize());
+        DeferredRouteOutput(packet,
+                            header,
+                            MakeCallback(&RoutingProtocol::SendDeferred, this),
+                            MakeCallback(&RoutingProtocol::DropDeferred, this));
+        return;
+    }
+    auto target = m_downTargets.find(protocol);
+    if (target == m_downTargets.end())
+    {
+        NS_LOG_LOGIC("No down target saved for protocol " << +protocol);
+        m_ipv4->Send(packet, source, destination, protocol, route);
+        return;
+    }
+    target->second(packet, source, destination, protocol, route);
+}
+
+void
+RoutingProtocol::SendDeferred(Ptr<Ipv4Route> route,
+                              Ptr<const Packet> packet,
+                              const Ipv4Header& header)
+{
+    NS_LOG_FUNCTION(this << packet << header.GetDestination());
+    SendDown(ConstCast<Packet>(packet),
+             header.GetSource(),
+             header.GetDestination(),
+             header.GetProtocol(),
+             route);
+}
+
+void
+RoutingProtocol::DropDeferred(Ptr<const Packet> packet,
+                              const Ipv4Header& header,
+                              Socket::SocketErrno err)
+{
+    NS_LOG_DEBUG("Drop packet " << packet->GetUid() << " to " << header.GetDestination()
+                                << " without route, error " << err);
+}
+
 bool
 RoutingProtocol::RouteInput(Ptr<const Packet> p,
                             const Ipv4Header& header,
@@ -608,11 +747,12 @@ RoutingProtocol::RouteInput(Ptr<const Packet> p,
     if (m_ipv4->IsDestinationAddress(dst, iif))
     {
         UpdateRouteLifeTime(origin, m_activeRouteTimeout);
-        RoutingTableEntry toOrigin;
-        if (m_routingTable.LookupValidRoute(origin, toOrigin))
+        const RoutingTableEntry* toOrigin = m_routingTable.FindRoute(origin);
+        if (toOrigin && toOrigin->GetFlag() == VALID)
         {
-            UpdateRouteLifeTime(toOrigin.GetNextHop(), m_activeRouteTimeout);
-            m_nb.Update(toOrigin.GetNextHop(), m_activeRouteTimeout);
+            Ipv4Address nextHop = toOrigin->GetNextHop();
+            UpdateRouteLifeTime(nextHop, m_activeRouteTimeout);
+            m_nb.Update(nextHop, m_activeRouteTimeout);
         }
         if (!lcb.IsNull())
         {
@@ -649,13 +789,12 @@ RoutingProtocol::Forwarding(Ptr<const Packet> p,
     NS_LOG_FUNCTION(this);
     Ipv4Address dst = header.GetDestination();
     Ipv4Address origin = header.GetSource();
-    m_routingTable.Purge();
-    RoutingTableEntry toDst;
-    if (m_routingTable.LookupRoute(dst, toDst))
+    const RoutingTableEntry* toDst = m_routingTable.FindRoute(dst);
+    if (toDst)
     {
-        if (toDst.GetFlag() == VALID)
+        if (toDst->GetFlag() == VALID)
         {
-            Ptr<Ipv4Route> route = toDst.GetRoute();
+            Ptr<Ipv4Route> route = toDst->GetRoute();
             NS_LOG_LOGIC(route->GetSource() << " forwarding to " << dst << " from " << origin
                                             << " packet " << p->GetUid());
 
@@ -674,21 +813,37 @@ RoutingProtocol::Forwarding(Ptr<const Packet> p,
              * back to the IP source, is also updated to be no less than the current time plus
              * ActiveRouteTimeout
              */
-            RoutingTableEntry toOrigin;
-            m_routingTable.LookupRoute(origin, toOrigin);
-            UpdateRouteLifeTime(toOrigin.GetNextHop(), m_activeRouteTimeout);
+            const RoutingTableEntry* toOrigin = m_routingTable.FindRoute(origin);
+            Ipv4Address toOriginNextHop = (toOrigin ? toOrigin->GetNextHop() : Ipv4Address());
+            UpdateRouteLifeTime(toOriginNextHop, m_activeRouteTimeout);
 
             m_nb.Update(route->GetGateway(), m_activeRouteTimeout);
-            m_nb.Update(toOrigin.GetNextHop(), m_activeRouteTimeout);
+            m_nb.Update(toOriginNextHop, m_activeRouteTimeout);
 
             ucb(route, p, header);
             return true;
         }
         else
         {
-            if (toDst.GetValidSeqNo())
+            if (m_enableMultipath && m_routingTable.SwitchToAlternatePath(dst))
+            {
+                NS_LOG_LOGIC("Switched to an alternate path to " << dst);
+                return Forwarding(p, header, ucb, ecb);
+            }
+            if (toDst->GetFlag() == IN_SEARCH && m_localRepairs.find(dst) != m_localRepairs.end())
             {
-                SendRerrWhenNoRouteToForward(dst, toDst.GetSeqNo(), origin);
+                if (m_queue.Enqueue(QueueEntry(p, header, ucb, ecb)))
+                {
+                    NS_LOG_LOGIC("Buffer packet " << p->GetUid()
+                                                  << " during local repair of route to " << dst);
+                    return true;
+                }
+                NS_LOG_DEBUG("Drop packet " << p->GetUid() << " because the queue rejects it.");
+                return false;
+            }
+            if (toDst->GetValidSeqNo())
+            {
+                SendRerrWhenNoRouteToForward(dst, toDst->GetSeqNo(), origin);
                 NS_LOG_DEBUG("Drop packet " << p->GetUid() << " because no route to forward it.");
                 return false;
             }
@@ -780,6 +935,12 @@ RoutingProtocol::NotifyInterfaceUp(uint32_t i)
         m_nb.AddArpCache(l3->GetInterface(i)->GetArpCache());
     }
 
+    // Overhear the RREPs unicast to the other nodes
+    if (m_enablePassiveLearning)
+    {
+        RegisterPromiscReceive(dev);
+    }
+
     // Allow neighbor manager use this interface for layer 2 feedback if possible
     Ptr<WifiNetDevice> wifi = dev->GetObject<WifiNetDevice>();
     if (!wifi)
@@ -822,6 +983,19 @@ RoutingProtocol::NotifyInterfaceDown(uint32_t i)
         }
     }
 
+    // Stop overhearing the RREPs on this interface. The other interfaces share the same
+    // handler, which is registered again for them.
+    if (m_promiscDevices.find(dev) != m_promiscDevices.end())
+    {
+        std::set<Ptr<NetDevice>> devices = m_promiscDevices;
+        devices.erase(dev);
+        UnregisterPromiscReceive();
+        for (const auto& device : devices)
+        {
+            RegisterPromiscReceive(device);
+        }
+    }
+
     // Close socket
     Ptr<Socket> socket = FindSocketWithInterfaceAddress(m_ipv4->GetAddress(i, 0));
     NS_ASSERT(socket);
@@ -1097,6 +1271,10 @@ RoutingProtocol::SendRequest(Ipv4Address dst)
     }
     else
     {
+        if (m_enableAdaptiveTtl)
+        {
+            ttl = GetAdaptiveTtl(dst);
+        }
         rreqHeader.SetUnknownSeqno(true);
         Ptr<NetDevice> dev = nullptr;
         RoutingTableEntry newEntry(/*dev=*/dev,
@@ -1116,6 +1294,66 @@ RoutingProtocol::SendRequest(Ipv4Address dst)
         m_routingTable.AddRoute(newEntry);
     }
 
+    BroadcastRequest(rreqHeader, ttl);
+    ScheduleRreqRetry(dst);
+}
+
+uint16_t
+RoutingProtocol::GetAdaptiveTtl(Ipv4Address dst) const
+{
+    auto i = m_hopCountHistory.find(dst);
+    if (i != m_hopCountHistory.end())
+    {
+        return std::min<uint16_t>(i->second.first + m_ttlIncrement, m_netDiameter);
+    }
+    if (m_hopCountSamples == 0)
+    {
+        return m_ttlStart;
+    }
+    uint32_t count = 0;
+    uint16_t median = 0;
+    while (median < m_hopCountHistogram.size() && 2 * count < m_hopCountSamples)
+    {
+        count += m_hopCountHistogram[median];
+        median++;
+    }
+    // The loop stops one hop count past the median
+    return std::min<uint16_t>(std::max<uint16_t>(median - 1, m_ttlStart), m_netDiameter);
+}
+
+void
+RoutingProtocol::RecordHopCount(Ipv4Address dst, uint16_t hops)
+{
+    NS_LOG_FUNCTION(this << dst << hops);
+    if (m_hopCountHistory.find(dst) == m_hopCountHistory.end() &&
+        m_hopCountHistory.size() >= m_maxHopCountHistory && !m_hopCountHistory.empty())
+    {
+        auto oldest = m_hopCountHistory.begin();
+        for (auto i = m_hopCountHistory.begin(); i != m_hopCountHistory.end(); ++i)
+        {
+            if (i->second.second < oldest->second.second)
+            {
+                oldest = i;
+            }
+        }
+        m_hopCountHistory.erase(oldest);
+    }
+    if (m_maxHopCountHistory > 0)
+    {
+        m_hopCountHistory[dst] = std::make_pair(hops, Simulator::Now());
+    }
+    if (hops >= m_hopCountHistogram.size())
+    {
+        m_hopCountHistogram.resize(hops + 1, 0);
+    }
+    m_hopCountHistogram[hops]++;
+    m_hopCountSamples++;
+}
+
+void
+RoutingProtocol::BroadcastRequest(RreqHeader& rreqHeader, uint16_t ttl)
+{
+    NS_LOG_FUNCTION(this << rreqHeader.GetDst() << ttl);
     if (m_gratuitousReply)
     {
         rreqHeader.SetGratuitousRrep(true);
@@ -1165,7 +1403,6 @@ RoutingProtocol::SendRequest(Ipv4Address dst)
                             packet,
                             destination);
     }
-    ScheduleRreqRetry(dst);
 }
 
 void
@@ -1264,19 +1501,20 @@ bool
 RoutingProtocol::UpdateRouteLifeTime(Ipv4Address addr, Time lifetime)
 {
     NS_LOG_FUNCTION(this << addr << lifetime);
-    RoutingTableEntry rt;
-    if (m_routingTable.LookupRoute(addr, rt))
-    {
+    bool updated = false;
+    m_routingTable.ModifyRoute(addr, [lifetime, &updated](RoutingTableEntry& rt) {
         if (rt.GetFlag() == VALID)
         {
-            NS_LOG_DEBUG("Updating VALID route");
             rt.SetRreqCnt(0);
             rt.SetLifeTime(std::max(lifetime, rt.GetLifeTime()));
-            m_routingTable.Update(rt);
-            return true;
+            updated = true;
         }
+    });
+    if (updated)
+    {
+        NS_LOG_DEBUG("Updated VALID route");
     }
-    return false;
+    return updated;
 }
 
 void
@@ -1322,6 +1560,141 @@ RoutingProtocol::UpdateRouteToNeighbor(Ipv4Address sender, Ipv4Address receiver)
     }
 }
 
+void
+RoutingProtocol::LearnRoute(Ipv4Address dst,
+                            uint32_t seqNo,
+                            uint16_t hops,
+                            Ipv4Address nextHop,
+                            Ipv4Address receiver,
+                            Time lifetime)
+{
+    NS_LOG_FUNCTION(this << dst << seqNo << hops << nextHop);
+    if (IsMyOwnAddress(dst))
+    {
+        return;
+    }
+    Ptr<NetDevice> dev = m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(receiver));
+    RoutingTableEntry newEntry(
+        /*dev=*/dev,
+        /*dst=*/dst,
+        /*vSeqNo=*/true,
+        /*seqNo=*/seqNo,
+        /*iface=*/m_ipv4->GetAddress(m_ipv4->GetInterfaceForAddress(receiver), 0),
+        /*hops=*/hops,
+        /*nextHop=*/nextHop,
+        /*lifetime=*/lifetime);
+    if (m_enableMultipath)
+    {
+        m_routingTable.AddPath(newEntry);
+        return;
+    }
+    RoutingTableEntry toDst;
+    if (!m_routingTable.LookupRoute(dst, toDst))
+    {
+        NS_LOG_LOGIC("Learned route to " << dst << " through " << nextHop);
+        m_routingTable.AddRoute(newEntry);
+        return;
+    }
+    int32_t seqNoDiff = int32_t(seqNo) - int32_t(toDst.GetSeqNo());
+    if (!toDst.GetValidSeqNo() || seqNoDiff > 0 ||
+        (seqNoDiff == 0 && (toDst.GetFlag() != VALID || hops < toDst.GetHop())))
+    {
+        NS_LOG_LOGIC("Learned route to " << dst << " through " << nextHop);
+        std::vector<Ipv4Address> precursors;
+        toDst.GetPrecursors(precursors);
+        for (auto i = precursors.begin(); i != precursors.end(); ++i)
+        {
+            newEntry.InsertPrecursor(*i);
+        }
+        m_routingTable.Update(newEntry);
+    }
+}
+
+void
+RoutingProtocol::PromiscReceive(Ptr<NetDevice> device,
+                                Ptr<const Packet> packet,
+                                uint16_t protocol,
+                                const Address& from,
+                                const Address& to,
+                                NetDevice::PacketType packetType)
+{
+    // The messages addressed to this node are received by the AODV sockets
+    if (packetType != NetDevice::PACKET_OTHERHOST)
+    {
+        return;
+    }
+    Ptr<Packet> p = packet->Copy();
+    Ipv4Header ipHeader;
+    p->RemoveHeader(ipHeader);
+    if (ipHeader.GetProtocol() != UdpL4Protocol::PROT_NUMBER ||
+        ipHeader.GetFragmentOffset() != 0 || !ipHeader.IsLastFragment())
+    {
+        return;
+    }
+    UdpHeader udpHeader;
+    p->RemoveHeader(udpHeader);
+    if (udpHeader.GetDestinationPort() != AODV_PORT)
+    {
+        return;
+    }
+    TypeHeader tHeader(AODVTYPE_RREQ);
+    p->RemoveHeader(tHeader);
+    if (!tHeader.IsValid() || tHeader.Get() != AODVTYPE_RREP)
+    {
+        return;
+    }
+    RrepHeader rrepHeader;
+    p->RemoveHeader(rrepHeader);
+    int32_t interface = m_ipv4->GetInterfaceForDevice(device);
+    if (interface < 0 || !FindSocketWithInterfaceAddress(m_ipv4->GetAddress(interface, 0)))
+    {
+        return;
+    }
+    Ipv4Address sender = ipHeader.GetSource();
+    Ipv4Address receiver = m_ipv4->GetAddress(interface, 0).GetLocal();
+    if (IsMyOwnAddress(sender) || rrepHeader.GetDst() == rrepHeader.GetOrigin())
+    {
+        return;
+    }
+    NS_LOG_LOGIC("Overheard RREP from " << sender << " to " << ipHeader.GetDestination()
+                                        << " destination " << rrepHeader.GetDst());
+    // The sender has a route to the destination with the hop count of the RREP
+    UpdateRouteToNeighbor(sender, receiver);
+    LearnRoute(rrepHeader.GetDst(),
+               rrepHeader.GetDstSeqno(),
+               rrepHeader.GetHopCount() + 1,
+               sender,
+               receiver,
+               rrepHeader.GetLifeTime());
+}
+
+void
+RoutingProtocol::RegisterPromiscReceive(Ptr<NetDevice> dev)
+{
+    NS_LOG_FUNCTION(this << dev);
+    if (m_promiscDevices.insert(dev).second)
+    {
+        GetObject<Node>()->RegisterProtocolHandler(
+            MakeCallback(&RoutingProtocol::PromiscReceive, this),
+            Ipv4L3Protocol::PROT_NUMBER,
+            dev,
+            /*promiscuous=*/true);
+    }
+}
+
+void
+RoutingProtocol::UnregisterPromiscReceive()
+{
+    NS_LOG_FUNCTION(this);
+    // The node must not call this protocol once it is disposed
+    Ptr<Node> node = GetObject<Node>();
+    for (std::size_t i = 0; node && i < m_promiscDevices.size(); i++)
+    {
+        node->UnregisterProtocolHandler(MakeCallback(&RoutingProtocol::PromiscReceive, this));
+    }
+    m_promiscDevices.clear();
+}
+
 void
 RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address src)
 {
@@ -1350,6 +1723,22 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
      */
     if (m_rreqIdCache.IsDuplicate(origin, id))
     {
+        if (m_enableMultipath && IsMyOwnAddress(rreqHeader.GetDst()))
+        {
+            ReplyToDuplicateRequest(rreqHeader, receiver, src);
+            return;
+        }
+        if (m_enablePassiveLearning)
+        {
+            // The copy may have come through a shorter path to the originator
+            uint8_t hop = rreqHeader.GetHopCount() + 1;
+            LearnRoute(origin,
+                       rreqHeader.GetOriginSeqno(),
+                       hop,
+                       src,
+                       receiver,
+                       Time(2 * m_netTraversalTime - 2 * hop * m_nodeTraversalTime));
+        }
         NS_LOG_DEBUG("Ignoring RREQ due to duplicate");
         return;
     }
@@ -1529,6 +1918,34 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
     }
 }
 
+void
+RoutingProtocol::ReplyToDuplicateRequest(const RreqHeader& rreqHeader,
+                                         Ipv4Address receiver,
+                                         Ipv4Address src)
+{
+    NS_LOG_FUNCTION(this << rreqHeader.GetOrigin() << src);
+    // Answer once per neighbor: the reverse path through src must be new
+    uint8_t hop = rreqHeader.GetHopCount() + 1;
+    Ptr<NetDevice> dev = m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(receiver));
+    RoutingTableEntry toOrigin(
+        /*dev=*/dev,
+        /*dst=*/rreqHeader.GetOrigin(),
+        /*vSeqNo=*/true,
+        /*seqNo=*/rreqHeader.GetOriginSeqno(),
+        /*iface=*/m_ipv4->GetAddress(m_ipv4->GetInterfaceForAddress(receiver), 0),
+        /*hops=*/hop,
+        /*nextHop=*/src,
+        /*lifetime=*/Time(2 * m_netTraversalTime - 2 * hop * m_nodeTraversalTime));
+    if (!m_routingTable.AddPath(toOrigin))
+    {
+        NS_LOG_DEBUG("Ignoring RREQ due to duplicate");
+        return;
+    }
+    m_nb.Update(src, Time(m_allowedHelloLoss * m_helloInterval));
+    NS_LOG_DEBUG("Send reply to duplicate RREQ through " << src);
+    SendReply(rreqHeader, toOrigin);
+}
+
 void
 RoutingProtocol::SendReply(const RreqHeader& rreqHeader, const RoutingTableEntry& toOrigin)
 {
@@ -1566,8 +1983,9 @@ RoutingProtocol::SendReplyByIntermediateNode(RoutingTableEntry& toDst,
                                              bool gratRep)
 {
     NS_LOG_FUNCTION(this);
+    uint16_t hopCount = m_enableMultipath ? toDst.AdvertiseHopCount() : toDst.GetHop();
     RrepHeader rrepHeader(/*prefixSize=*/0,
-                          /*hopCount=*/toDst.GetHop(),
+                          /*hopCount=*/hopCount,
                           /*dst=*/toDst.GetDestination(),
                           /*dstSeqNo=*/toDst.GetSeqNo(),
                           /*origin=*/toOrigin.GetDestination(),
@@ -1685,7 +2103,18 @@ RoutingProtocol::RecvReply(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address send
         /*nextHop=*/sender,
         /*lifetime=*/rrepHeader.GetLifeTime());
     RoutingTableEntry toDst;
-    if (m_routingTable.LookupRoute(dst, toDst))
+    // Whether the RREP answers a route discovery in progress, in multipath mode
+    bool discovered = false;
+    if (m_enableMultipath)
+    {
+        // Keep the other loop-free paths learned with the same sequence number. The entry is read
+        // again, since a stale path is refused and leaves a route discovery in progress.
+        bool inSearch = m_routingTable.LookupRoute(dst, toDst) && toDst.GetFlag() == IN_SEARCH;
+        m_routingTable.AddPath(newEntry);
+        m_routingTable.LookupRoute(dst, toDst);
+        discovered = inSearch && toDst.GetFlag() == VALID;
+    }
+    else if (m_routingTable.LookupRoute(dst, toDst))
     {
         // The existing entry is updated only in the following circumstances:
         if (
@@ -1722,12 +2151,27 @@ RoutingProtocol::RecvReply(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address send
     NS_LOG_LOGIC("receiver " << receiver << " origin " << rrepHeader.GetOrigin());
     if (IsMyOwnAddress(rrepHeader.GetOrigin()))
     {
-        if (toDst.GetFlag() == IN_SEARCH)
+        if (m_enableMultipath ? discovered : toDst.GetFlag() == IN_SEARCH)
         {
-            m_routingTable.Update(newEntry);
+            if (!m_enableMultipath)
+            {
+                m_routingTable.Update(newEntry);
+            }
+            // Only the first RREP of a route discovery of this node is recorded, not those of a
+            // local repair nor the later RREPs of a multipath discovery
+            auto timer = m_addressReqTimer.find(dst);
+            if (m_enableAdaptiveTtl && timer != m_addressReqTimer.end() &&
+                timer->second.IsRunning())
+            {
+                RecordHopCount(dst, hop);
+            }
             m_addressReqTimer[dst].Cancel();
             m_addressReqTimer.erase(dst);
         }
+        if (m_localRepairs.find(dst) != m_localRepairs.end())
+        {
+            FinishLocalRepair(dst);
+        }
         m_routingTable.LookupRoute(dst, toDst);
         SendPacketFromQueue(dst, toDst.GetRoute());
         return;
@@ -1761,6 +2205,24 @@ RoutingProtocol::RecvReply(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address send
         toNextHopToOrigin.InsertPrecursor(toDst.GetNextHop());
         m_routingTable.Update(toNextHopToOrigin);
     }
+    if (m_enableMultipath)
+    {
+        // Forward the hop count advertised for this sequence number, which keeps paths loop-free
+        uint16_t advertisedHops = 0;
+        m_routingTable.ModifyRoute(dst, [&rrepHeader, &advertisedHops](RoutingTableEntry& rt) {
+            if (rt.GetFlag() == VALID && rt.GetSeqNo() == rrepHeader.GetDstSeqno())
+            {
+                advertisedHops = rt.AdvertiseHopCount();
+            }
+        });
+        if (advertisedHops == 0)
+        {
+            NS_LOG_DEBUG("Drop stale RREP destination " << dst << " origin "
+                                                        << rrepHeader.GetOrigin());
+            return;
+        }
+        rrepHeader.SetHopCount(advertisedHops);
+    }
     SocketIpTtlTag tag;
     p->RemovePacketTag(tag);
     if (tag.GetTtl() < 2)
@@ -1848,8 +2310,44 @@ RoutingProtocol::RecvError(Ptr<Packet> p, Ipv4Address src)
     std::map<Ipv4Address, uint32_t> unreachable;
     m_routingTable.GetListOfDestinationWithNextHop(src, dstWithNextHopSrc);
     std::pair<Ipv4Address, uint32_t> un;
+    if (rerrHeader.GetNoDelete())
+    {
+        // The routes have been repaired downstream and remain usable, but their precursors
+        // are told that they got longer (RFC 3561, section 6.12)
+        NS_LOG_LOGIC("Keep the routes repaired by " << src);
+        RerrHeader repaired;
+        repaired.SetNoDelete(true);
+        std::vector<Ipv4Address> precursors;
+        while (rerrHeader.RemoveUnDestination(un))
+        {
+            RoutingTableEntry toDst;
+            if (dstWithNextHopSrc.find(un.first) != dstWithNextHopSrc.end() &&
+                m_routingTable.LookupRoute(un.first, toDst))
+            {
+                repaired.AddUnDestination(un.first, un.second);
+                toDst.GetPrecursors(precursors);
+            }
+        }
+        if (repaired.GetDestCount() != 0)
+        {
+            Ptr<Packet> packet = Create<Packet>();
+            SocketIpTtlTag tag;
+            tag.SetTtl(1);
+            packet->AddPacketTag(tag);
+            packet->AddHeader(repaired);
+            packet->AddHeader(TypeHeader(AODVTYPE_RERR));
+            SendRerrMessage(packet, precursors);
+        }
+        return;
+    }
     while (rerrHeader.RemoveUnDestination(un))
     {
+        if (m_enableMultipath)
+        {
+            m_routingTable.ModifyRoute(un.first, [src](RoutingTableEntry& rt) {
+                rt.DeleteAlternatePath(src);
+            });
+        }
         for (auto i = dstWithNextHopSrc.begin(); i != dstWithNextHopSrc.end(); ++i)
         {
             if (i->first == un.first)
@@ -1859,6 +2357,11 @@ RoutingProtocol::RecvError(Ptr<Packet> p, Ipv4Address src)
         }
     }
 
+    if (m_enableMultipath)
+    {
+        SwitchToAlternatePaths(unreachable, Ipv4Address());
+    }
+
     std::vector<Ipv4Address> precursors;
     for (auto i = unreachable.begin(); i != unreachable.end();)
     {
@@ -2033,14 +2536,20 @@ RoutingProtocol::SendPacketFromQueue(Ipv4Address dst, Ptr<Ipv4Route> route)
     {
         DeferredRouteOutputTag tag;
         Ptr<Packet> p = ConstCast<Packet>(queueEntry.GetPacket());
-        if (p->RemovePacketTag(tag) && tag.GetInterface() != -1 &&
+        UnicastForwardCallback ucb = queueEntry.GetUnicastForwardCallback();
+        Ipv4Header header = queueEntry.GetIpv4Header();
+        if (!p->RemovePacketTag(tag))
+        {
+            // Forwarded packet buffered during a local repair, sent as received
+            ucb(route, p, header);
+            continue;
+        }
+        if (tag.GetInterface() != -1 &&
             tag.GetInterface() != m_ipv4->GetInterfaceForDevice(route->GetOutputDevice()))
         {
             NS_LOG_DEBUG("Output device doesn't match. Dropped.");
             return;
         }
-        UnicastForwardCallback ucb = queueEntry.GetUnicastForwardCallback();
-        Ipv4Header header = queueEntry.GetIpv4Header();
         header.SetSource(route->GetSource());
         header.SetTtl(header.GetTtl() +
                       1); // compensate extra TTL decrement by fake loopback routing
@@ -2064,6 +2573,26 @@ RoutingProtocol::SendRerrWhenBreaksLinkToNextHop(Ipv4Address nextHop)
     toNextHop.GetPrecursors(precursors);
     rerrHeader.AddUnDestination(nextHop, toNextHop.GetSeqNo());
     m_routingTable.GetListOfDestinationWithNextHop(nextHop, unreachable);
+    if (m_enableMultipath)
+    {
+        m_routingTable.DeleteAlternatePaths(nextHop);
+        SwitchToAlternatePaths(unreachable, nextHop);
+    }
+    if (m_enableLocalRepair)
+    {
+        // Repaired routes are neither reported nor invalidated
+        for (auto i = unreachable.begin(); i != unreachable.end();)
+        {
+            if (i->first != nextHop && LocalRepair(i->first))
+            {
+                i = unreachable.erase(i);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
     for (auto i = unreachable.begin(); i != unreachable.end();)
     {
         if (!rerrHeader.AddUnDestination(i->first, i->second))
@@ -2102,6 +2631,142 @@ RoutingProtocol::SendRerrWhenBreaksLinkToNextHop(Ipv4Address nextHop)
     m_routingTable.InvalidateRoutesWithDst(unreachable);
 }
 
+void
+RoutingProtocol::SwitchToAlternatePaths(std::map<Ipv4Address, uint32_t>& unreachable,
+                                        Ipv4Address nextHop)
+{
+    NS_LOG_FUNCTION(this << nextHop);
+    for (auto i = unreachable.begin(); i != unreachable.end();)
+    {
+        if (i->first != nextHop && m_routingTable.SwitchToAlternatePath(i->first))
+        {
+            NS_LOG_LOGIC("Switched to an alternate path to " << i->first);
+            i = unreachable.erase(i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+bool
+RoutingProtocol::LocalRepair(Ipv4Address dst)
+{
+    NS_LOG_FUNCTION(this << dst);
+    RoutingTableEntry toDst;
+    // Only active routes used by other nodes and close enough to the destination are repaired
+    if (!m_routingTable.LookupValidRoute(dst, toDst) || toDst.IsPrecursorListEmpty() ||
+        toDst.GetHop() > m_maxRepairTtl || m_rreqCount == m_rreqRateLimit)
+    {
+        return false;
+    }
+    m_rreqCount++;
+
+    LocalRepairState& repair = m_localRepairs[dst];
+    repair.m_timer.Cancel();
+    repair.m_hops = toDst.GetHop();
+    repair.m_precursors.clear();
+    toDst.GetPrecursors(repair.m_precursors);
+
+    // TTL = MIN_REPAIR_TTL + LOCAL_ADD_TTL, the last known hop count being MIN_REPAIR_TTL
+    uint16_t ttl = std::min<uint16_t>(toDst.GetHop() + 2, m_netDiameter);
+    Time timeout = 2 * m_nodeTraversalTime * (ttl + m_timeoutBuffer);
+    NS_LOG_DEBUG("Local repair of route to " << dst << " with ttl " << ttl);
+
+    // Increment the destination sequence number to avoid stale replies
+    toDst.SetSeqNo(toDst.GetSeqNo() + 1);
+    toDst.SetFlag(IN_SEARCH);
+    toDst.SetLifeTime(timeout);
+    m_routingTable.Update(toDst);
+
+    RreqHeader rreqHeader;
+    rreqHeader.SetDst(dst);
+    rreqHeader.SetDstSeqno(toDst.GetSeqNo());
+    BroadcastRequest(rreqHeader, ttl);
+
+    repair.m_timer.SetFunction(&RoutingProtocol::LocalRepairTimerExpire, this);
+    repair.m_timer.SetArguments(dst);
+    repair.m_timer.Schedule(timeout);
+    return true;
+}
+
+void
+RoutingProtocol::FinishLocalRepair(Ipv4Address dst)
+{
+    NS_LOG_FUNCTION(this << dst);
+    auto repair = m_localRepairs.find(dst);
+    RoutingTableEntry toDst;
+    if (repair == m_localRepairs.end() || !m_routingTable.LookupValidRoute(dst, toDst))
+    {
+        return;
+    }
+    std::vector<Ipv4Address> precursors = repair->second.m_precursors;
+    uint16_t hops = repair->second.m_hops;
+    m_localRepairs.erase(repair);
+
+    for (auto i = precursors.begin(); i != precursors.end(); ++i)
+    {
+        toDst.InsertPrecursor(*i);
+    }
+    m_routingTable.Update(toDst);
+    NS_LOG_DEBUG("Route to " << dst << " repaired with " << toDst.GetHop() << " hops");
+
+    // A longer route is reported to the sources, which may start a new route discovery
+    if (toDst.GetHop() > hops)
+    {
+        RerrHeader rerrHeader;
+        rerrHeader.SetNoDelete(true);
+        rerrHeader.AddUnDestination(dst, toDst.GetSeqNo());
+        Ptr<Packet> packet = Create<Packet>();
+        SocketIpTtlTag tag;
+        tag.SetTtl(1);
+        packet->AddPacketTag(tag);
+        packet->AddHeader(rerrHeader);
+        packet->AddHeader(TypeHeader(AODVTYPE_RERR));
+        SendRerrMessage(packet, precursors);
+    }
+}
+
+void
+RoutingProtocol::LocalRepairTimerExpire(Ipv4Address dst)
+{
+    NS_LOG_FUNCTION(this << dst);
+    RoutingTableEntry toDst;
+    if (m_routingTable.LookupValidRoute(dst, toDst))
+    {
+        // Repaired by a RREP not addressed to this node
+        FinishLocalRepair(dst);
+        SendPacketFromQueue(dst, toDst.GetRoute());
+        return;
+    }
+    auto repair = m_localRepairs.find(dst);
+    if (repair == m_localRepairs.end())
+    {
+        return;
+    }
+    std::vector<Ipv4Address> precursors = repair->second.m_precursors;
+    m_localRepairs.erase(repair);
+
+    NS_LOG_DEBUG("Local repair of route to " << dst << " failed. Drop packets with dst " << dst);
+    if (m_routingTable.LookupRoute(dst, toDst))
+    {
+        toDst.Invalidate(m_deletePeriod);
+        m_routingTable.Update(toDst);
+
+        RerrHeader rerrHeader;
+        rerrHeader.AddUnDestination(dst, toDst.GetSeqNo());
+        Ptr<Packet> packet = Create<Packet>();
+        SocketIpTtlTag tag;
+        tag.SetTtl(1);
+        packet->AddPacketTag(tag);
+        packet->AddHeader(rerrHeader);
+        packet->AddHeader(TypeHeader(AODVTYPE_RERR));
+        SendRerrMessage(packet, precursors);
+    }
+    m_queue.DropPacketWithDst(dst);
+}
+
 void
 RoutingProtocol::SendRerrWhenNoRouteToForward(Ipv4Address dst,
                                               uint32_t dstSeqNo,
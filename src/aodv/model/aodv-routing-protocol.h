@@ -33,6 +33,7 @@
 #include "aodv-rqueue.h"
 #include "aodv-rtable.h"
 
+#include "ns3/ip-l4-protocol.h"
 #include "ns3/ipv4-interface.h"
 #include "ns3/ipv4-l3-protocol.h"
 #include "ns3/ipv4-routing-protocol.h"
@@ -41,6 +42,7 @@
 #include "ns3/random-variable-stream.h"
 
 #include <map>
+#include <set>
 
 namespace ns3
 {
@@ -50,6 +52,11 @@ enum WifiMacDropReason : uint8_t; // opaque enum declaration
 
 namespace aodv
 {
+/// Unit test for the routes learned from overheard messages
+struct AodvPassiveLearningTest;
+/// Unit test for the TTL of the adaptive expanding ring search
+struct AodvAdaptiveTtlTest;
+
 /**
  * \ingroup aodv
  *
@@ -58,6 +65,12 @@ namespace aodv
 class RoutingProtocol : public Ipv4RoutingProtocol
 {
   public:
+    /**
+     * Declared friend to enable unit tests.
+     */
+    friend struct AodvPassiveLearningTest;
+    friend struct AodvAdaptiveTtlTest;
+
     /**
      * \brief Get the type ID.
      * \return the object TypeId
@@ -260,6 +273,19 @@ class RoutingProtocol : public Ipv4RoutingProtocol
                              ///< originated route discovery.
     bool m_enableHello;      ///< Indicates whether a hello messages enable
     bool m_enableBroadcast;  ///< Indicates whether a a broadcast data packets forwarding enable
+    bool m_enableLocalRepair; ///< Indicates whether link breaks on active routes are repaired
+                              ///< locally.
+    uint16_t m_maxRepairTtl;  ///< Maximum hop count to the destination of a repaired route.
+    bool m_enableMultipath;   ///< Indicates whether several loop-free paths are kept per
+                              ///< destination (AOMDV).
+    bool m_enablePassiveLearning; ///< Indicates whether routes are learned from overheard RREPs
+                                  ///< and duplicate RREQs.
+    bool m_enableAdaptiveTtl; ///< Indicates whether the first RREQ TTL is chosen from the hop
+                              ///< counts of the previous route discoveries.
+    uint32_t m_maxHopCountHistory; ///< Maximum number of destinations whose last hop count is
+                                   ///< kept.
+    bool m_enableDirectDeferral; ///< Indicates whether packets without route are queued before
+                                 ///< the loopback device.
 
     /// IP protocol
     Ptr<Ipv4> m_ipv4;
@@ -306,6 +332,40 @@ class RoutingProtocol : public Ipv4RoutingProtocol
                              const Ipv4Header& header,
                              UnicastForwardCallback ucb,
                              ErrorCallback ecb);
+    /**
+     * Down target of the transport protocols when direct deferral is enabled. Packets routed to
+     * the loopback device by RouteOutput() are queued at once, other packets are passed to the
+     * IPv4 layer.
+     *
+     * \param packet the packet, with its transport header
+     * \param source the source address
+     * \param destination the destination address
+     * \param protocol the transport protocol number
+     * \param route the route returned by RouteOutput()
+     */
+    void SendDown(Ptr<Packet> packet,
+                  Ipv4Address source,
+                  Ipv4Address destination,
+                  uint8_t protocol,
+                  Ptr<Ipv4Route> route);
+    /**
+     * Pass a packet queued by SendDown() to the IPv4 layer once a route is found
+     *
+     * \param route the route
+     * \param packet the packet, with its transport header
+     * \param header the IP header fields known when it was queued
+     */
+    void SendDeferred(Ptr<Ipv4Route> route, Ptr<const Packet> packet, const Ipv4Header& header);
+    /**
+     * Log a packet queued by SendDown() and dropped without route
+     *
+     * \param packet the packet
+     * \param header the IP header fields known when it was queued
+     * \param err the error
+     */
+    void DropDeferred(Ptr<const Packet> packet, const Ipv4Header& header, Socket::SocketErrno err);
+    /// Down targets of the transport protocols, by protocol number
+    std::map<uint8_t, IpL4Protocol::DownTargetCallback> m_downTargets;
     /**
      * If route exists and is valid, forward packet.
      *
@@ -340,6 +400,45 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \param sender is supposed to be IP address of my neighbor.
      */
     void UpdateRouteToNeighbor(Ipv4Address sender, Ipv4Address receiver);
+    /**
+     * Install or update a route learned passively, following the update rules of RREPs: the
+     * route is used if its sequence number is newer, or equal with an inactive route or a
+     * lower hop count. The precursors of the existing route are kept.
+     * \param dst the destination address
+     * \param seqNo the destination sequence number
+     * \param hops the hop count to the destination
+     * \param nextHop the next hop address, a neighbor
+     * \param receiver the address of the interface the route was learned on
+     * \param lifetime the lifetime of the route
+     */
+    void LearnRoute(Ipv4Address dst,
+                    uint32_t seqNo,
+                    uint16_t hops,
+                    Ipv4Address nextHop,
+                    Ipv4Address receiver,
+                    Time lifetime);
+    /**
+     * Learn a route from a RREP unicast to another node and overheard on an interface
+     * \param device the device the packet was overheard on
+     * \param packet the packet, starting with the IPv4 header
+     * \param protocol the protocol number
+     * \param from the MAC address of the sender
+     * \param to the MAC address of the receiver
+     * \param packetType the packet type
+     */
+    void PromiscReceive(Ptr<NetDevice> device,
+                        Ptr<const Packet> packet,
+                        uint16_t protocol,
+                        const Address& from,
+                        const Address& to,
+                        NetDevice::PacketType packetType);
+    /**
+     * Start overhearing the RREPs unicast to the other nodes on a device
+     * \param dev the device
+     */
+    void RegisterPromiscReceive(Ptr<NetDevice> dev);
+    /// Stop overhearing the RREPs on all the devices
+    void UnregisterPromiscReceive();
     /**
      * Test whether the provided address is assigned to an interface on this node
      * \param src the source IP address
@@ -428,6 +527,44 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \param dst destination address
      */
     void SendRequest(Ipv4Address dst);
+    /**
+     * Get the TTL of the first RREQ to a destination without routing table entry: the last hop
+     * count discovered to it plus TtlIncrement, or the median hop count of all the discoveries,
+     * or TtlStart if no route was discovered yet
+     * \param dst destination address
+     * \return the TTL
+     */
+    uint16_t GetAdaptiveTtl(Ipv4Address dst) const;
+    /**
+     * Record the hop count of a discovered route, forgetting the destination discovered first
+     * if MaxHopCountHistory destinations are recorded already
+     * \param dst destination address
+     * \param hops hop count to the destination
+     */
+    void RecordHopCount(Ipv4Address dst, uint16_t hops);
+    /**
+     * Broadcast a RREQ from each interface used by AODV
+     * \param rreqHeader RREQ header, with the destination fields already set
+     * \param ttl IP TTL of the RREQ
+     */
+    void BroadcastRequest(RreqHeader& rreqHeader, uint16_t ttl);
+    /**
+     * Answer a copy of a RREQ for this node received through another neighbor, so that the
+     * originator learns another path (AOMDV)
+     * \param rreqHeader RREQ message header
+     * \param receiver receiver address
+     * \param src sender address
+     */
+    void ReplyToDuplicateRequest(const RreqHeader& rreqHeader,
+                                 Ipv4Address receiver,
+                                 Ipv4Address src);
+    /**
+     * Switch the unreachable destinations which have an alternate path to it, and remove them
+     * from the list
+     * \param unreachable unreachable destinations and their sequence numbers
+     * \param nextHop next hop of the broken path, whose own entry is not switched
+     */
+    void SwitchToAlternatePaths(std::map<Ipv4Address, uint32_t>& unreachable, Ipv4Address nextHop);
     /** Send RREP
      * \param rreqHeader route request header
      * \param toOrigin routing table entry to originator
@@ -449,6 +586,17 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \param nextHop next hop address
      */
     void SendRerrWhenBreaksLinkToNextHop(Ipv4Address nextHop);
+    /**
+     * Start the local repair of an active route (RFC 3561, section 6.12)
+     * \param dst the destination IP address
+     * \returns true if the route is being repaired, false if it must be invalidated
+     */
+    bool LocalRepair(Ipv4Address dst);
+    /**
+     * Restore the precursors of a repaired route and notify them if the route got longer
+     * \param dst the destination IP address
+     */
+    void FinishLocalRepair(Ipv4Address dst);
     /** Forward RERR
      * \param packet packet
      * \param precursors list of addresses of the visited nodes
@@ -491,6 +639,33 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \param dst the destination IP address
      */
     void RouteRequestTimerExpire(Ipv4Address dst);
+
+    /// State of a route under local repair
+    struct LocalRepairState
+    {
+        Timer m_timer{Timer::CANCEL_ON_DESTROY}; ///< Timeout of the repair
+        uint16_t m_hops{0};                      ///< Hop count of the route before the break
+        std::vector<Ipv4Address> m_precursors;   ///< Precursors of the route before the break
+    };
+
+    /// Last hop count discovered to each destination and its discovery time, kept after the
+    /// route is deleted
+    std::map<Ipv4Address, std::pair<uint16_t, Time>> m_hopCountHistory;
+    /// Number of route discoveries per hop count
+    std::vector<uint32_t> m_hopCountHistogram;
+    /// Total number of route discoveries in the histogram
+    uint32_t m_hopCountSamples;
+
+    /// Devices on which AODV messages are overheard
+    std::set<Ptr<NetDevice>> m_promiscDevices;
+
+    /// Routes under local repair, by destination
+    std::map<Ipv4Address, LocalRepairState> m_localRepairs;
+    /**
+     * Handle the end of a local repair: invalidate the route if no RREP was received
+     * \param dst the destination IP address
+     */
+    void LocalRepairTimerExpire(Ipv4Address dst);
     /**
      * Mark link to neighbor node as unidirectional for blacklistTimeout
      *
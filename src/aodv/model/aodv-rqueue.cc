@@ -26,13 +26,11 @@
  */
 #include "aodv-rqueue.h"
 
+#include "ns3/assert.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/log.h"
 #include "ns3/socket.h"
 
-#include <algorithm>
-#include <functional>
-
 namespace ns3
 {
 
@@ -51,21 +49,22 @@ bool
 RequestQueue::Enqueue(QueueEntry& entry)
 {
     Purge();
-    for (auto i = m_queue.begin(); i != m_queue.end(); ++i)
+    Ipv4Address dst = entry.GetIpv4Header().GetDestination();
+    auto d = m_destinations.find(dst);
+    if (d != m_destinations.end() &&
+        d->second.uids.find(entry.GetPacket()->GetUid()) != d->second.uids.end())
     {
-        if ((i->GetPacket()->GetUid() == entry.GetPacket()->GetUid()) &&
-            (i->GetIpv4Header().GetDestination() == entry.GetIpv4Header().GetDestination()))
-        {
-            return false;
-        }
+        return false;
     }
     entry.SetExpireTime(m_queueTimeout);
     if (m_queue.size() == m_maxLen)
     {
         Drop(m_queue.front(), "Drop the most aged packet"); // Drop the most aged packet
-        m_queue.erase(m_queue.begin());
+        PopFront();
     }
-    m_queue.push_back(entry);
+    DestinationQueue& queue = m_destinations[dst];
+    queue.entries.push_back(m_queue.insert(m_queue.end(), entry));
+    queue.uids.insert(entry.GetPacket()->GetUid());
     return true;
 }
 
@@ -74,77 +73,68 @@ RequestQueue::DropPacketWithDst(Ipv4Address dst)
 {
     NS_LOG_FUNCTION(this << dst);
     Purge();
-    for (auto i = m_queue.begin(); i != m_queue.end(); ++i)
+    auto d = m_destinations.find(dst);
+    if (d == m_destinations.end())
+    {
+        return;
+    }
+    for (auto i = d->second.entries.begin(); i != d->second.entries.end(); ++i)
     {
-        if (i->GetIpv4Header().GetDestination() == dst)
-        {
-            Drop(*i, "DropPacketWithDst ");
-        }
+        Drop(**i, "DropPacketWithDst ");
+        m_queue.erase(*i);
     }
-    auto new_end = std::remove_if(m_queue.begin(), m_queue.end(), [&](const QueueEntry& en) {
-        return en.GetIpv4Header().GetDestination() == dst;
-    });
-    m_queue.erase(new_end, m_queue.end());
+    m_destinations.erase(d);
 }
 
 bool
 RequestQueue::Dequeue(Ipv4Address dst, QueueEntry& entry)
 {
     Purge();
-    for (auto i = m_queue.begin(); i != m_queue.end(); ++i)
+    auto d = m_destinations.find(dst);
+    if (d == m_destinations.end())
     {
-        if (i->GetIpv4Header().GetDestination() == dst)
-        {
-            entry = *i;
-            m_queue.erase(i);
-            return true;
-        }
+        return false;
     }
-    return false;
+    auto i = d->second.entries.front();
+    entry = *i;
+    d->second.entries.pop_front();
+    d->second.uids.erase(i->GetPacket()->GetUid());
+    if (d->second.entries.empty())
+    {
+        m_destinations.erase(d);
+    }
+    m_queue.erase(i);
+    return true;
 }
 
 bool
 RequestQueue::Find(Ipv4Address dst)
 {
-    for (auto i = m_queue.begin(); i != m_queue.end(); ++i)
-    {
-        if (i->GetIpv4Header().GetDestination() == dst)
-        {
-            return true;
-        }
-    }
-    return false;
+    return m_destinations.find(dst) != m_destinations.end();
 }
 
-/**
- * \brief IsExpired structure
- */
-struct IsExpired
+void
+RequestQueue::Purge()
 {
-    /**
-     * Check if the entry is expired
-     *
-     * \param e QueueEntry entry
-     * \return true if expired, false otherwise
-     */
-    bool operator()(const QueueEntry& e) const
+    while (!m_queue.empty() && m_queue.front().GetExpireTime() < Seconds(0))
     {
-        return (e.GetExpireTime() < Seconds(0));
+        Drop(m_queue.front(), "Drop outdated packet ");
+        PopFront();
     }
-};
+}
 
 void
-RequestQueue::Purge()
+RequestQueue::PopFront()
 {
-    IsExpired pred;
-    for (auto i = m_queue.begin(); i != m_queue.end(); ++i)
+    auto d = m_destinations.find(m_queue.front().GetIpv4Header().GetDestination());
+    NS_ASSERT(d != m_destinations.end() && d->second.entries.front() == m_queue.begin());
+    d->second.entries.pop_front();
+    d->second.uids.erase(m_queue.front().GetPacket()->GetUid());
+    if (d->second.entries.empty())
     {
-        if (pred(*i))
-        {
-            Drop(*i, "Drop outdated packet ");
-        }
+        m_destinations.erase(d);
     }
-    m_queue.erase(std::remove_if(m_queue.begin(), m_queue.end(), pred), m_queue.end());
+    m_queue.pop_front();
 }
 
 void
@@ -27,10 +27,14 @@
 #ifndef AODV_RQUEUE_H
 #define AODV_RQUEUE_H
 
+#include "ns3/ipv4-address.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/simulator.h"
 
-#include <vector>
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace ns3
 {
@@ -192,6 +196,12 @@ class QueueEntry
  * \brief AODV route request queue
  *
  * Since AODV is an on demand routing we queue requests while looking for route.
+ *
+ * The entries are kept in a list ordered by age, and indexed by destination
+ * in per-destination FIFOs, so that enqueuing and dequeuing a packet take
+ * constant time. All the entries are given the same timeout when enqueued,
+ * so they expire in the order of the list, and only the expired entries at
+ * its front are visited to purge the queue.
  */
 class RequestQueue
 {
@@ -278,10 +288,24 @@ class RequestQueue
     }
 
   private:
-    /// The queue
-    std::vector<QueueEntry> m_queue;
+    /// List of queue entries
+    typedef std::list<QueueEntry> EntryList;
+
+    /// Entries queued for a destination
+    struct DestinationQueue
+    {
+        std::deque<EntryList::iterator> entries; //!< Entries, from the most aged
+        std::unordered_set<uint64_t> uids;       //!< UIDs of the packets of the entries
+    };
+
+    /// The queue, from the most aged entry
+    EntryList m_queue;
+    /// Index of the queue by destination
+    std::unordered_map<Ipv4Address, DestinationQueue, Ipv4AddressHash> m_destinations;
     /// Remove all expired entries
     void Purge();
+    /// Remove the most aged entry, which is also the most aged one of its destination
+    void PopFront();
     /**
      * Notify that packet is dropped from queue by timeout
      * \param en the queue entry to drop
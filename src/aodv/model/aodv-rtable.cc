@@ -62,7 +62,8 @@ RoutingTableEntry::RoutingTableEntry(Ptr<NetDevice> dev,
       m_flag(VALID),
       m_reqCount(0),
       m_blackListState(false),
-      m_blackListTimeout(Simulator::Now())
+      m_blackListTimeout(Simulator::Now()),
+      m_advertisedHops(NOT_ADVERTISED)
 {
     m_ipv4Route = Create<Ipv4Route>();
     m_ipv4Route->SetDestination(dst);
@@ -163,6 +164,117 @@ RoutingTableEntry::GetPrecursors(std::vector<Ipv4Address>& prec) const
     }
 }
 
+bool
+RoutingTableEntry::InsertAlternatePath(const RoutingTableEntry& rt)
+{
+    NS_LOG_FUNCTION(this << rt.GetNextHop() << rt.GetHop());
+    if (rt.GetNextHop() == GetNextHop() || rt.GetHop() > m_advertisedHops)
+    {
+        NS_LOG_LOGIC("Alternate path through " << rt.GetNextHop() << " refused");
+        return false;
+    }
+    for (auto i = m_alternatePaths.begin(); i != m_alternatePaths.end(); ++i)
+    {
+        if (i->m_nextHop == rt.GetNextHop())
+        {
+            i->m_hops = rt.GetHop();
+            i->m_expireTime = std::max(i->m_expireTime, rt.m_lifeTime);
+            return false;
+        }
+    }
+    m_alternatePaths.push_back(
+        {rt.GetOutputDevice(), rt.GetInterface(), rt.GetNextHop(), rt.GetHop(), rt.m_lifeTime});
+    return true;
+}
+
+bool
+RoutingTableEntry::DeleteAlternatePath(Ipv4Address nextHop)
+{
+    NS_LOG_FUNCTION(this << nextHop);
+    auto i = std::remove_if(m_alternatePaths.begin(),
+                            m_alternatePaths.end(),
+                            [nextHop](const AlternatePath& path) {
+                                return path.m_nextHop == nextHop;
+                            });
+    if (i == m_alternatePaths.end())
+    {
+        return false;
+    }
+    m_alternatePaths.erase(i, m_alternatePaths.end());
+    return true;
+}
+
+void
+RoutingTableEntry::ReplacePath(const RoutingTableEntry& rt)
+{
+    NS_LOG_FUNCTION(this << rt.GetNextHop() << rt.GetHop());
+    DeleteAlternatePath(rt.GetNextHop());
+    if (rt.GetNextHop() != GetNextHop() && m_flag == VALID)
+    {
+        m_alternatePaths.push_back({GetOutputDevice(), m_iface, GetNextHop(), m_hops, m_lifeTime});
+    }
+    SetPath(rt.GetOutputDevice(), rt.GetInterface(), rt.GetNextHop());
+    m_hops = rt.GetHop();
+    m_lifeTime = rt.m_lifeTime;
+    m_flag = VALID;
+}
+
+bool
+RoutingTableEntry::SwitchToAlternatePath()
+{
+    NS_LOG_FUNCTION(this);
+    Time now = Simulator::Now();
+    m_alternatePaths.erase(std::remove_if(m_alternatePaths.begin(),
+                                          m_alternatePaths.end(),
+                                          [now](const AlternatePath& path) {
+                                              return path.m_expireTime <= now;
+                                          }),
+                           m_alternatePaths.end());
+    auto best = std::min_element(m_alternatePaths.begin(),
+                                 m_alternatePaths.end(),
+                                 [](const AlternatePath& a, const AlternatePath& b) {
+                                     return a.m_hops < b.m_hops;
+                                 });
+    if (best == m_alternatePaths.end())
+    {
+        return false;
+    }
+    NS_LOG_LOGIC("Switch to the alternate path through " << best->m_nextHop);
+    SetPath(best->m_device, best->m_iface, best->m_nextHop);
+    m_hops = best->m_hops;
+    m_lifeTime = best->m_expireTime;
+    m_flag = VALID;
+    m_reqCount = 0;
+    m_alternatePaths.erase(best);
+    return true;
+}
+
+uint16_t
+RoutingTableEntry::AdvertiseHopCount()
+{
+    if (m_advertisedHops == NOT_ADVERTISED)
+    {
+        m_advertisedHops = m_hops;
+        for (auto i = m_alternatePaths.begin(); i != m_alternatePaths.end(); ++i)
+        {
+            m_advertisedHops = std::max(m_advertisedHops, i->m_hops);
+        }
+    }
+    return m_advertisedHops;
+}
+
+void
+RoutingTableEntry::SetPath(Ptr<NetDevice> dev, Ipv4InterfaceAddress iface, Ipv4Address nextHop)
+{
+    Ipv4Address dst = GetDestination();
+    m_iface = iface;
+    m_ipv4Route = Create<Ipv4Route>();
+    m_ipv4Route->SetDestination(dst);
+    m_ipv4Route->SetGateway(nextHop);
+    m_ipv4Route->SetSource(m_iface.GetLocal());
+    m_ipv4Route->SetOutputDevice(dev);
+}
+
 void
 RoutingTableEntry::Invalidate(Time badLinkLifetime)
 {
@@ -225,7 +337,8 @@ RoutingTableEntry::Print(Ptr<OutputStreamWrapper> stream, Time::Unit unit /* = T
  */
 
 RoutingTable::RoutingTable(Time t)
-    : m_badLinkLifetime(t)
+    : m_nextRecord(0),
+      m_badLinkLifetime(t)
 {
 }
 
@@ -264,6 +377,42 @@ RoutingTable::LookupValidRoute(Ipv4Address id, RoutingTableEntry& rt)
     return (rt.GetFlag() == VALID);
 }
 
+const RoutingTableEntry*
+RoutingTable::FindRoute(Ipv4Address dst)
+{
+    NS_LOG_FUNCTION(this << dst);
+    Purge();
+    auto i = m_ipv4AddressEntry.find(dst);
+    if (i == m_ipv4AddressEntry.end())
+    {
+        NS_LOG_LOGIC("Route to " << dst << " not found");
+        return nullptr;
+    }
+    NS_LOG_LOGIC("Route to " << dst << " found");
+    return &i->second;
+}
+
+bool
+RoutingTable::ModifyRoute(Ipv4Address dst,
+                          const std::function<void(RoutingTableEntry&)>& modifier)
+{
+    NS_LOG_FUNCTION(this << dst);
+    Purge();
+    auto i = m_ipv4AddressEntry.find(dst);
+    if (i == m_ipv4AddressEntry.end())
+    {
+        NS_LOG_LOGIC("Route modification to " << dst << " fails; not found");
+        return false;
+    }
+    Time lifeTime = i->second.GetLifeTime();
+    modifier(i->second);
+    if (i->second.GetLifeTime() < lifeTime || lifeTime < Seconds(0))
+    {
+        ScheduleExpiry(i->second);
+    }
+    return true;
+}
+
 bool
 RoutingTable::DeleteRoute(Ipv4Address dst)
 {
@@ -288,6 +437,10 @@ RoutingTable::AddRoute(RoutingTableEntry& rt)
         rt.SetRreqCnt(0);
     }
     auto result = m_ipv4AddressEntry.insert(std::make_pair(rt.GetDestination(), rt));
+    if (result.second)
+    {
+        ScheduleExpiry(rt);
+    }
     return result.second;
 }
 
@@ -301,7 +454,13 @@ RoutingTable::Update(RoutingTableEntry& rt)
         NS_LOG_LOGIC("Route update to " << rt.GetDestination() << " fails; not found");
         return false;
     }
+    // A later expiration time is found by Purge() at the record of the former one.
+    Time lifeTime = i->second.GetLifeTime();
     i->second = rt;
+    if (rt.GetLifeTime() < lifeTime || lifeTime < Seconds(0))
+    {
+        ScheduleExpiry(rt);
+    }
     if (i->second.GetFlag() != IN_SEARCH)
     {
         NS_LOG_LOGIC("Route update to " << rt.GetDestination() << " set RreqCnt to 0");
@@ -310,6 +469,63 @@ RoutingTable::Update(RoutingTableEntry& rt)
     return true;
 }
 
+bool
+RoutingTable::AddPath(RoutingTableEntry& rt)
+{
+    NS_LOG_FUNCTION(this << rt.GetDestination() << rt.GetNextHop());
+    Purge();
+    auto i = m_ipv4AddressEntry.find(rt.GetDestination());
+    if (i == m_ipv4AddressEntry.end())
+    {
+        return AddRoute(rt);
+    }
+    RoutingTableEntry& entry = i->second;
+    int32_t seqNoDiff = int32_t(rt.GetSeqNo()) - int32_t(entry.GetSeqNo());
+    if (!entry.GetValidSeqNo() || seqNoDiff > 0 || (seqNoDiff == 0 && entry.GetFlag() != VALID))
+    {
+        return Update(rt);
+    }
+    if (seqNoDiff < 0)
+    {
+        NS_LOG_LOGIC("Path to " << rt.GetDestination() << " with stale sequence number");
+        return false;
+    }
+    if (rt.GetHop() < entry.GetHop())
+    {
+        Time lifeTime = entry.GetLifeTime();
+        entry.ReplacePath(rt);
+        if (entry.GetLifeTime() < lifeTime)
+        {
+            ScheduleExpiry(entry);
+        }
+        return true;
+    }
+    return entry.InsertAlternatePath(rt);
+}
+
+bool
+RoutingTable::SwitchToAlternatePath(Ipv4Address dst)
+{
+    NS_LOG_FUNCTION(this << dst);
+    auto i = m_ipv4AddressEntry.find(dst);
+    if (i == m_ipv4AddressEntry.end() || !i->second.SwitchToAlternatePath())
+    {
+        return false;
+    }
+    ScheduleExpiry(i->second);
+    return true;
+}
+
+void
+RoutingTable::DeleteAlternatePaths(Ipv4Address nextHop)
+{
+    NS_LOG_FUNCTION(this << nextHop);
+    for (auto i = m_ipv4AddressEntry.begin(); i != m_ipv4AddressEntry.end(); ++i)
+    {
+        i->second.DeleteAlternatePath(nextHop);
+    }
+}
+
 bool
 RoutingTable::SetEntryState(Ipv4Address id, RouteFlags state)
 {
@@ -322,6 +538,11 @@ RoutingTable::SetEntryState(Ipv4Address id, RouteFlags state)
     }
     i->second.SetFlag(state);
     i->second.SetRreqCnt(0);
+    if (i->second.GetLifeTime() < Seconds(0))
+    {
+        // The record of an expired entry in search has been dropped by Purge().
+        ScheduleExpiry(i->second);
+    }
     NS_LOG_LOGIC("Route set entry state to " << id << ": new state is " << state);
     return true;
 }
@@ -348,15 +569,19 @@ RoutingTable::InvalidateRoutesWithDst(const std::map<Ipv4Address, uint32_t>& unr
 {
     NS_LOG_FUNCTION(this);
     Purge();
-    for (auto i = m_ipv4AddressEntry.begin(); i != m_ipv4AddressEntry.end(); ++i)
+    for (auto j = unreachable.begin(); j != unreachable.end(); ++j)
     {
-        for (auto j = unreachable.begin(); j != unreachable.end(); ++j)
+        auto i = m_ipv4AddressEntry.find(j->first);
+        if (i != m_ipv4AddressEntry.end() && i->second.GetFlag() == VALID)
         {
-            if ((i->first == j->first) && (i->second.GetFlag() == VALID))
-            {
-                NS_LOG_LOGIC("Invalidate route with destination address " << i->first);
-                i->second.Invalidate(m_badLinkLifetime);
-            }
+            NS_LOG_LOGIC("Invalidate route with destination address " << i->first);
+            i->second.Invalidate(m_badLinkLifetime);
+            ScheduleExpiry(i->second);
+        }
+        else
+        {
+            // An expired entry in search is scheduled again by SetEntryState().
+            m_currentRecords.erase(current);
         }
     }
 }
@@ -384,38 +609,57 @@ RoutingTable::DeleteAllRoutesFromInterface(Ipv4InterfaceAddress iface)
     }
 }
 
+void
+RoutingTable::ScheduleExpiry(const RoutingTableEntry& rt)
+{
+    uint64_t record = m_nextRecord++;
+    m_currentRecords[rt.GetDestination()] = record;
+    m_expiryQueue.emplace(rt.GetLifeTime() + Simulator::Now(), rt.GetDestination(), record);
+}
+
 void
 RoutingTable::Purge()
 {
     NS_LOG_FUNCTION(this);
-    if (m_ipv4AddressEntry.empty())
+    while (!m_expiryQueue.empty() && std::get<0>(m_expiryQueue.top()) < Simulator::Now())
     {
-        return;
-    }
-    for (auto i = m_ipv4AddressEntry.begin(); i != m_ipv4AddressEntry.end();)
-    {
-        if (i->second.GetLifeTime() < Seconds(0))
+        Ipv4Address dst = std::get<1>(m_expiryQueue.top());
+        uint64_t record = std::get<2>(m_expiryQueue.top());
+        m_expiryQueue.pop();
+        auto current = m_currentRecords.find(dst);
+        if (current == m_currentRecords.end() || current->second != record)
         {
-            if (i->second.GetFlag() == INVALID)
-            {
-                auto tmp = i;
-                ++i;
-                m_ipv4AddressEntry.erase(tmp);
-            }
-            else if (i->second.GetFlag() == VALID)
-            {
-                NS_LOG_LOGIC("Invalidate route with destination address " << i->first);
-                i->second.Invalidate(m_badLinkLifetime);
-                ++i;
-            }
-            else
-            {
-                ++i;
-            }
+            // Record replaced by a later one of the same entry
+            continue;
+        }
+        auto i = m_ipv4AddressEntry.find(dst);
+        if (i == m_ipv4AddressEntry.end())
+        {
+            // Current record of a deleted entry
+            m_currentRecords.erase(current);
+            continue;
+        }
+        if (i->second.GetLifeTime() >= Seconds(0))
+        {
+            // Outdated record of an entry whose lifetime has been extended
+            ScheduleExpiry(i->second);
+            continue;
+        }
+        if (i->second.GetFlag() == INVALID)
+        {
+            m_ipv4AddressEntry.erase(i);
+            m_currentRecords.erase(current);
+        }
+        else if (i->second.GetFlag() == VALID)
+        {
+            NS_LOG_LOGIC("Invalidate route with destination address " << dst);
+            i->second.Invalidate(m_badLinkLifetime);
+            ScheduleExpiry(i->second);
         }
         else
         {
-            ++i;
+            // An expired entry in search is scheduled again by SetEntryState().
+            m_currentRecords.erase(current);
         }
     }
 }
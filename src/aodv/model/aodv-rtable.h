@@ -34,9 +34,15 @@
 #include "ns3/timer.h"
 
 #include <cassert>
+#include <functional>
+#include <limits>
 #include <map>
+#include <queue>
 #include <stdint.h>
 #include <sys/types.h>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 namespace ns3
 {
@@ -118,6 +124,51 @@ class RoutingTableEntry
     void GetPrecursors(std::vector<Ipv4Address>& prec) const;
     //\}
 
+    ///\name Alternate paths management (AOMDV)
+    //\{
+    /**
+     * Insert the path of another entry to the same destination, with the same sequence number, as
+     * an alternate path. The path is refused if its next hop is the one of this entry, or if its
+     * hop count exceeds the advertised hop count.
+     * \param rt entry whose next hop, interface, hop count and lifetime describe the path
+     * \return true if the path was inserted, false if it was refused or only refreshed
+     */
+    bool InsertAlternatePath(const RoutingTableEntry& rt);
+    /**
+     * Delete the alternate path through a next hop
+     * \param nextHop the next hop address
+     * \return true on success
+     */
+    bool DeleteAlternatePath(Ipv4Address nextHop);
+    /**
+     * Use the path of another entry to the same destination, with the same sequence number and a
+     * lower hop count, and keep the current path as an alternate path
+     * \param rt entry whose next hop, interface, hop count and lifetime describe the path
+     */
+    void ReplacePath(const RoutingTableEntry& rt);
+    /**
+     * Replace the current path by the alternate path with the lowest hop count, which is removed
+     * from the alternate paths, and mark the entry as valid. Expired alternate paths are deleted.
+     * \return true if an alternate path was found
+     */
+    bool SwitchToAlternatePath();
+    /**
+     * Get the number of alternate paths
+     * \return the number of alternate paths
+     */
+    std::size_t GetAlternatePathCount() const
+    {
+        return m_alternatePaths.size();
+    }
+
+    /**
+     * Freeze the advertised hop count to the highest hop count of the paths, if it was not
+     * advertised yet for the current sequence number
+     * \return the advertised hop count
+     */
+    uint16_t AdvertiseHopCount();
+    //\}
+
     /**
      * Mark entry as "down" (i.e. disable it)
      * \param badLinkLifetime duration to keep entry marked as invalid
@@ -225,11 +276,17 @@ class RoutingTableEntry
     }
 
     /**
-     * Set the sequence number
+     * Set the sequence number. The alternate paths and the advertised hop count only hold for
+     * the sequence number they were learned with, and are reset when it changes.
      * \param sn the sequence number
      */
     void SetSeqNo(uint32_t sn)
     {
+        if (sn != m_seqNo)
+        {
+            m_alternatePaths.clear();
+            m_advertisedHops = NOT_ADVERTISED;
+        }
         m_seqNo = sn;
     }
 
@@ -379,6 +436,27 @@ class RoutingTableEntry
     void Print(Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
 
   private:
+    /// An alternate path to the destination
+    struct AlternatePath
+    {
+        Ptr<NetDevice> m_device;      //!< Output device
+        Ipv4InterfaceAddress m_iface; //!< Output interface address
+        Ipv4Address m_nextHop;        //!< Next hop address
+        uint16_t m_hops;              //!< Hop count
+        Time m_expireTime;            //!< Expiration time
+    };
+
+    /// Advertised hop count of a route which was not advertised yet
+    static constexpr uint16_t NOT_ADVERTISED = std::numeric_limits<uint16_t>::max();
+
+    /**
+     * Use a new path, in a new Ipv4Route so that the routes already handed out stay unchanged
+     * \param dev the output device
+     * \param iface the output interface address
+     * \param nextHop the next hop address
+     */
+    void SetPath(Ptr<NetDevice> dev, Ipv4InterfaceAddress iface, Ipv4Address nextHop);
+
     /// Valid Destination Sequence Number flag
     bool m_validSeqNo;
     /// Destination Sequence Number, if m_validSeqNo = true
@@ -414,6 +492,13 @@ class RoutingTableEntry
     bool m_blackListState;
     /// Time for which the node is put into the blacklist
     Time m_blackListTimeout;
+    /// Other paths to the destination, learned with the same sequence number
+    std::vector<AlternatePath> m_alternatePaths;
+    /**
+     * Hop count advertised for the current sequence number. Only paths not longer than this
+     * value are accepted, which keeps the paths loop-free.
+     */
+    uint16_t m_advertisedHops;
 };
 
 /**
@@ -478,12 +563,46 @@ class RoutingTable
      * \return true on success
      */
     bool LookupValidRoute(Ipv4Address dst, RoutingTableEntry& rt);
+    /**
+     * Lookup routing table entry with destination address dst, without copying it.
+     * The entry is only valid until the next call that may modify the routing table.
+     * \param dst destination address
+     * \return the entry with destination address dst, or nullptr if it does not exist
+     */
+    const RoutingTableEntry* FindRoute(Ipv4Address dst);
+    /**
+     * Modify routing table entry with destination address dst in place
+     * \param dst destination address
+     * \param modifier function called on the entry with destination address dst, if exists
+     * \return true on success
+     */
+    bool ModifyRoute(Ipv4Address dst, const std::function<void(RoutingTableEntry&)>& modifier);
     /**
      * Update routing table
      * \param rt entry with destination address dst, if exists
      * \return true on success
      */
     bool Update(RoutingTableEntry& rt);
+    /**
+     * Add a path to a destination, keeping the other loop-free paths learned with the same
+     * sequence number (AOMDV). A path with a newer sequence number, or to an inactive route,
+     * replaces the entry as in Update(); a path with the same sequence number becomes the route
+     * if it is shorter, and an alternate path otherwise.
+     * \param rt entry describing the path
+     * \return true if the entry was added, or the path was used or inserted
+     */
+    bool AddPath(RoutingTableEntry& rt);
+    /**
+     * Replace the route to a destination by its shortest alternate path
+     * \param dst destination address
+     * \return true on success
+     */
+    bool SwitchToAlternatePath(Ipv4Address dst);
+    /**
+     * Delete the alternate paths through a next hop from all entries
+     * \param nextHop the next hop address
+     */
+    void DeleteAlternatePaths(Ipv4Address nextHop);
     /**
      * Set routing table entry flags
      * \param dst destination address
@@ -518,9 +637,14 @@ class RoutingTable
     void Clear()
     {
         m_ipv4AddressEntry.clear();
+        m_expiryQueue = ExpiryQueue();
+        m_currentRecords.clear();
     }
 
-    /// Delete all outdated entries and invalidate valid entry if Lifetime is expired
+    /**
+     * Delete all outdated entries and invalidate valid entry if Lifetime is expired.
+     * Only the entries due according to the expiry queue are visited.
+     */
     void Purge();
     /** Mark entry as unidirectional (e.g. add this neighbor to "blacklist" for blacklistTimeout
      * period)
@@ -537,8 +661,31 @@ class RoutingTable
     void Print(Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
 
   private:
+    /// Expiration time, destination and number of a record of a routing table entry
+    typedef std::tuple<Time, Ipv4Address, uint64_t> ExpiryRecord;
+    /// Min-heap of expiry records, ordered by expiration time
+    typedef std::priority_queue<ExpiryRecord, std::vector<ExpiryRecord>, std::greater<>>
+        ExpiryQueue;
+
+    /**
+     * Push the current expiration time of an entry to the expiry queue, as
+     * the record replacing the former ones of the entry
+     * \param rt the routing table entry
+     */
+    void ScheduleExpiry(const RoutingTableEntry& rt);
+
     /// The routing table
     std::map<Ipv4Address, RoutingTableEntry> m_ipv4AddressEntry;
+    /**
+     * Expiry queue of the routing table. Records are not removed when an entry
+     * changes; every entry has a current record no later than its expiration
+     * time, and the records it replaced are dropped by Purge().
+     */
+    ExpiryQueue m_expiryQueue;
+    /// Number of the current expiry record of each entry, by destination
+    std::map<Ipv4Address, uint64_t> m_currentRecords;
+    /// Number of the next expiry record
+    uint64_t m_nextRecord;
     /// Deletion time for invalid routes
     Time m_badLinkLifetime;
     /**
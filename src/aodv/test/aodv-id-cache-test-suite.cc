@@ -101,6 +101,9 @@ void
 IdCacheTest::CheckTimeout2()
 {
     NS_TEST_EXPECT_MSG_EQ(cache.GetSize(), 3, "3 records left");
+    NS_TEST_EXPECT_MSG_EQ(cache.IsDuplicate(Ipv4Address("1.1.1.1"), 4), true, "Known ID");
+    NS_TEST_EXPECT_MSG_EQ(cache.IsDuplicate(Ipv4Address("1.2.3.4"), 3), false, "Expired ID");
+    NS_TEST_EXPECT_MSG_EQ(cache.IsDuplicate(Ipv4Address("1.2.3.4"), 3), true, "Renewed ID");
 }
 
 void
@@ -109,6 +112,99 @@ IdCacheTest::CheckTimeout3()
     NS_TEST_EXPECT_MSG_EQ(cache.GetSize(), 0, "All records expire");
 }
 
+/**
+ * \ingroup aodv-test
+ *
+ * \brief Unit test for the expiration of the id cache by bucket
+ *
+ * With a lifetime of 2 s, the IDs are added in the buckets [2 s, 4 s),
+ * [4 s, 6 s) and [6 s, 8 s). An expired ID is renewed while its old record is
+ * still listed in the first bucket, and the lifetime is changed to 1 s while
+ * some IDs are in the cache.
+ */
+class IdCacheBucketTest : public TestCase
+{
+  public:
+    IdCacheBucketTest()
+        : TestCase("Id Cache buckets"),
+          cache(Seconds(2))
+    {
+    }
+
+    void DoRun() override;
+
+  private:
+    /**
+     * Add an ID to the cache
+     * \param addr the address of the ID
+     * \param id the ID
+     * \param duplicate whether the ID must be a duplicate
+     */
+    void Add(Ipv4Address addr, uint32_t id, bool duplicate);
+    /**
+     * Check the size of the cache
+     * \param size the expected number of IDs
+     */
+    void CheckSize(uint32_t size);
+    /**
+     * Change the lifetime of the cache
+     * \param lifetime the new lifetime
+     */
+    void SetLifetime(Time lifetime);
+
+    /// ID cache
+    IdCache cache;
+};
+
+void
+IdCacheBucketTest::Add(Ipv4Address addr, uint32_t id, bool duplicate)
+{
+    NS_TEST_EXPECT_MSG_EQ(cache.IsDuplicate(addr, id),
+                          duplicate,
+                          "ID " << id << " at " << Simulator::Now().As(Time::S));
+}
+
+void
+IdCacheBucketTest::CheckSize(uint32_t size)
+{
+    NS_TEST_EXPECT_MSG_EQ(cache.GetSize(), size, "Size at " << Simulator::Now().As(Time::S));
+}
+
+void
+IdCacheBucketTest::SetLifetime(Time lifetime)
+{
+    cache.SetLifetime(lifetime);
+}
+
+void
+IdCacheBucketTest::DoRun()
+{
+    Ipv4Address addr("1.2.3.4");
+    // ID 1 expires at 2 s and ID 2 at 3 s, both in the bucket [2 s, 4 s)
+    Simulator::Schedule(Seconds(0), &IdCacheBucketTest::Add, this, addr, 1, false);
+    Simulator::Schedule(Seconds(1), &IdCacheBucketTest::Add, this, addr, 2, false);
+    Simulator::Schedule(Seconds(1.5), &IdCacheBucketTest::CheckSize, this, 2);
+    // ID 1 is renewed until 4.5 s, in the bucket [4 s, 6 s)
+    Simulator::Schedule(Seconds(2.5), &IdCacheBucketTest::Add, this, addr, 1, false);
+    Simulator::Schedule(Seconds(2.5), &IdCacheBucketTest::CheckSize, this, 2);
+    // ID 3 expires at 5.5 s, in the bucket [4 s, 6 s), and ID 2 has expired
+    Simulator::Schedule(Seconds(3.5), &IdCacheBucketTest::Add, this, addr, 3, false);
+    Simulator::Schedule(Seconds(3.5), &IdCacheBucketTest::CheckSize, this, 2);
+    // The first bucket is over, without dropping the renewed ID 1
+    Simulator::Schedule(Seconds(4.2), &IdCacheBucketTest::CheckSize, this, 2);
+    Simulator::Schedule(Seconds(4.2), &IdCacheBucketTest::Add, this, addr, 1, true);
+    Simulator::Schedule(Seconds(5), &IdCacheBucketTest::CheckSize, this, 1);
+    // With buckets of 1 s, ID 3 is in the bucket [5 s, 6 s), and ID 4 expires at 6 s
+    Simulator::Schedule(Seconds(5), &IdCacheBucketTest::SetLifetime, this, Seconds(1));
+    Simulator::Schedule(Seconds(5), &IdCacheBucketTest::Add, this, addr, 4, false);
+    Simulator::Schedule(Seconds(5.2), &IdCacheBucketTest::Add, this, addr, 3, true);
+    Simulator::Schedule(Seconds(5.7), &IdCacheBucketTest::CheckSize, this, 1);
+    Simulator::Schedule(Seconds(5.7), &IdCacheBucketTest::Add, this, addr, 4, true);
+    Simulator::Schedule(Seconds(6.5), &IdCacheBucketTest::CheckSize, this, 0);
+    Simulator::Run();
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup aodv-test
  *
@@ -121,6 +217,7 @@ class IdCacheTestSuite : public TestSuite
         : TestSuite("aodv-routing-id-cache", Type::UNIT)
     {
         AddTestCase(new IdCacheTest, TestCase::Duration::QUICK);
+        AddTestCase(new IdCacheBucketTest, TestCase::Duration::QUICK);
     }
 } g_idCacheTestSuite; ///< the test suite
 
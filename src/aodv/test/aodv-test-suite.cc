@@ -16,12 +16,28 @@
  *
  * Authors: Pavel Boyko <boyko@iitp.ru>
  */
+#include "ns3/aodv-helper.h"
 #include "ns3/aodv-neighbor.h"
 #include "ns3/aodv-packet.h"
+#include "ns3/aodv-routing-protocol.h"
 #include "ns3/aodv-rqueue.h"
 #include "ns3/aodv-rtable.h"
+#include "ns3/arp-cache.h"
+#include "ns3/boolean.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-l3-protocol.h"
 #include "ns3/ipv4-route.h"
+#include "ns3/simple-net-device-helper.h"
 #include "ns3/test.h"
+#include "ns3/udp-header.h"
+#include "ns3/udp-l4-protocol.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
+#include "ns3/wifi-mac-header.h"
+
+#include <limits>
 
 namespace ns3
 {
@@ -55,11 +71,14 @@ struct NeighborTest : public TestCase
     void CheckTimeout3();
     /// The Neighbors
     Neighbors* neighbor;
+    /// The neighbors notified by the link failure callback
+    std::vector<Ipv4Address> lost;
 };
 
 void
 NeighborTest::Handler(Ipv4Address addr)
 {
+    lost.push_back(addr);
 }
 
 void
@@ -84,6 +103,10 @@ NeighborTest::CheckTimeout2()
                           false,
                           "Neighbor doesn't exist");
     NS_TEST_EXPECT_MSG_EQ(neighbor->IsNeighbor(Ipv4Address("3.3.3.3")), true, "Neighbor exists");
+    NS_TEST_ASSERT_MSG_EQ(lost.size(), 3, "Each lost neighbor must be notified once");
+    NS_TEST_EXPECT_MSG_EQ(lost[0], Ipv4Address("1.1.1.1"), "Wrong notification order");
+    NS_TEST_EXPECT_MSG_EQ(lost[1], Ipv4Address("1.2.3.4"), "Wrong notification order");
+    NS_TEST_EXPECT_MSG_EQ(lost[2], Ipv4Address("2.2.2.2"), "Wrong notification order");
 }
 
 void
@@ -133,6 +156,105 @@ NeighborTest::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup aodv-test
+ *
+ * \brief Unit test for the MAC address index of the neighbors
+ *
+ * The MAC addresses of the neighbors are resolved through an ARP cache. A TX
+ * error must close the neighbor of the failed MAC address only, and a neighbor
+ * whose MAC address is resolved by a later update must be found by it.
+ */
+struct NeighborMacIndexTest : public TestCase
+{
+    NeighborMacIndexTest()
+        : TestCase("Neighbor MAC address index")
+    {
+    }
+
+    void DoRun() override;
+    /**
+     * Handler test function
+     * \param addr the IPv4 address of the neighbor
+     */
+    void Handler(Ipv4Address addr);
+    /**
+     * Add a permanent entry to the ARP cache
+     * \param addr the IPv4 address
+     * \param mac the MAC address
+     */
+    void AddArpEntry(Ipv4Address addr, Mac48Address mac);
+    /// The ARP cache resolving the MAC addresses of the neighbors
+    Ptr<ArpCache> arp;
+    /// The neighbors notified by the link failure callback
+    std::vector<Ipv4Address> lost;
+};
+
+void
+NeighborMacIndexTest::Handler(Ipv4Address addr)
+{
+    lost.push_back(addr);
+}
+
+void
+NeighborMacIndexTest::AddArpEntry(Ipv4Address addr, Mac48Address mac)
+{
+    ArpCache::Entry* entry = arp->Add(addr);
+    entry->SetMacAddress(mac);
+    entry->MarkPermanent();
+}
+
+void
+NeighborMacIndexTest::DoRun()
+{
+    Ipv4Address addr1("10.0.0.1");
+    Ipv4Address addr2("10.0.0.2");
+    Ipv4Address addr3("10.0.0.3");
+    Mac48Address mac1("00:00:00:00:00:01");
+    Mac48Address mac2("00:00:00:00:00:02");
+    Mac48Address mac3("00:00:00:00:00:03");
+    arp = CreateObject<ArpCache>();
+    AddArpEntry(addr1, mac1);
+    AddArpEntry(addr2, mac2);
+
+    Neighbors nb(Seconds(1));
+    nb.SetCallback(MakeCallback(&NeighborMacIndexTest::Handler, this));
+    nb.AddArpCache(arp);
+    nb.Update(addr1, Seconds(10));
+    nb.Update(addr2, Seconds(10));
+    // The MAC address of the third neighbor is not known yet
+    nb.Update(addr3, Seconds(10));
+
+    WifiMacHeader hdr;
+    hdr.SetAddr1(mac2);
+    nb.GetTxErrorCallback()(hdr);
+    NS_TEST_ASSERT_MSG_EQ(lost.size(), 1, "A single neighbor must be closed");
+    NS_TEST_EXPECT_MSG_EQ(lost[0], addr2, "The neighbor of the failed MAC address is closed");
+    NS_TEST_EXPECT_MSG_EQ(nb.IsNeighbor(addr1), true, "Neighbor exists");
+    NS_TEST_EXPECT_MSG_EQ(nb.IsNeighbor(addr2), false, "Neighbor doesn't exist");
+    NS_TEST_EXPECT_MSG_EQ(nb.IsNeighbor(addr3), true, "Neighbor exists");
+
+    hdr.SetAddr1(mac3);
+    nb.GetTxErrorCallback()(hdr);
+    NS_TEST_EXPECT_MSG_EQ(lost.size(), 1, "The MAC address is not resolved yet");
+
+    // The update resolves the MAC address, and moves the neighbor in the index
+    AddArpEntry(addr3, mac3);
+    nb.Update(addr3, Seconds(10));
+    hdr.SetAddr1(Mac48Address());
+    nb.GetTxErrorCallback()(hdr);
+    NS_TEST_EXPECT_MSG_EQ(lost.size(), 1, "The former MAC address must not be indexed");
+    NS_TEST_EXPECT_MSG_EQ(nb.IsNeighbor(addr3), true, "Neighbor exists");
+    hdr.SetAddr1(mac3);
+    nb.GetTxErrorCallback()(hdr);
+    NS_TEST_ASSERT_MSG_EQ(lost.size(), 2, "The re-indexed neighbor must be closed");
+    NS_TEST_EXPECT_MSG_EQ(lost[1], addr3, "The neighbor of the resolved MAC address is closed");
+    NS_TEST_EXPECT_MSG_EQ(nb.IsNeighbor(addr1), true, "Neighbor exists");
+    NS_TEST_EXPECT_MSG_EQ(nb.IsNeighbor(addr3), false, "Neighbor doesn't exist");
+
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup aodv-test
  *
@@ -456,6 +578,8 @@ struct AodvRqueueTest : public TestCase
 
     /// Check size limit function
     void CheckSizeLimit();
+    /// Check the order of the dequeued entries
+    void CheckOrder();
     /// Check timeout function
     void CheckTimeout();
 
@@ -511,6 +635,7 @@ AodvRqueueTest::DoRun()
     NS_TEST_EXPECT_MSG_EQ(q.GetSize(), 1, "trivial");
 
     CheckSizeLimit();
+    CheckOrder();
 
     Ipv4Header header2;
     Ipv4Address dst2("1.2.3.4");
@@ -544,10 +669,45 @@ AodvRqueueTest::CheckSizeLimit()
     NS_TEST_EXPECT_MSG_EQ(q.GetSize(), 2, "trivial");
 }
 
+void
+AodvRqueueTest::CheckOrder()
+{
+    Ipv4RoutingProtocol::UnicastForwardCallback ucb = MakeCallback(&AodvRqueueTest::Unicast, this);
+    Ipv4RoutingProtocol::ErrorCallback ecb = MakeCallback(&AodvRqueueTest::Error, this);
+    Ipv4Header h1;
+    h1.SetDestination(Ipv4Address("5.5.5.5"));
+    Ipv4Header h2;
+    h2.SetDestination(Ipv4Address("6.6.6.6"));
+    std::vector<uint64_t> uids;
+    // Overfill the queue: the entries queued before and the first two entries are dropped
+    for (uint32_t i = 0; i < q.GetMaxQueueLen() + 2; ++i)
+    {
+        Ptr<Packet> packet = Create<Packet>();
+        QueueEntry e(packet, (i % 2 == 0 ? h1 : h2), ucb, ecb, Seconds(1));
+        q.Enqueue(e);
+        uids.push_back(packet->GetUid());
+    }
+    NS_TEST_EXPECT_MSG_EQ(q.GetSize(), q.GetMaxQueueLen(), "The queue must stay at its limit");
+
+    QueueEntry e;
+    for (uint32_t i = 2; i < q.GetMaxQueueLen() + 2; i += 2)
+    {
+        NS_TEST_ASSERT_MSG_EQ(q.Dequeue(Ipv4Address("5.5.5.5"), e), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(e.GetPacket()->GetUid(),
+                              uids[i],
+                              "The most aged entries must be dropped, the others kept in order");
+    }
+    NS_TEST_EXPECT_MSG_EQ(q.Dequeue(Ipv4Address("5.5.5.5"), e), false, "trivial");
+    // The entries to 6.6.6.6 are left to expire
+    NS_TEST_EXPECT_MSG_EQ(q.GetSize(), q.GetMaxQueueLen() / 2, "trivial");
+    NS_TEST_EXPECT_MSG_EQ(q.Find(Ipv4Address("6.6.6.6")), true, "trivial");
+}
+
 void
 AodvRqueueTest::CheckTimeout()
 {
     NS_TEST_EXPECT_MSG_EQ(q.GetSize(), 0, "Must be empty now");
+    NS_TEST_EXPECT_MSG_EQ(q.Find(Ipv4Address("6.6.6.6")), false, "Expired entries must be purged");
 }
 
 /**
@@ -726,10 +886,481 @@ struct AodvRtableTest : public TestCase
         NS_TEST_EXPECT_MSG_EQ(rt.GetFlag(), INVALID, "trivial");
         NS_TEST_EXPECT_MSG_EQ(rtable.DeleteRoute(Ipv4Address("1.2.3.4")), true, "trivial");
         NS_TEST_EXPECT_MSG_EQ(rtable.DeleteRoute(Ipv4Address("1.2.3.4")), false, "trivial");
+        NS_TEST_EXPECT_MSG_EQ((rtable.FindRoute(Ipv4Address("1.2.3.4")) == nullptr),
+                              true,
+                              "trivial");
+        const RoutingTableEntry* entry = rtable.FindRoute(Ipv4Address("4.3.2.1"));
+        NS_TEST_ASSERT_MSG_EQ((entry != nullptr), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(entry->GetFlag(), INVALID, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(rtable.ModifyRoute(Ipv4Address("4.3.2.1"),
+                                                 [](RoutingTableEntry& r) { r.SetHop(7); }),
+                              true,
+                              "trivial");
+        NS_TEST_EXPECT_MSG_EQ(entry->GetHop(), 7, "Entry must be modified in place");
+        NS_TEST_EXPECT_MSG_EQ(rtable.ModifyRoute(Ipv4Address("1.2.3.4"),
+                                                 [](RoutingTableEntry& r) { r.SetHop(7); }),
+                              false,
+                              "trivial");
+        Simulator::Destroy();
+    }
+};
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief Unit test for the expiration of AODV routing table entries
+ */
+struct AodvRtableExpiryTest : public TestCase
+{
+    AodvRtableExpiryTest()
+        : TestCase("RtableExpiry"),
+          rtable(Seconds(1))
+    {
+    }
+
+    void DoRun() override;
+
+    /**
+     * Add a route
+     * \param dst the destination address
+     * \param lifetime the lifetime of the route
+     */
+    void AddRoute(Ipv4Address dst, Time lifetime)
+    {
+        RoutingTableEntry rt(/*output device*/ nullptr,
+                             /*dst*/ dst,
+                             /*validSeqNo*/ true,
+                             /*seqNo*/ 1,
+                             /*interface*/ Ipv4InterfaceAddress(),
+                             /*hop*/ 1,
+                             /*next hop*/ dst,
+                             /*lifetime*/ lifetime);
+        rtable.AddRoute(rt);
+    }
+
+    /// Extend the lifetime of a route and shorten another one, at 1.5 s
+    void UpdateLifetimes();
+    /// Check the routes at 2.75 s
+    void CheckExpiry();
+    /// Check the routes at 4 s
+    void CheckDeletion();
+
+    /// Routing table
+    RoutingTable rtable;
+};
+
+void
+AodvRtableExpiryTest::DoRun()
+{
+    AddRoute(Ipv4Address("10.0.0.1"), Seconds(1));
+    AddRoute(Ipv4Address("10.0.0.2"), Seconds(2));
+    AddRoute(Ipv4Address("10.0.0.3"), Seconds(10));
+    Simulator::Schedule(Seconds(1.5), &AodvRtableExpiryTest::UpdateLifetimes, this);
+    Simulator::Schedule(Seconds(2.75), &AodvRtableExpiryTest::CheckExpiry, this);
+    Simulator::Schedule(Seconds(4), &AodvRtableExpiryTest::CheckDeletion, this);
+    Simulator::Run();
+    Simulator::Destroy();
+}
+
+void
+AodvRtableExpiryTest::UpdateLifetimes()
+{
+    RoutingTableEntry rt;
+    NS_TEST_ASSERT_MSG_EQ(rtable.LookupRoute(Ipv4Address("10.0.0.1"), rt), true, "trivial");
+    NS_TEST_EXPECT_MSG_EQ(rt.GetFlag(), INVALID, "Expired route must be invalidated");
+    NS_TEST_ASSERT_MSG_EQ(rtable.LookupRoute(Ipv4Address("10.0.0.2"), rt), true, "trivial");
+    rt.SetLifeTime(Seconds(2));
+    rtable.Update(rt);
+    NS_TEST_ASSERT_MSG_EQ(rtable.LookupRoute(Ipv4Address("10.0.0.3"), rt), true, "trivial");
+    rt.SetLifeTime(Seconds(0.5));
+    rtable.Update(rt);
+}
+
+void
+AodvRtableExpiryTest::CheckExpiry()
+{
+    RoutingTableEntry rt;
+    NS_TEST_EXPECT_MSG_EQ(rtable.LookupRoute(Ipv4Address("10.0.0.1"), rt),
+                          false,
+                          "Invalid route must be deleted");
+    NS_TEST_EXPECT_MSG_EQ(rtable.LookupValidRoute(Ipv4Address("10.0.0.2"), rt),
+                          true,
+                          "Extended route must stay valid");
+    NS_TEST_ASSERT_MSG_EQ(rtable.LookupRoute(Ipv4Address("10.0.0.3"), rt), true, "trivial");
+    NS_TEST_EXPECT_MSG_EQ(rt.GetFlag(), INVALID, "Shortened route must be invalidated");
+}
+
+void
+AodvRtableExpiryTest::CheckDeletion()
+{
+    RoutingTableEntry rt;
+    NS_TEST_ASSERT_MSG_EQ(rtable.LookupRoute(Ipv4Address("10.0.0.2"), rt), true, "trivial");
+    NS_TEST_EXPECT_MSG_EQ(rt.GetFlag(), INVALID, "Extended route must expire");
+    NS_TEST_EXPECT_MSG_EQ(rtable.LookupRoute(Ipv4Address("10.0.0.3"), rt), false, "trivial");
+}
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief Unit test for the alternate paths of AODV routing table entries
+ */
+struct AodvRtableMultipathTest : public TestCase
+{
+    AodvRtableMultipathTest()
+        : TestCase("RtableMultipath")
+    {
+    }
+
+    /**
+     * Create an entry describing a path to 1.2.3.4
+     * \param seqNo the sequence number
+     * \param hops the hop count
+     * \param nextHop the next hop address
+     * \return the entry
+     */
+    static RoutingTableEntry Path(uint32_t seqNo, uint16_t hops, Ipv4Address nextHop)
+    {
+        return RoutingTableEntry(/*output device*/ nullptr,
+                                 /*dst*/ Ipv4Address("1.2.3.4"),
+                                 /*validSeqNo*/ true,
+                                 /*seqNo*/ seqNo,
+                                 /*interface*/ Ipv4InterfaceAddress(),
+                                 /*hop*/ hops,
+                                 /*next hop*/ nextHop,
+                                 /*lifetime*/ Seconds(10));
+    }
+
+    void DoRun() override
+    {
+        RoutingTable rtable(Seconds(2));
+        Ipv4Address dst("1.2.3.4");
+        RoutingTableEntry rt = Path(5, 3, Ipv4Address("10.0.0.1"));
+        NS_TEST_EXPECT_MSG_EQ(rtable.AddPath(rt), true, "New route");
+        rt = Path(5, 4, Ipv4Address("10.0.0.2"));
+        NS_TEST_EXPECT_MSG_EQ(rtable.AddPath(rt), true, "Longer path must be an alternate");
+        NS_TEST_EXPECT_MSG_EQ(rtable.AddPath(rt), false, "Known path must only be refreshed");
+        const RoutingTableEntry* entry = rtable.FindRoute(dst);
+        NS_TEST_ASSERT_MSG_EQ((entry != nullptr), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(entry->GetNextHop(), Ipv4Address("10.0.0.1"), "trivial");
+        NS_TEST_EXPECT_MSG_EQ(entry->GetAlternatePathCount(), 1, "trivial");
+
+        uint16_t advertisedHops = 0;
+        rtable.ModifyRoute(dst, [&advertisedHops](RoutingTableEntry& r) {
+            advertisedHops = r.AdvertiseHopCount();
+        });
+        NS_TEST_EXPECT_MSG_EQ(advertisedHops, 4, "Longest path must be advertised");
+        rt = Path(5, 5, Ipv4Address("10.0.0.3"));
+        NS_TEST_EXPECT_MSG_EQ(rtable.AddPath(rt), false, "Path above advertised hop count");
+        rt = Path(5, 2, Ipv4Address("10.0.0.4"));
+        NS_TEST_EXPECT_MSG_EQ(rtable.AddPath(rt), true, "Shorter path must be the route");
+        NS_TEST_EXPECT_MSG_EQ(entry->GetNextHop(), Ipv4Address("10.0.0.4"), "trivial");
+        NS_TEST_EXPECT_MSG_EQ(entry->GetAlternatePathCount(), 2, "trivial");
+        rt = Path(4, 1, Ipv4Address("10.0.0.5"));
+        NS_TEST_EXPECT_MSG_EQ(rtable.AddPath(rt), false, "Stale sequence number");
+
+        rtable.DeleteAlternatePaths(Ipv4Address("10.0.0.1"));
+        NS_TEST_EXPECT_MSG_EQ(entry->GetAlternatePathCount(), 1, "trivial");
+        rtable.SetEntryState(dst, INVALID);
+        NS_TEST_EXPECT_MSG_EQ(rtable.SwitchToAlternatePath(dst), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(entry->GetNextHop(), Ipv4Address("10.0.0.2"), "trivial");
+        NS_TEST_EXPECT_MSG_EQ(entry->GetHop(), 4, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(entry->GetFlag(), VALID, "Switched route must be valid");
+        NS_TEST_EXPECT_MSG_EQ(rtable.SwitchToAlternatePath(dst), false, "No path left");
+
+        rt = Path(5, 1, Ipv4Address("10.0.0.6"));
+        NS_TEST_EXPECT_MSG_EQ(rtable.AddPath(rt), true, "trivial");
+        rt = Path(6, 7, Ipv4Address("10.0.0.7"));
+        NS_TEST_EXPECT_MSG_EQ(rtable.AddPath(rt), true, "Newer sequence number");
+        entry = rtable.FindRoute(dst);
+        NS_TEST_EXPECT_MSG_EQ(entry->GetNextHop(), Ipv4Address("10.0.0.7"), "trivial");
+        NS_TEST_EXPECT_MSG_EQ(entry->GetAlternatePathCount(), 0, "Paths must be reset");
         Simulator::Destroy();
     }
 };
 
+/**
+ * \ingroup aodv-test
+ *
+ * \brief Unit test for the routes learned from overheard messages
+ */
+struct AodvPassiveLearningTest : public TestCase
+{
+    AodvPassiveLearningTest()
+        : TestCase("PassiveLearning")
+    {
+    }
+
+    /**
+     * Create a RREP unicast from 10.0.0.2 to 10.0.0.3, as received by a device
+     * \param hops the hop count of the RREP
+     * \param dst the destination of the RREP
+     * \param seqNo the destination sequence number
+     * \return the packet, starting with the IPv4 header
+     */
+    static Ptr<Packet> Rrep(uint8_t hops, Ipv4Address dst, uint32_t seqNo)
+    {
+        Ptr<Packet> packet = Create<Packet>();
+        packet->AddHeader(RrepHeader(/*prefixSize*/ 0,
+                                     /*hopCount*/ hops,
+                                     /*dst*/ dst,
+                                     /*dstSeqNo*/ seqNo,
+                                     /*origin*/ Ipv4Address("10.0.0.4"),
+                                     /*lifetime*/ Seconds(10)));
+        packet->AddHeader(TypeHeader(AODVTYPE_RREP));
+        UdpHeader udpHeader;
+        udpHeader.SetSourcePort(RoutingProtocol::AODV_PORT);
+        udpHeader.SetDestinationPort(RoutingProtocol::AODV_PORT);
+        packet->AddHeader(udpHeader);
+        Ipv4Header ipHeader;
+        ipHeader.SetSource(Ipv4Address("10.0.0.2"));
+        ipHeader.SetDestination(Ipv4Address("10.0.0.3"));
+        ipHeader.SetProtocol(UdpL4Protocol::PROT_NUMBER);
+        ipHeader.SetPayloadSize(packet->GetSize());
+        packet->AddHeader(ipHeader);
+        return packet;
+    }
+
+    void DoRun() override
+    {
+        NodeContainer nodes;
+        nodes.Create(1);
+        AodvHelper aodv;
+        aodv.Set("EnablePassiveLearning", BooleanValue(true));
+        InternetStackHelper internetStack;
+        internetStack.SetRoutingHelper(aodv);
+        internetStack.Install(nodes);
+        SimpleNetDeviceHelper simpleNetHelper;
+        NetDeviceContainer devices = simpleNetHelper.Install(nodes);
+        Ipv4AddressHelper address;
+        address.SetBase("10.0.0.0", "255.255.255.0");
+        address.Assign(devices);
+        Ptr<RoutingProtocol> aodvProtocol =
+            DynamicCast<RoutingProtocol>(nodes.Get(0)->GetObject<Ipv4>()->GetRoutingProtocol());
+        NS_TEST_ASSERT_MSG_NE(aodvProtocol, nullptr, "trivial");
+        RoutingTable& rtable = aodvProtocol->m_routingTable;
+
+        Ipv4Address receiver("10.0.0.1");
+        Ipv4Address dst("10.0.0.9");
+        RoutingTableEntry rt;
+        aodvProtocol->LearnRoute(receiver, 1, 1, Ipv4Address("10.0.0.2"), receiver, Seconds(10));
+        NS_TEST_EXPECT_MSG_EQ(rtable.LookupRoute(receiver, rt), false, "No route to itself");
+        aodvProtocol->LearnRoute(dst, 5, 3, Ipv4Address("10.0.0.2"), receiver, Seconds(10));
+        NS_TEST_ASSERT_MSG_EQ(rtable.LookupRoute(dst, rt), true, "New route");
+        NS_TEST_EXPECT_MSG_EQ(rt.GetNextHop(), Ipv4Address("10.0.0.2"), "trivial");
+        NS_TEST_EXPECT_MSG_EQ(rt.GetHop(), 3, "trivial");
+        rtable.ModifyRoute(dst, [](RoutingTableEntry& r) {
+            r.InsertPrecursor(Ipv4Address("10.0.0.8"));
+        });
+
+        aodvProtocol->LearnRoute(dst, 5, 4, Ipv4Address("10.0.0.3"), receiver, Seconds(10));
+        rtable.LookupRoute(dst, rt);
+        NS_TEST_EXPECT_MSG_EQ(rt.GetNextHop(), Ipv4Address("10.0.0.2"), "Longer route ignored");
+        aodvProtocol->LearnRoute(dst, 4, 1, Ipv4Address("10.0.0.3"), receiver, Seconds(10));
+        rtable.LookupRoute(dst, rt);
+        NS_TEST_EXPECT_MSG_EQ(rt.GetNextHop(), Ipv4Address("10.0.0.2"), "Stale route ignored");
+        aodvProtocol->LearnRoute(dst, 5, 2, Ipv4Address("10.0.0.3"), receiver, Seconds(10));
+        rtable.LookupRoute(dst, rt);
+        NS_TEST_EXPECT_MSG_EQ(rt.GetNextHop(), Ipv4Address("10.0.0.3"), "Shorter route");
+        NS_TEST_EXPECT_MSG_EQ(rt.GetHop(), 2, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(rt.IsPrecursorListEmpty(), false, "Precursors must be kept");
+        aodvProtocol->LearnRoute(dst, 6, 5, Ipv4Address("10.0.0.4"), receiver, Seconds(10));
+        rtable.LookupRoute(dst, rt);
+        NS_TEST_EXPECT_MSG_EQ(rt.GetNextHop(), Ipv4Address("10.0.0.4"), "Newer route");
+        NS_TEST_EXPECT_MSG_EQ(rt.GetSeqNo(), 6, "trivial");
+        rtable.SetEntryState(dst, INVALID);
+        aodvProtocol->LearnRoute(dst, 6, 7, Ipv4Address("10.0.0.5"), receiver, Seconds(10));
+        rtable.LookupRoute(dst, rt);
+        NS_TEST_EXPECT_MSG_EQ(rt.GetNextHop(), Ipv4Address("10.0.0.5"), "Invalid route replaced");
+        NS_TEST_EXPECT_MSG_EQ(rt.GetFlag(), VALID, "trivial");
+
+        // Only the RREPs addressed to other nodes are learned from
+        Ptr<NetDevice> device = devices.Get(0);
+        Address mac = device->GetAddress();
+        dst = Ipv4Address("10.0.0.10");
+        aodvProtocol->PromiscReceive(device,
+                                     Rrep(2, dst, 10),
+                                     Ipv4L3Protocol::PROT_NUMBER,
+                                     mac,
+                                     mac,
+                                     NetDevice::PACKET_HOST);
+        NS_TEST_EXPECT_MSG_EQ(rtable.LookupRoute(dst, rt), false, "RREP received by the sockets");
+        aodvProtocol->PromiscReceive(device,
+                                     Rrep(2, dst, 10),
+                                     Ipv4L3Protocol::PROT_NUMBER,
+                                     mac,
+                                     mac,
+                                     NetDevice::PACKET_OTHERHOST);
+        NS_TEST_ASSERT_MSG_EQ(rtable.LookupRoute(dst, rt), true, "Overheard RREP");
+        NS_TEST_EXPECT_MSG_EQ(rt.GetNextHop(), Ipv4Address("10.0.0.2"), "trivial");
+        NS_TEST_EXPECT_MSG_EQ(rt.GetHop(), 3, "Hop count of the RREP sender plus one");
+        NS_TEST_EXPECT_MSG_EQ(rt.GetSeqNo(), 10, "trivial");
+        NS_TEST_ASSERT_MSG_EQ(rtable.LookupRoute(Ipv4Address("10.0.0.2"), rt), true, "Neighbor");
+        NS_TEST_EXPECT_MSG_EQ(rt.GetHop(), 1, "trivial");
+        aodvProtocol->PromiscReceive(device,
+                                     Rrep(1, dst, 9),
+                                     Ipv4L3Protocol::PROT_NUMBER,
+                                     mac,
+                                     mac,
+                                     NetDevice::PACKET_OTHERHOST);
+        rtable.LookupRoute(dst, rt);
+        NS_TEST_EXPECT_MSG_EQ(rt.GetSeqNo(), 10, "Stale RREP ignored");
+
+        Simulator::Destroy();
+    }
+};
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief Unit test for the TTL of the adaptive expanding ring search
+ */
+struct AodvAdaptiveTtlTest : public TestCase
+{
+    AodvAdaptiveTtlTest()
+        : TestCase("AdaptiveTtl")
+    {
+    }
+
+    void DoRun() override
+    {
+        // TtlStart is 1, TtlIncrement is 2 and NetDiameter is 35
+        Ptr<RoutingProtocol> aodvProtocol = CreateObject<RoutingProtocol>();
+        Ipv4Address dst("10.0.0.1");
+        NS_TEST_EXPECT_MSG_EQ(aodvProtocol->GetAdaptiveTtl(dst), 1, "No discovery yet");
+        aodvProtocol->RecordHopCount(dst, 3);
+        NS_TEST_EXPECT_MSG_EQ(aodvProtocol->GetAdaptiveTtl(dst), 5, "Last hop count + 2");
+        NS_TEST_EXPECT_MSG_EQ(aodvProtocol->GetAdaptiveTtl(Ipv4Address("10.0.0.2")),
+                              3,
+                              "Median of a single discovery");
+        aodvProtocol->RecordHopCount(Ipv4Address("10.0.0.3"), 5);
+        aodvProtocol->RecordHopCount(Ipv4Address("10.0.0.4"), 6);
+        NS_TEST_EXPECT_MSG_EQ(aodvProtocol->GetAdaptiveTtl(Ipv4Address("10.0.0.2")),
+                              5,
+                              "Median of 3, 5 and 6");
+        aodvProtocol->RecordHopCount(dst, 1);
+        NS_TEST_EXPECT_MSG_EQ(aodvProtocol->GetAdaptiveTtl(dst), 3, "Last hop count + 2");
+        NS_TEST_EXPECT_MSG_EQ(aodvProtocol->GetAdaptiveTtl(Ipv4Address("10.0.0.2")),
+                              3,
+                              "Lower median of 1, 3, 5 and 6");
+        aodvProtocol->RecordHopCount(Ipv4Address("10.0.0.5"), 40);
+        NS_TEST_EXPECT_MSG_EQ(aodvProtocol->GetAdaptiveTtl(Ipv4Address("10.0.0.5")),
+                              35,
+                              "TTL above NetDiameter");
+
+        // The destination recorded first is forgotten
+        aodvProtocol = CreateObject<RoutingProtocol>();
+        aodvProtocol->SetAttribute("MaxHopCountHistory", UintegerValue(2));
+        Simulator::Schedule(Seconds(1),
+                            &RoutingProtocol::RecordHopCount,
+                            aodvProtocol,
+                            Ipv4Address("10.0.0.3"),
+                            4);
+        Simulator::Schedule(Seconds(2),
+                            &RoutingProtocol::RecordHopCount,
+                            aodvProtocol,
+                            Ipv4Address("10.0.0.2"),
+                            4);
+        Simulator::Schedule(Seconds(3),
+                            &RoutingProtocol::RecordHopCount,
+                            aodvProtocol,
+                            Ipv4Address("10.0.0.3"),
+                            6);
+        Simulator::Schedule(Seconds(4),
+                            &RoutingProtocol::RecordHopCount,
+                            aodvProtocol,
+                            Ipv4Address("10.0.0.4"),
+                            8);
+        Simulator::Run();
+        NS_TEST_EXPECT_MSG_EQ(aodvProtocol->m_hopCountHistory.size(), 2, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(aodvProtocol->GetAdaptiveTtl(Ipv4Address("10.0.0.3")),
+                              8,
+                              "Refreshed destination kept");
+        NS_TEST_EXPECT_MSG_EQ(aodvProtocol->GetAdaptiveTtl(Ipv4Address("10.0.0.2")),
+                              4,
+                              "Forgotten destination gets the median");
+        Simulator::Destroy();
+    }
+};
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief Test the delivery of a packet queued by the transport protocol down target
+ */
+struct AodvDirectDeferralTest : public TestCase
+{
+    AodvDirectDeferralTest()
+        : TestCase("DirectDeferral"),
+          m_count(0),
+          m_loopbackCount(0)
+    {
+    }
+
+    /**
+     * Receive a packet
+     * \param socket the receiving socket
+     */
+    void ReceivePkt(Ptr<Socket> socket)
+    {
+        socket->Recv(std::numeric_limits<uint32_t>::max(), 0);
+        m_count++;
+    }
+
+    /**
+     * Count the packets sent on the loopback interface
+     * \param packet the packet
+     * \param ipv4 the IPv4 protocol
+     * \param interface the interface index
+     */
+    void Tx(Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+    {
+        if (interface == 0)
+        {
+            m_loopbackCount++;
+        }
+    }
+
+    void DoRun() override
+    {
+        NodeContainer nodes;
+        nodes.Create(2);
+        AodvHelper aodv;
+        aodv.Set("EnableDirectDeferral", BooleanValue(true));
+        InternetStackHelper internetStack;
+        internetStack.SetRoutingHelper(aodv);
+        internetStack.Install(nodes);
+        SimpleNetDeviceHelper simpleNetHelper;
+        NetDeviceContainer devices = simpleNetHelper.Install(nodes);
+        Ipv4AddressHelper address;
+        address.SetBase("10.0.0.0", "255.255.255.0");
+        address.Assign(devices);
+        nodes.Get(0)->GetObject<Ipv4L3Protocol>()->TraceConnectWithoutContext(
+            "Tx",
+            MakeCallback(&AodvDirectDeferralTest::Tx, this));
+
+        Ptr<Socket> rxSocket = nodes.Get(1)->GetObject<UdpSocketFactory>()->CreateSocket();
+        rxSocket->Bind(InetSocketAddress(Ipv4Address::GetAny(), 9));
+        rxSocket->SetRecvCallback(MakeCallback(&AodvDirectDeferralTest::ReceivePkt, this));
+        Ptr<Socket> txSocket = nodes.Get(0)->GetObject<UdpSocketFactory>()->CreateSocket();
+        Simulator::ScheduleWithContext(nodes.Get(0)->GetId(), Seconds(1), [txSocket]() {
+            txSocket->SendTo(Create<Packet>(123), 0, InetSocketAddress(Ipv4Address("10.0.0.2"), 9));
+        });
+        Simulator::Stop(Seconds(3));
+        Simulator::Run();
+        txSocket->Close();
+        rxSocket->Close();
+        Simulator::Destroy();
+
+        NS_TEST_EXPECT_MSG_EQ(m_count, 1, "The packet must be delivered once the route is found");
+        NS_TEST_EXPECT_MSG_EQ(m_loopbackCount, 0, "The packet must not go through the loopback");
+    }
+
+    /// Number of packets received
+    uint32_t m_count;
+    /// Number of packets sent on the loopback interface
+    uint32_t m_loopbackCount;
+};
+
 /**
  * \ingroup aodv-test
  *
@@ -742,6 +1373,7 @@ class AodvTestSuite : public TestSuite
         : TestSuite("routing-aodv", Type::UNIT)
     {
         AddTestCase(new NeighborTest, TestCase::Duration::QUICK);
+        AddTestCase(new NeighborMacIndexTest, TestCase::Duration::QUICK);
         AddTestCase(new TypeHeaderTest, TestCase::Duration::QUICK);
         AddTestCase(new RreqHeaderTest, TestCase::Duration::QUICK);
         AddTestCase(new RrepHeaderTest, TestCase::Duration::QUICK);
@@ -751,6 +1383,11 @@ class AodvTestSuite : public TestSuite
         AddTestCase(new AodvRqueueTest, TestCase::Duration::QUICK);
         AddTestCase(new AodvRtableEntryTest, TestCase::Duration::QUICK);
         AddTestCase(new AodvRtableTest, TestCase::Duration::QUICK);
+        AddTestCase(new AodvRtableExpiryTest, TestCase::Duration::QUICK);
+        AddTestCase(new AodvRtableMultipathTest, TestCase::Duration::QUICK);
+        AddTestCase(new AodvPassiveLearningTest, TestCase::Duration::QUICK);
+        AddTestCase(new AodvAdaptiveTtlTest, TestCase::Duration::QUICK);
+        AddTestCase(new AodvDirectDeferralTest, TestCase::Duration::QUICK);
     }
 } g_aodvTestSuite; ///< the test suite
 
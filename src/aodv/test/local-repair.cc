@@ -0,0 +1,278 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/aodv-helper.h"
+#include "ns3/aodv-packet.h"
+#include "ns3/aodv-routing-protocol.h"
+#include "ns3/boolean.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-raw-socket-factory.h"
+#include "ns3/ipv4-raw-socket-impl.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/socket-factory.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/udp-header.h"
+#include "ns3/udp-l4-protocol.h"
+#include "ns3/udp-socket-factory.h"
+
+#include <limits>
+#include <map>
+
+namespace ns3
+{
+namespace aodv
+{
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief AODV local repair test case
+ *
+ * With two upstream nodes, node 0 sends a packet to node 3 along the chain
+ * 0 -- 1 -- 2 -- 3, then the link 1 -- 2 breaks and node 0 sends a second
+ * packet. If node 4 links nodes 1 and 2 from the time of the break, node 1
+ * repairs the route through it, and reports the longer route to node 0 with a
+ * RERR with the 'N' flag. Otherwise, the repair fails and node 0 receives a
+ * plain RERR. With three upstream nodes, the chain is 0 -- 1 -- 2 -- 3 -- 4,
+ * the link 2 -- 3 breaks, node 5 links nodes 2 and 3, and node 1 forwards the
+ * RERR of node 2 to node 0.
+ */
+class LocalRepairTestCase : public TestCase
+{
+    bool m_alternatePath;                   //!< whether the broken link is bypassed
+    uint32_t m_upstream;                    //!< number of nodes before the broken link
+    NetDeviceContainer m_devices;           //!< the devices of the nodes
+    Ptr<SimpleChannel> m_channel;           //!< the channel shared by the devices
+    Ptr<Socket> m_txSocket;                 //!< transmit socket of node 0
+    Ptr<Socket> m_rxSocket;                 //!< receive socket of the destination
+    Ptr<Ipv4RawSocketImpl> m_rerrSocket;    //!< socket of node 0 receiving the RERRs
+    uint32_t m_count;                       //!< number of packets received by the destination
+    std::map<Ipv4Address, bool> m_noDelete; //!< 'N' flag of the RERRs, by destination
+
+    /**
+     * Set the state of the link between two nodes
+     * \param i the index of the first node
+     * \param j the index of the second node
+     * \param up whether the nodes receive each other
+     */
+    void SetLink(uint32_t i, uint32_t j, bool up);
+    /// Break the link after the upstream nodes, and bypass it for the alternate path
+    void BreakLink();
+    /// Send a data packet from node 0 to the destination
+    void SendData();
+    /// \return the address of the destination, the last node of the chain
+    Ipv4Address GetDestination() const;
+    /**
+     * Receive a data packet on the destination
+     * \param socket The socket receiving the data
+     */
+    void ReceivePkt(Ptr<Socket> socket);
+    /**
+     * Receive a UDP packet on node 0 and record the content of the RERRs
+     * \param socket The raw socket receiving the packet
+     */
+    void ReceiveRerr(Ptr<Socket> socket);
+
+  public:
+    /**
+     * Constructor
+     * \param alternatePath whether the broken link is bypassed by an extra node
+     * \param upstream the number of nodes before the broken link, at least 2
+     */
+    LocalRepairTestCase(bool alternatePath, uint32_t upstream = 2);
+    void DoRun() override;
+};
+
+LocalRepairTestCase::LocalRepairTestCase(bool alternatePath, uint32_t upstream)
+    : TestCase(upstream > 2 ? "Local repair reported to the source through a precursor"
+               : alternatePath ? "Local repair through a longer route"
+                               : "Failed local repair"),
+      m_alternatePath(alternatePath),
+      m_upstream(upstream),
+      m_count(0)
+{
+}
+
+Ipv4Address
+LocalRepairTestCase::GetDestination() const
+{
+    // The nodes are numbered from 10.1.1.1
+    return Ipv4Address(Ipv4Address("10.1.1.1").Get() + m_upstream + 1);
+}
+
+void
+LocalRepairTestCase::SetLink(uint32_t i, uint32_t j, bool up)
+{
+    Ptr<SimpleNetDevice> a = DynamicCast<SimpleNetDevice>(m_devices.Get(i));
+    Ptr<SimpleNetDevice> b = DynamicCast<SimpleNetDevice>(m_devices.Get(j));
+    if (up)
+    {
+        m_channel->UnBlackList(a, b);
+        m_channel->UnBlackList(b, a);
+    }
+    else
+    {
+        m_channel->BlackList(a, b);
+        m_channel->BlackList(b, a);
+    }
+}
+
+void
+LocalRepairTestCase::BreakLink()
+{
+    SetLink(m_upstream - 1, m_upstream, false);
+    if (m_alternatePath)
+    {
+        SetLink(m_upstream - 1, m_upstream + 2, true);
+        SetLink(m_upstream + 2, m_upstream, true);
+    }
+}
+
+void
+LocalRepairTestCase::SendData()
+{
+    m_txSocket->SendTo(Create<Packet>(123), 0, InetSocketAddress(GetDestination(), 9));
+}
+
+void
+LocalRepairTestCase::ReceivePkt(Ptr<Socket> socket)
+{
+    Ptr<Packet> receivedPacket = socket->Recv(std::numeric_limits<uint32_t>::max(), 0);
+
+    m_count++;
+}
+
+void
+LocalRepairTestCase::ReceiveRerr(Ptr<Socket> socket)
+{
+    Ptr<Packet> packet = socket->Recv(std::numeric_limits<uint32_t>::max(), 0);
+    Ipv4Header ipHeader;
+    packet->RemoveHeader(ipHeader);
+    UdpHeader udpHeader;
+    packet->RemoveHeader(udpHeader);
+    if (udpHeader.GetDestinationPort() != RoutingProtocol::AODV_PORT)
+    {
+        return;
+    }
+    TypeHeader typeHeader;
+    packet->RemoveHeader(typeHeader);
+    if (typeHeader.Get() != AODVTYPE_RERR)
+    {
+        return;
+    }
+    RerrHeader rerrHeader;
+    packet->RemoveHeader(rerrHeader);
+    std::pair<Ipv4Address, uint32_t> un;
+    while (rerrHeader.RemoveUnDestination(un))
+    {
+        m_noDelete[un.first] = rerrHeader.GetNoDelete();
+    }
+}
+
+void
+LocalRepairTestCase::DoRun()
+{
+    NodeContainer nodes;
+    nodes.Create(m_upstream + 3);
+
+    // Setup TCP/IP & AODV
+    AodvHelper aodv;
+    aodv.Set("EnableLocalRepair", BooleanValue(true));
+    InternetStackHelper internetStack;
+    internetStack.SetRoutingHelper(aodv);
+    internetStack.Install(nodes);
+    SimpleNetDeviceHelper simpleNetHelper;
+    simpleNetHelper.SetChannelAttribute("Delay", StringValue("2ms"));
+    m_devices = simpleNetHelper.Install(nodes);
+    m_channel = DynamicCast<SimpleChannel>(m_devices.Get(0)->GetChannel());
+    Ipv4AddressHelper address;
+    address.SetBase("10.1.1.0", "255.255.255.0");
+    address.Assign(m_devices);
+
+    // Chain from node 0 to the destination, the last node being isolated
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        for (uint32_t j = i + 1; j < nodes.GetN(); j++)
+        {
+            SetLink(i, j, j == i + 1 && j < nodes.GetN() - 1);
+        }
+    }
+
+    // Setup sockets
+    m_rxSocket = nodes.Get(m_upstream + 1)->GetObject<UdpSocketFactory>()->CreateSocket();
+    m_rxSocket->Bind(InetSocketAddress(Ipv4Address::GetAny(), 9));
+    m_rxSocket->SetRecvCallback(MakeCallback(&LocalRepairTestCase::ReceivePkt, this));
+    m_txSocket = nodes.Get(0)->GetObject<UdpSocketFactory>()->CreateSocket();
+    Ptr<SocketFactory> rawSocketFactory = nodes.Get(0)->GetObject<Ipv4RawSocketFactory>();
+    m_rerrSocket = DynamicCast<Ipv4RawSocketImpl>(rawSocketFactory->CreateSocket());
+    m_rerrSocket->SetProtocol(UdpL4Protocol::PROT_NUMBER);
+    m_rerrSocket->SetRecvCallback(MakeCallback(&LocalRepairTestCase::ReceiveRerr, this));
+
+    // The link break is detected when the next hop has not been heard for a while, before
+    // the route to the destination expires
+    Simulator::ScheduleWithContext(nodes.Get(0)->GetId(),
+                                   Seconds(1),
+                                   &LocalRepairTestCase::SendData,
+                                   this);
+    Simulator::Schedule(Seconds(1.5), &LocalRepairTestCase::BreakLink, this);
+    Simulator::ScheduleWithContext(nodes.Get(0)->GetId(),
+                                   Seconds(8),
+                                   &LocalRepairTestCase::SendData,
+                                   this);
+
+    Simulator::Stop(Seconds(10));
+    Simulator::Run();
+
+    m_txSocket->Close();
+    m_rxSocket->Close();
+    m_rerrSocket->Close();
+
+    Simulator::Destroy();
+
+    NS_TEST_EXPECT_MSG_EQ(m_count,
+                          (m_alternatePath ? 2 : 1),
+                          "The second packet must only be delivered through a repaired route");
+    auto rerr = m_noDelete.find(GetDestination());
+    NS_TEST_ASSERT_MSG_EQ((rerr != m_noDelete.end()), true, "Node 0 must be sent a RERR");
+    NS_TEST_EXPECT_MSG_EQ(rerr->second,
+                          m_alternatePath,
+                          "Only the RERR of a repaired route must have the 'N' flag");
+}
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief AODV local repair test suite
+ */
+class AodvLocalRepairTestSuite : public TestSuite
+{
+  public:
+    AodvLocalRepairTestSuite()
+        : TestSuite("routing-aodv-local-repair", Type::SYSTEM)
+    {
+        AddTestCase(new LocalRepairTestCase(true), TestCase::Duration::QUICK);
+        AddTestCase(new LocalRepairTestCase(false), TestCase::Duration::QUICK);
+        AddTestCase(new LocalRepairTestCase(true, 3), TestCase::Duration::QUICK);
+    }
+} g_aodvLocalRepairTestSuite; ///< the test suite
+
+} // namespace aodv
+} // namespace ns3
@@ -0,0 +1,318 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/aodv-helper.h"
+#include "ns3/aodv-packet.h"
+#include "ns3/aodv-routing-protocol.h"
+#include "ns3/boolean.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-raw-socket-factory.h"
+#include "ns3/ipv4-raw-socket-impl.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/socket-factory.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/udp-header.h"
+#include "ns3/udp-l4-protocol.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
+
+#include <limits>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace ns3
+{
+namespace aodv
+{
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief AODV multipath test case
+ *
+ * Node 0 sends a packet to node 3, which is reached through the paths
+ * 0 -- 1 -- 3, 0 -- 2 -- 4 -- 3 and 0 -- 2 -- 5 -- 6 -- 3. Node 3 answers the
+ * three copies of the RREQ, and node 2 forwards the RREPs of both its paths
+ * with the hop count it advertised first. Then either the link 0 -- 1 breaks,
+ * or the link 1 -- 3 breaks and node 1 sends a RERR to node 0: in both cases,
+ * node 0 sends a second packet through node 2 without a new route discovery.
+ */
+class MultipathTestCase : public TestCase
+{
+    bool m_breakFirstHop;                                   //!< whether the link 0 -- 1 breaks
+    NetDeviceContainer m_devices;                           //!< the devices of the nodes
+    Ptr<SimpleChannel> m_channel;                           //!< the channel of the devices
+    Ptr<Socket> m_txSocket;                                 //!< transmit socket of node 0
+    Ptr<Socket> m_rxSocket;                                 //!< receive socket of node 3
+    Ptr<Ipv4RawSocketImpl> m_rrepSocket;                    //!< RREP socket of node 0
+    Ptr<Ipv4RawSocketImpl> m_rreqSocket;                    //!< RREQ socket of node 2
+    uint32_t m_count;                                       //!< packets received by node 3
+    std::map<Ipv4Address, std::vector<uint8_t>> m_rrepHops; //!< RREP hop counts, by sender
+    std::set<uint32_t> m_rreqIds;                           //!< IDs of the RREQs of node 0
+
+    /**
+     * Set the state of the link between two nodes
+     * \param i the index of the first node
+     * \param j the index of the second node
+     * \param up whether the nodes receive each other
+     */
+    void SetLink(uint32_t i, uint32_t j, bool up);
+    /// Send a data packet from node 0 to node 3
+    void SendData();
+    /**
+     * Receive a data packet on node 3
+     * \param socket The socket receiving the data
+     */
+    void ReceivePkt(Ptr<Socket> socket);
+    /**
+     * Receive an AODV packet on a raw socket
+     * \param socket The raw socket receiving the packet
+     * \param ipHeader The IPv4 header of the packet
+     * \param typeHeader The AODV type header of the packet
+     * \return the packet after the AODV type header, or nullptr if it is not an AODV packet
+     */
+    static Ptr<Packet> ReceiveAodv(Ptr<Socket> socket,
+                                   Ipv4Header& ipHeader,
+                                   TypeHeader& typeHeader);
+    /**
+     * Receive a packet on node 0 and record the hop count of the RREPs to node 3
+     * \param socket The raw socket receiving the packet
+     */
+    void ReceiveRrep(Ptr<Socket> socket);
+    /**
+     * Receive a packet on node 2 and record the IDs of the RREQs of node 0
+     * \param socket The raw socket receiving the packet
+     */
+    void ReceiveRreq(Ptr<Socket> socket);
+
+  public:
+    /**
+     * Constructor
+     * \param breakFirstHop whether the link 0 -- 1 breaks, rather than the link 1 -- 3
+     */
+    MultipathTestCase(bool breakFirstHop);
+    void DoRun() override;
+};
+
+MultipathTestCase::MultipathTestCase(bool breakFirstHop)
+    : TestCase(breakFirstHop ? "Switch to an alternate path on a link break"
+                             : "Switch to an alternate path on a RERR"),
+      m_breakFirstHop(breakFirstHop),
+      m_count(0)
+{
+}
+
+void
+MultipathTestCase::SetLink(uint32_t i, uint32_t j, bool up)
+{
+    Ptr<SimpleNetDevice> a = DynamicCast<SimpleNetDevice>(m_devices.Get(i));
+    Ptr<SimpleNetDevice> b = DynamicCast<SimpleNetDevice>(m_devices.Get(j));
+    if (up)
+    {
+        m_channel->UnBlackList(a, b);
+        m_channel->UnBlackList(b, a);
+    }
+    else
+    {
+        m_channel->BlackList(a, b);
+        m_channel->BlackList(b, a);
+    }
+}
+
+void
+MultipathTestCase::SendData()
+{
+    m_txSocket->SendTo(Create<Packet>(123), 0, InetSocketAddress(Ipv4Address("10.1.1.4"), 9));
+}
+
+void
+MultipathTestCase::ReceivePkt(Ptr<Socket> socket)
+{
+    Ptr<Packet> receivedPacket = socket->Recv(std::numeric_limits<uint32_t>::max(), 0);
+
+    m_count++;
+}
+
+Ptr<Packet>
+MultipathTestCase::ReceiveAodv(Ptr<Socket> socket, Ipv4Header& ipHeader, TypeHeader& typeHeader)
+{
+    Ptr<Packet> packet = socket->Recv(std::numeric_limits<uint32_t>::max(), 0);
+    packet->RemoveHeader(ipHeader);
+    UdpHeader udpHeader;
+    packet->RemoveHeader(udpHeader);
+    if (udpHeader.GetDestinationPort() != RoutingProtocol::AODV_PORT)
+    {
+        return nullptr;
+    }
+    packet->RemoveHeader(typeHeader);
+    return packet;
+}
+
+void
+MultipathTestCase::ReceiveRrep(Ptr<Socket> socket)
+{
+    Ipv4Header ipHeader;
+    TypeHeader typeHeader;
+    Ptr<Packet> packet = ReceiveAodv(socket, ipHeader, typeHeader);
+    if (!packet || typeHeader.Get() != AODVTYPE_RREP)
+    {
+        return;
+    }
+    RrepHeader rrepHeader;
+    packet->RemoveHeader(rrepHeader);
+    if (rrepHeader.GetDst() == Ipv4Address("10.1.1.4") &&
+        rrepHeader.GetOrigin() == Ipv4Address("10.1.1.1"))
+    {
+        m_rrepHops[ipHeader.GetSource()].push_back(rrepHeader.GetHopCount());
+    }
+}
+
+void
+MultipathTestCase::ReceiveRreq(Ptr<Socket> socket)
+{
+    Ipv4Header ipHeader;
+    TypeHeader typeHeader;
+    Ptr<Packet> packet = ReceiveAodv(socket, ipHeader, typeHeader);
+    if (!packet || typeHeader.Get() != AODVTYPE_RREQ)
+    {
+        return;
+    }
+    RreqHeader rreqHeader;
+    packet->RemoveHeader(rreqHeader);
+    if (rreqHeader.GetOrigin() == Ipv4Address("10.1.1.1"))
+    {
+        m_rreqIds.insert(rreqHeader.GetId());
+    }
+}
+
+void
+MultipathTestCase::DoRun()
+{
+    NodeContainer nodes;
+    nodes.Create(7);
+
+    // Setup TCP/IP & AODV. Only the destination answers the RREQs, and the first RREQ
+    // reaches it through all the paths.
+    AodvHelper aodv;
+    aodv.Set("EnableMultipath", BooleanValue(true));
+    aodv.Set("DestinationOnly", BooleanValue(true));
+    aodv.Set("TtlStart", UintegerValue(7));
+    InternetStackHelper internetStack;
+    internetStack.SetRoutingHelper(aodv);
+    internetStack.Install(nodes);
+    SimpleNetDeviceHelper simpleNetHelper;
+    // Longer than the forwarding jitter, so that the shorter paths are found first
+    simpleNetHelper.SetChannelAttribute("Delay", StringValue("30ms"));
+    m_devices = simpleNetHelper.Install(nodes);
+    m_channel = DynamicCast<SimpleChannel>(m_devices.Get(0)->GetChannel());
+    Ipv4AddressHelper address;
+    address.SetBase("10.1.1.0", "255.255.255.0");
+    address.Assign(m_devices);
+
+    const std::set<std::pair<uint32_t, uint32_t>> links =
+        {{0, 1}, {1, 3}, {0, 2}, {2, 4}, {3, 4}, {2, 5}, {5, 6}, {3, 6}};
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        for (uint32_t j = i + 1; j < nodes.GetN(); j++)
+        {
+            SetLink(i, j, links.count({i, j}) != 0);
+        }
+    }
+
+    // Setup sockets
+    m_rxSocket = nodes.Get(3)->GetObject<UdpSocketFactory>()->CreateSocket();
+    m_rxSocket->Bind(InetSocketAddress(Ipv4Address::GetAny(), 9));
+    m_rxSocket->SetRecvCallback(MakeCallback(&MultipathTestCase::ReceivePkt, this));
+    m_txSocket = nodes.Get(0)->GetObject<UdpSocketFactory>()->CreateSocket();
+    Ptr<SocketFactory> rawSocketFactory = nodes.Get(0)->GetObject<Ipv4RawSocketFactory>();
+    m_rrepSocket = DynamicCast<Ipv4RawSocketImpl>(rawSocketFactory->CreateSocket());
+    m_rrepSocket->SetProtocol(UdpL4Protocol::PROT_NUMBER);
+    m_rrepSocket->SetRecvCallback(MakeCallback(&MultipathTestCase::ReceiveRrep, this));
+    rawSocketFactory = nodes.Get(2)->GetObject<Ipv4RawSocketFactory>();
+    m_rreqSocket = DynamicCast<Ipv4RawSocketImpl>(rawSocketFactory->CreateSocket());
+    m_rreqSocket->SetProtocol(UdpL4Protocol::PROT_NUMBER);
+    m_rreqSocket->SetRecvCallback(MakeCallback(&MultipathTestCase::ReceiveRreq, this));
+
+    // The link break is detected when the next hop has not been heard for a while
+    Simulator::ScheduleWithContext(nodes.Get(0)->GetId(),
+                                   Seconds(1),
+                                   &MultipathTestCase::SendData,
+                                   this);
+    Simulator::Schedule(Seconds(1.5),
+                        &MultipathTestCase::SetLink,
+                        this,
+                        m_breakFirstHop ? 0 : 1,
+                        m_breakFirstHop ? 1 : 3,
+                        false);
+    Simulator::ScheduleWithContext(nodes.Get(0)->GetId(),
+                                   Seconds(5),
+                                   &MultipathTestCase::SendData,
+                                   this);
+
+    Simulator::Stop(Seconds(6));
+    Simulator::Run();
+
+    m_txSocket->Close();
+    m_rxSocket->Close();
+    m_rrepSocket->Close();
+    m_rreqSocket->Close();
+
+    Simulator::Destroy();
+
+    NS_TEST_EXPECT_MSG_EQ(m_rrepHops[Ipv4Address("10.1.1.2")].size(),
+                          1,
+                          "Node 3 must answer the RREQ through node 1");
+    NS_TEST_EXPECT_MSG_EQ(m_rrepHops[Ipv4Address("10.1.1.3")].size(),
+                          2,
+                          "Node 3 must answer both duplicate RREQs through node 2");
+    for (uint8_t hops : m_rrepHops[Ipv4Address("10.1.1.2")])
+    {
+        NS_TEST_EXPECT_MSG_EQ(uint32_t(hops), 1, "Wrong hop count through node 1");
+    }
+    for (uint8_t hops : m_rrepHops[Ipv4Address("10.1.1.3")])
+    {
+        NS_TEST_EXPECT_MSG_EQ(uint32_t(hops),
+                              2,
+                              "Node 2 must forward the hop count it advertised first");
+    }
+    NS_TEST_EXPECT_MSG_EQ(m_count, 2, "The second packet must go through the alternate path");
+    NS_TEST_EXPECT_MSG_EQ(m_rreqIds.size(), 1, "The alternate path must not need a discovery");
+}
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief AODV multipath test suite
+ */
+class AodvMultipathTestSuite : public TestSuite
+{
+  public:
+    AodvMultipathTestSuite()
+        : TestSuite("routing-aodv-multipath", Type::SYSTEM)
+    {
+        AddTestCase(new MultipathTestCase(true), TestCase::Duration::QUICK);
+        AddTestCase(new MultipathTestCase(false), TestCase::Duration::QUICK);
+    }
+} g_aodvMultipathTestSuite; ///< the test suite
+
+} // namespace aodv
+} // namespace ns3
@@ -18,15 +18,277 @@
  */
 #include "olsr-helper.h"
 
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
 #include "ns3/ipv4-list-routing.h"
+#include "ns3/mobility-model.h"
 #include "ns3/names.h"
 #include "ns3/node-list.h"
 #include "ns3/olsr-routing-protocol.h"
 #include "ns3/ptr.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 namespace ns3
 {
 
+namespace
+{
+/// Magic number of the OLSR checkpoint files ("OLSR").
+const uint32_t OLSR_CHECKPOINT_MAGIC = 0x4f4c5352;
+
+/**
+ * Finds the OLSR routing protocol of a node, either as its routing protocol
+ * or in its list of routing protocols.
+ * \param node The node.
+ * \returns The OLSR routing protocol, or a null pointer if not installed.
+ */
+Ptr<olsr::RoutingProtocol>
+GetOlsr(Ptr<Node> node)
+{
+    Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+    NS_ASSERT_MSG(ipv4, "Ipv4 not installed on node");
+    Ptr<Ipv4RoutingProtocol> proto = ipv4->GetRoutingProtocol();
+    NS_ASSERT_MSG(proto, "Ipv4 routing not installed on node");
+    Ptr<olsr::RoutingProtocol> olsr = DynamicCast<olsr::RoutingProtocol>(proto);
+    Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting>(proto);
+    if (!olsr && list)
+    {
+        int16_t priority;
+        for (uint32_t i = 0; i < list->GetNRoutingProtocols() && !olsr; i++)
+        {
+            olsr = DynamicCast<olsr::RoutingProtocol>(list->GetRoutingProtocol(i, priority));
+        }
+    }
+    return olsr;
+}
+
+/**
+ * Writes a 32-bit value to a checkpoint file, in network byte order.
+ * \param os The checkpoint file.
+ * \param value The value.
+ */
+void
+WriteU32(std::ostream& os, uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+    {
+        os.put(static_cast<char>(value >> shift));
+    }
+}
+
+/**
+ * Reads a 32-bit value from a checkpoint file, in network byte order.
+ * \param is The checkpoint file.
+ * \returns The value.
+ */
+uint32_t
+ReadU32(std::istream& is)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        value = (value << 8) | static_cast<uint8_t>(is.get());
+    }
+    return value;
+}
+
+/**
+ * Writes the profiling counters of a set of nodes, and schedules the next dump.
+ * \param printInterval The time interval between two dumps.
+ * \param c The nodes.
+ * \param stream The output stream.
+ */
+void
+PrintProfile(Time printInterval, NodeContainer c, Ptr<OutputStreamWrapper> stream)
+{
+    for (auto i = c.Begin(); i != c.End(); ++i)
+    {
+        Ptr<olsr::RoutingProtocol> olsr = GetOlsr(*i);
+        if (olsr)
+        {
+            olsr->GetProfiler().PrintCsv(*stream->GetStream(), Simulator::Now(), (*i)->GetId());
+        }
+    }
+    Simulator::Schedule(printInterval, &PrintProfile, printInterval, c, stream);
+}
+
+/// Link of the oracle topology.
+struct OracleEdge
+{
+    uint32_t neighbor;    //!< Index of the neighbor node.
+    uint32_t interface;   //!< Local interface index.
+    Ipv4Address nextAddr; //!< Address of the neighbor on the link.
+};
+
+/// Node of the oracle topology.
+struct OracleNode
+{
+    Ptr<olsr::RoutingProtocol> olsr; //!< OLSR routing protocol.
+    Vector position;                 //!< Position.
+    std::vector<std::pair<uint32_t, Ipv4InterfaceAddress>>
+        addresses;                                //!< OLSR interfaces and their addresses.
+    std::vector<OracleEdge> edges;                //!< Links to the nodes in range.
+    std::vector<olsr::RoutingTableEntry> entries; //!< Computed routing table.
+};
+
+/**
+ * Calls a function on each index of a range, using several threads.
+ * The function must not touch the simulator nor reference counted objects.
+ * \param n The size of the range.
+ * \param threads The number of threads.
+ * \param f The function.
+ */
+void
+ParallelFor(uint32_t n, uint32_t threads, const std::function<void(uint32_t)>& f)
+{
+    std::vector<std::thread> workers;
+    for (uint32_t t = 1; t < threads && t < n; t++)
+    {
+        workers.emplace_back([&f, n, threads, t]() {
+            for (uint32_t i = t; i < n; i += threads)
+            {
+                f(i);
+            }
+        });
+    }
+    for (uint32_t i = 0; i < n; i += threads)
+    {
+        f(i);
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+/**
+ * Computes the shortest paths between a set of nodes from their positions,
+ * installs them in their routing tables, and schedules the next epoch.
+ * \param c The nodes.
+ * \param range The communication range, in meters.
+ * \param epoch The time interval between two computations, or zero.
+ * \param threads The number of threads.
+ */
+void
+RunOracle(NodeContainer c, double range, Time epoch, uint32_t threads)
+{
+    // Snapshot the topology in the simulation thread.
+    std::vector<OracleNode> nodes;
+    for (auto i = c.Begin(); i != c.End(); ++i)
+    {
+        OracleNode node;
+        node.olsr = GetOlsr(*i);
+        if (!node.olsr)
+        {
+            continue;
+        }
+        Ptr<MobilityModel> mobility = (*i)->GetObject<MobilityModel>();
+        NS_ABORT_MSG_IF(!mobility, "OLSR oracle requires a mobility model on each node");
+        node.position = mobility->GetPosition();
+        Ptr<Ipv4> ipv4 = (*i)->GetObject<Ipv4>();
+        std::set<uint32_t> exclusions = node.olsr->GetInterfaceExclusions();
+        for (uint32_t interface = 0; interface < ipv4->GetNInterfaces(); interface++)
+        {
+            if (exclusions.find(interface) != exclusions.end() || !ipv4->IsUp(interface))
+            {
+                continue;
+            }
+            for (uint32_t j = 0; j < ipv4->GetNAddresses(interface); j++)
+            {
+                Ipv4InterfaceAddress address = ipv4->GetAddress(interface, j);
+                if (address.GetLocal() != Ipv4Address::GetLoopback())
+                {
+                    node.addresses.emplace_back(interface, address);
+                }
+            }
+        }
+        nodes.push_back(node);
+    }
+    uint32_t n = nodes.size();
+
+    // Link the nodes in range that share a subnet.
+    ParallelFor(n, threads, [&nodes, n, range](uint32_t u) {
+        OracleNode& node = nodes[u];
+        for (uint32_t v = 0; v < n; v++)
+        {
+            if (v == u || CalculateDistance(node.position, nodes[v].position) > range)
+            {
+                continue;
+            }
+            bool linked = false;
+            for (const auto& local : node.addresses)
+            {
+                Ipv4Mask mask = local.second.GetMask();
+                for (const auto& remote : nodes[v].addresses)
+                {
+                    if (!linked && local.second.GetLocal().CombineMask(mask) ==
+                                       remote.second.GetLocal().CombineMask(mask))
+                    {
+                        node.edges.push_back({v, local.first, remote.second.GetLocal()});
+                        linked = true;
+                    }
+                }
+            }
+        }
+    });
+
+    // Breadth-first search from each node.
+    ParallelFor(n, threads, [&nodes, n](uint32_t source) {
+        std::vector<uint32_t> distance(n, std::numeric_limits<uint32_t>::max());
+        std::vector<const OracleEdge*> firstHop(n, nullptr);
+        std::deque<uint32_t> queue;
+        std::vector<olsr::RoutingTableEntry>& entries = nodes[source].entries;
+        entries.clear();
+        distance[source] = 0;
+        queue.push_back(source);
+        while (!queue.empty())
+        {
+            uint32_t u = queue.front();
+            queue.pop_front();
+            for (const auto& edge : nodes[u].edges)
+            {
+                uint32_t v = edge.neighbor;
+                if (distance[v] != std::numeric_limits<uint32_t>::max())
+                {
+                    continue;
+                }
+                distance[v] = distance[u] + 1;
+                firstHop[v] = (u == source ? &edge : firstHop[u]);
+                queue.push_back(v);
+                for (const auto& address : nodes[v].addresses)
+                {
+                    olsr::RoutingTableEntry entry;
+                    entry.destAddr = address.second.GetLocal();
+                    entry.nextAddr = firstHop[v]->nextAddr;
+                    entry.interface = firstHop[v]->interface;
+                    entry.distance = distance[v];
+                    entries.push_back(entry);
+                }
+            }
+        }
+    });
+
+    for (const auto& node : nodes)
+    {
+        node.olsr->SetRoutingTableEntries(node.entries);
+    }
+
+    if (epoch.IsStrictlyPositive())
+    {
+        Simulator::Schedule(epoch, &RunOracle, c, range, epoch, threads);
+    }
+}
+} // unnamed namespace
+
 OlsrHelper::OlsrHelper()
 {
     m_agentFactory.SetTypeId("ns3::olsr::RoutingProtocol");
@@ -124,4 +386,98 @@ OlsrHelper::AssignStreams(NodeContainer c, int64_t stream)
     return (currentStream - stream);
 }
 
+void
+OlsrHelper::SaveCheckpoint(NodeContainer c, std::string filename) const
+{
+    std::ofstream file(filename, std::ios::binary);
+    NS_ABORT_MSG_IF(!file, "Cannot open OLSR checkpoint file " << filename);
+    WriteU32(file, OLSR_CHECKPOINT_MAGIC);
+    for (auto i = c.Begin(); i != c.End(); ++i)
+    {
+        Ptr<olsr::RoutingProtocol> olsr = GetOlsr(*i);
+        if (!olsr)
+        {
+            continue;
+        }
+        std::ostringstream state;
+        olsr->SaveCheckpoint(state);
+        WriteU32(file, (*i)->GetId());
+        WriteU32(file, state.str().size());
+        file << state.str();
+    }
+}
+
+void
+OlsrHelper::LoadCheckpoint(NodeContainer c, std::string filename) const
+{
+    std::ifstream file(filename, std::ios::binary);
+    NS_ABORT_MSG_IF(!file, "Cannot open OLSR checkpoint file " << filename);
+    NS_ABORT_MSG_IF(ReadU32(file) != OLSR_CHECKPOINT_MAGIC,
+                    filename << " is not an OLSR checkpoint file");
+
+    std::map<uint32_t, std::string> states;
+    while (file.peek() != std::ifstream::traits_type::eof())
+    {
+        uint32_t nodeId = ReadU32(file);
+        std::string state(ReadU32(file), '\0');
+        file.read(&state[0], state.size());
+        NS_ABORT_MSG_IF(!file, "Truncated OLSR checkpoint file " << filename);
+        states[nodeId] = std::move(state);
+    }
+
+    for (auto i = c.Begin(); i != c.End(); ++i)
+    {
+        Ptr<olsr::RoutingProtocol> olsr = GetOlsr(*i);
+        auto state = states.find((*i)->GetId());
+        if (olsr && state != states.end())
+        {
+            std::istringstream is(state->second);
+            olsr->LoadCheckpoint(is);
+        }
+    }
+}
+
+olsr::ProfileCounters
+OlsrHelper::GetProfileCounters(NodeContainer c, olsr::ProfilePhase phase) const
+{
+    olsr::ProfileCounters counters;
+    for (auto i = c.Begin(); i != c.End(); ++i)
+    {
+        Ptr<olsr::RoutingProtocol> olsr = GetOlsr(*i);
+        if (olsr)
+        {
+            counters += olsr->GetProfiler().GetCounters(phase);
+        }
+    }
+    return counters;
+}
+
+void
+OlsrHelper::PrintProfileEvery(Time printInterval,
+                              NodeContainer c,
+                              Ptr<OutputStreamWrapper> stream) const
+{
+    olsr::Profiler::PrintCsvHeader(*stream->GetStream());
+    Simulator::Schedule(printInterval, &PrintProfile, printInterval, c, stream);
+}
+
+void
+OlsrHelper::EnableOracle(NodeContainer c, double range, Time epoch, uint32_t threads) const
+{
+    NS_ABORT_MSG_IF(range <= 0, "OLSR oracle range must be positive");
+    for (auto i = c.Begin(); i != c.End(); ++i)
+    {
+        Ptr<olsr::RoutingProtocol> olsr = GetOlsr(*i);
+        if (olsr)
+        {
+            olsr->SetAttribute("Oracle", BooleanValue(true));
+        }
+    }
+    if (threads == 0)
+    {
+        threads = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    Simulator::Schedule(Seconds(0), &RunOracle, c, range, epoch, threads);
+}
+
 } // namespace ns3
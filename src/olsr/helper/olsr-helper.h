@@ -23,6 +23,8 @@
 #include "ns3/node-container.h"
 #include "ns3/node.h"
 #include "ns3/object-factory.h"
+#include "ns3/olsr-profiler.h"
+#include "ns3/output-stream-wrapper.h"
 
 #include <map>
 #include <set>
@@ -103,6 +105,71 @@ class OlsrHelper : public Ipv4RoutingHelper
      */
     int64_t AssignStreams(NodeContainer c, int64_t stream);
 
+    /**
+     * Write the OLSR state of a set of nodes to a checkpoint file (see
+     * ns3::olsr::RoutingProtocol::SaveCheckpoint). The file can be loaded by
+     * LoadCheckpoint in a later simulation of the same topology, to skip the
+     * convergence of the protocol.
+     *
+     * \param c NodeContainer of the set of nodes to save
+     * \param filename The name of the checkpoint file
+     */
+    void SaveCheckpoint(NodeContainer c, std::string filename) const;
+
+    /**
+     * Restore the OLSR state of a set of nodes from a checkpoint file written
+     * by SaveCheckpoint. The nodes are matched by their ID. This is meant to be
+     * called before the simulation starts.
+     *
+     * \param c NodeContainer of the set of nodes to restore
+     * \param filename The name of the checkpoint file
+     */
+    void LoadCheckpoint(NodeContainer c, std::string filename) const;
+
+    /**
+     * Sum the control plane profiling counters of a phase over a set of nodes
+     * (see ns3::olsr::RoutingProtocol::GetProfiler).
+     *
+     * \param c NodeContainer of the set of nodes
+     * \param phase The phase
+     * \returns The counters of the phase, summed over the nodes
+     */
+    olsr::ProfileCounters GetProfileCounters(NodeContainer c, olsr::ProfilePhase phase) const;
+
+    /**
+     * Periodically write the control plane profiling counters of a set of
+     * nodes in CSV format, one line per node and phase. The counters are
+     * cumulative since the start of the simulation.
+     *
+     * \param printInterval The time interval between two dumps
+     * \param c NodeContainer of the set of nodes
+     * \param stream The output stream
+     */
+    void PrintProfileEvery(Time printInterval,
+                           NodeContainer c,
+                           Ptr<OutputStreamWrapper> stream) const;
+
+    /**
+     * Replace the OLSR protocol of a set of nodes by a global oracle, as an
+     * upper bound of what OLSR can achieve. The nodes send no control
+     * message (see the Oracle attribute of ns3::olsr::RoutingProtocol);
+     * instead, at every epoch, the oracle computes the shortest paths (in
+     * hops) between all the nodes from their positions, and installs them in
+     * their routing tables. Two nodes are linked when they are within range
+     * of each other and have OLSR interfaces on the same subnet.
+     *
+     * This is meant to be called before the simulation starts. Each node
+     * needs a mobility model.
+     *
+     * \param c NodeContainer of the set of nodes
+     * \param range The communication range, in meters (unit disk model)
+     * \param epoch The time interval between two computations, or zero to
+     *              compute the routes only once at the start of the simulation
+     * \param threads The number of threads computing the paths, or zero to use
+     *                all the hardware threads
+     */
+    void EnableOracle(NodeContainer c, double range, Time epoch, uint32_t threads = 0) const;
+
   private:
     ObjectFactory m_agentFactory; //!< Object factory
 
@@ -27,6 +27,7 @@
 #define IPV4_ADDRESS_SIZE 4
 #define OLSR_MSG_HEADER_SIZE 12
 #define OLSR_PKT_HEADER_SIZE 4
+#define OLSR_LQ_SIZE 4
 
 namespace ns3
 {
@@ -197,8 +198,13 @@ MessageHeader::GetSerializedSize() const
                                             << m_message.hello.GetSerializedSize());
         size += m_message.hello.GetSerializedSize();
         break;
+    case LQ_HELLO_MESSAGE:
+        size += m_message.hello.GetSerializedSize(true);
+        break;
     case TC_MESSAGE:
-        size += m_message.tc.GetSerializedSize();
+    case LQ_TC_MESSAGE:
+    case DELTA_TC_MESSAGE:
+        size += m_message.tc.GetSerializedSize(m_messageType);
         break;
     case HNA_MESSAGE:
         size += m_message.hna.GetSerializedSize();
@@ -226,6 +232,15 @@ MessageHeader::Print(std::ostream& os) const
     case HNA_MESSAGE:
         os << "type: HNA";
         break;
+    case LQ_HELLO_MESSAGE:
+        os << "type: LQ_HELLO";
+        break;
+    case LQ_TC_MESSAGE:
+        os << "type: LQ_TC";
+        break;
+    case DELTA_TC_MESSAGE:
+        os << "type: DELTA_TC";
+        break;
     }
 
     os << " TTL: " << +m_timeToLive;
@@ -241,9 +256,12 @@ MessageHeader::Print(std::ostream& os) const
         m_message.mid.Print(os);
         break;
     case HELLO_MESSAGE:
+    case LQ_HELLO_MESSAGE:
         m_message.hello.Print(os);
         break;
     case TC_MESSAGE:
+    case LQ_TC_MESSAGE:
+    case DELTA_TC_MESSAGE:
         m_message.tc.Print(os);
         break;
     case HNA_MESSAGE:
@@ -274,8 +292,13 @@ MessageHeader::Serialize(Buffer::Iterator start) const
     case HELLO_MESSAGE:
         m_message.hello.Serialize(i);
         break;
+    case LQ_HELLO_MESSAGE:
+        m_message.hello.Serialize(i, true);
+        break;
     case TC_MESSAGE:
-        m_message.tc.Serialize(i);
+    case LQ_TC_MESSAGE:
+    case DELTA_TC_MESSAGE:
+        m_message.tc.Serialize(i, m_messageType);
         break;
     case HNA_MESSAGE:
         m_message.hna.Serialize(i);
@@ -291,7 +314,8 @@ MessageHeader::Deserialize(Buffer::Iterator start)
     uint32_t size;
     Buffer::Iterator i = start;
     m_messageType = (MessageType)i.ReadU8();
-    NS_ASSERT(m_messageType >= HELLO_MESSAGE && m_messageType <= HNA_MESSAGE);
+    NS_ASSERT((m_messageType >= HELLO_MESSAGE && m_messageType <= HNA_MESSAGE) ||
+              (m_messageType >= LQ_HELLO_MESSAGE && m_messageType <= DELTA_TC_MESSAGE));
     m_vTime = i.ReadU8();
     m_messageSize = i.ReadNtohU16();
     m_originatorAddress = Ipv4Address(i.ReadNtohU32());
@@ -307,8 +331,13 @@ MessageHeader::Deserialize(Buffer::Iterator start)
     case HELLO_MESSAGE:
         size += m_message.hello.Deserialize(i, m_messageSize - OLSR_MSG_HEADER_SIZE);
         break;
+    case LQ_HELLO_MESSAGE:
+        size += m_message.hello.Deserialize(i, m_messageSize - OLSR_MSG_HEADER_SIZE, true);
+        break;
     case TC_MESSAGE:
-        size += m_message.tc.Deserialize(i, m_messageSize - OLSR_MSG_HEADER_SIZE);
+    case LQ_TC_MESSAGE:
+    case DELTA_TC_MESSAGE:
+        size += m_message.tc.Deserialize(i, m_messageSize - OLSR_MSG_HEADER_SIZE, m_messageType);
         break;
     case HNA_MESSAGE:
         size += m_message.hna.Deserialize(i, m_messageSize - OLSR_MSG_HEADER_SIZE);
@@ -380,14 +409,15 @@ MessageHeader::Mid::Deserialize(Buffer::Iterator start, uint32_t messageSize)
 // ---------------- OLSR HELLO Message -------------------------------
 
 uint32_t
-MessageHeader::Hello::GetSerializedSize() const
+MessageHeader::Hello::GetSerializedSize(bool linkQuality) const
 {
+    uint32_t addressSize = IPV4_ADDRESS_SIZE + (linkQuality ? OLSR_LQ_SIZE : 0);
     uint32_t size = 4;
     for (auto iter = this->linkMessages.begin(); iter != this->linkMessages.end(); iter++)
     {
         const LinkMessage& lm = *iter;
         size += 4;
-        size += IPV4_ADDRESS_SIZE * lm.neighborInterfaceAddresses.size();
+        size += addressSize * lm.neighborInterfaceAddresses.size();
     }
     return size;
 }
@@ -421,9 +451,10 @@ MessageHeader::Hello::Print(std::ostream& os) const
 }
 
 void
-MessageHeader::Hello::Serialize(Buffer::Iterator start) const
+MessageHeader::Hello::Serialize(Buffer::Iterator start, bool linkQuality) const
 {
     Buffer::Iterator i = start;
+    uint32_t addressSize = IPV4_ADDRESS_SIZE + (linkQuality ? OLSR_LQ_SIZE : 0);
 
     i.WriteU16(0); // Reserved
     i.WriteU8(this->hTime);
@@ -440,21 +471,28 @@ MessageHeader::Hello::Serialize(Buffer::Iterator start) const
         // from the beginning of the "Link Code" field and until the
         // next "Link Code" field (or - if there are no more link types
         // - the end of the message).
-        i.WriteHtonU16(4 + lm.neighborInterfaceAddresses.size() * IPV4_ADDRESS_SIZE);
+        i.WriteHtonU16(4 + lm.neighborInterfaceAddresses.size() * addressSize);
 
-        for (auto neigh_iter = lm.neighborInterfaceAddresses.begin();
-             neigh_iter != lm.neighborInterfaceAddresses.end();
-             neigh_iter++)
+        NS_ASSERT(!linkQuality ||
+                  lm.linkQualities.size() == lm.neighborInterfaceAddresses.size());
+        for (std::size_t n = 0; n < lm.neighborInterfaceAddresses.size(); n++)
         {
-            i.WriteHtonU32(neigh_iter->Get());
+            i.WriteHtonU32(lm.neighborInterfaceAddresses[n].Get());
+            if (linkQuality)
+            {
+                i.WriteU8(lm.linkQualities[n].lq);
+                i.WriteU8(lm.linkQualities[n].nlq);
+                i.WriteU16(0); // Reserved
+            }
         }
     }
 }
 
 uint32_t
-MessageHeader::Hello::Deserialize(Buffer::Iterator start, uint32_t messageSize)
+MessageHeader::Hello::Deserialize(Buffer::Iterator start, uint32_t messageSize, bool linkQuality)
 {
     Buffer::Iterator i = start;
+    uint32_t addressSize = IPV4_ADDRESS_SIZE + (linkQuality ? OLSR_LQ_SIZE : 0);
 
     NS_ASSERT(messageSize >= 4);
 
@@ -475,10 +513,18 @@ MessageHeader::Hello::Deserialize(Buffer::Iterator start, uint32_t messageSize)
         lm.linkCode = i.ReadU8();
         i.ReadU8(); // Reserved
         uint16_t lmSize = i.ReadNtohU16();
-        NS_ASSERT((lmSize - 4) % IPV4_ADDRESS_SIZE == 0);
-        for (int n = (lmSize - 4) / IPV4_ADDRESS_SIZE; n; --n)
+        NS_ASSERT((lmSize - 4) % addressSize == 0);
+        for (int n = (lmSize - 4) / addressSize; n; --n)
         {
             lm.neighborInterfaceAddresses.emplace_back(i.ReadNtohU32());
+            if (linkQuality)
+            {
+                LinkQuality quality;
+                quality.lq = i.ReadU8();
+                quality.nlq = i.ReadU8();
+                i.ReadU16(); // Reserved
+                lm.linkQualities.push_back(quality);
+            }
         }
         helloSizeLeft -= lmSize;
         this->linkMessages.push_back(lm);
@@ -490,9 +536,18 @@ MessageHeader::Hello::Deserialize(Buffer::Iterator start, uint32_t messageSize)
 // ---------------- OLSR TC Message -------------------------------
 
 uint32_t
-MessageHeader::Tc::GetSerializedSize() const
+MessageHeader::Tc::GetSerializedSize(MessageType type) const
 {
-    return 4 + this->neighborAddresses.size() * IPV4_ADDRESS_SIZE;
+    switch (type)
+    {
+    case LQ_TC_MESSAGE:
+        return 4 + this->neighborAddresses.size() * (IPV4_ADDRESS_SIZE + OLSR_LQ_SIZE);
+    case DELTA_TC_MESSAGE:
+        return 8 + (this->removedAddresses.size() + this->neighborAddresses.size()) *
+                       IPV4_ADDRESS_SIZE;
+    default:
+        return 4 + this->neighborAddresses.size() * IPV4_ADDRESS_SIZE;
+    }
 }
 
 void
@@ -514,39 +569,108 @@ MessageHeader::Tc::Print(std::ostream& os) const
         os << iAddr;
     }
     os << "]";
+    if (!removedAddresses.empty())
+    {
+        os << " Base SeqNo: " << baseAnsn;
+        os << " Removed: [";
+        first = true;
+        for (const auto& iAddr : removedAddresses)
+        {
+            if (first)
+            {
+                first = false;
+            }
+            else
+            {
+                os << ", ";
+            }
+            os << iAddr;
+        }
+        os << "]";
+    }
 }
 
 void
-MessageHeader::Tc::Serialize(Buffer::Iterator start) const
+MessageHeader::Tc::Serialize(Buffer::Iterator start, MessageType type) const
 {
     Buffer::Iterator i = start;
 
     i.WriteHtonU16(this->ansn);
-    i.WriteHtonU16(0); // Reserved
+    if (type == DELTA_TC_MESSAGE)
+    {
+        i.WriteHtonU16(this->baseAnsn);
+        i.WriteHtonU16(this->removedAddresses.size());
+        i.WriteHtonU16(0); // Reserved
+        for (const auto& addr : this->removedAddresses)
+        {
+            i.WriteHtonU32(addr.Get());
+        }
+    }
+    else
+    {
+        i.WriteHtonU16(0); // Reserved
+    }
 
-    for (auto iter = this->neighborAddresses.begin(); iter != this->neighborAddresses.end(); iter++)
+    bool linkQuality = (type == LQ_TC_MESSAGE);
+    NS_ASSERT(!linkQuality || this->neighborQualities.size() == this->neighborAddresses.size());
+    for (std::size_t n = 0; n < this->neighborAddresses.size(); n++)
     {
-        i.WriteHtonU32(iter->Get());
+        i.WriteHtonU32(this->neighborAddresses[n].Get());
+        if (linkQuality)
+        {
+            i.WriteU8(this->neighborQualities[n].lq);
+            i.WriteU8(this->neighborQualities[n].nlq);
+            i.WriteU16(0); // Reserved
+        }
     }
 }
 
 uint32_t
-MessageHeader::Tc::Deserialize(Buffer::Iterator start, uint32_t messageSize)
+MessageHeader::Tc::Deserialize(Buffer::Iterator start, uint32_t messageSize, MessageType type)
 {
     Buffer::Iterator i = start;
+    bool linkQuality = (type == LQ_TC_MESSAGE);
+    uint32_t addressSize = IPV4_ADDRESS_SIZE + (linkQuality ? OLSR_LQ_SIZE : 0);
 
     this->neighborAddresses.clear();
+    this->neighborQualities.clear();
+    this->removedAddresses.clear();
     NS_ASSERT(messageSize >= 4);
 
     this->ansn = i.ReadNtohU16();
-    i.ReadNtohU16(); // Reserved
+    uint32_t headerSize = 4;
+    if (type == DELTA_TC_MESSAGE)
+    {
+        NS_ASSERT(messageSize >= 8);
+        this->baseAnsn = i.ReadNtohU16();
+        uint16_t removedCount = i.ReadNtohU16();
+        i.ReadNtohU16(); // Reserved
+        headerSize = 8;
+        NS_ASSERT(messageSize - headerSize >= removedCount * IPV4_ADDRESS_SIZE);
+        for (uint16_t n = 0; n < removedCount; ++n)
+        {
+            this->removedAddresses.emplace_back(i.ReadNtohU32());
+        }
+        headerSize += removedCount * IPV4_ADDRESS_SIZE;
+    }
+    else
+    {
+        i.ReadNtohU16(); // Reserved
+    }
 
-    NS_ASSERT((messageSize - 4) % IPV4_ADDRESS_SIZE == 0);
-    int numAddresses = (messageSize - 4) / IPV4_ADDRESS_SIZE;
-    this->neighborAddresses.clear();
+    NS_ASSERT((messageSize - headerSize) % addressSize == 0);
+    int numAddresses = (messageSize - headerSize) / addressSize;
     for (int n = 0; n < numAddresses; ++n)
     {
         this->neighborAddresses.emplace_back(i.ReadNtohU32());
+        if (linkQuality)
+        {
+            LinkQuality quality;
+            quality.lq = i.ReadU8();
+            quality.nlq = i.ReadU8();
+            i.ReadU16(); // Reserved
+            this->neighborQualities.push_back(quality);
+        }
     }
 
     return messageSize;
@@ -609,5 +733,194 @@ MessageHeader::Hna::Deserialize(Buffer::Iterator start, uint32_t messageSize)
     return messageSize;
 }
 
+// ---------------- OLSR Message View -------------------------------
+
+MessageView::MessageView()
+    : m_data(nullptr),
+      m_messageType(MessageHeader::MessageType(0)),
+      m_vTime(0),
+      m_timeToLive(0),
+      m_hopCount(0),
+      m_messageSequenceNumber(0),
+      m_messageSize(0)
+{
+}
+
+MessageView::MessageView(const uint8_t* buffer, uint32_t size)
+    : m_data(buffer)
+{
+    NS_ASSERT(size >= OLSR_MSG_HEADER_SIZE);
+    m_messageType = MessageHeader::MessageType(buffer[0]);
+    NS_ASSERT((m_messageType >= MessageHeader::HELLO_MESSAGE &&
+               m_messageType <= MessageHeader::HNA_MESSAGE) ||
+              (m_messageType >= MessageHeader::LQ_HELLO_MESSAGE &&
+               m_messageType <= MessageHeader::DELTA_TC_MESSAGE));
+    m_vTime = buffer[1];
+    m_messageSize = ReadNtohU16(buffer + 2);
+    m_originatorAddress = Ipv4Address(ReadNtohU32(buffer + 4));
+    m_timeToLive = buffer[8];
+    m_hopCount = buffer[9];
+    m_messageSequenceNumber = ReadNtohU16(buffer + 10);
+    NS_ASSERT(m_messageSize >= OLSR_MSG_HEADER_SIZE && m_messageSize <= size);
+}
+
+void
+MessageView::CheckBody() const
+{
+#ifdef NS3_ASSERT_ENABLE
+    // Check the layout of the body, so that the ranges can be walked unchecked.
+    uint32_t bodySize = m_messageSize - OLSR_MSG_HEADER_SIZE;
+    uint32_t addressSize = GetAddressStride();
+    switch (m_messageType)
+    {
+    case MessageHeader::MID_MESSAGE:
+        NS_ASSERT(bodySize % IPV4_ADDRESS_SIZE == 0);
+        break;
+    case MessageHeader::HELLO_MESSAGE:
+    case MessageHeader::LQ_HELLO_MESSAGE: {
+        NS_ASSERT(bodySize >= 4);
+        uint32_t helloSizeLeft = bodySize - 4;
+        const uint8_t* lm = m_data + OLSR_MSG_HEADER_SIZE + 4;
+        while (helloSizeLeft)
+        {
+            NS_ASSERT(helloSizeLeft >= 4);
+            uint16_t lmSize = ReadNtohU16(lm + 2);
+            NS_ASSERT(lmSize >= 4 && lmSize <= helloSizeLeft);
+            NS_ASSERT((lmSize - 4) % addressSize == 0);
+            helloSizeLeft -= lmSize;
+            lm += lmSize;
+        }
+        break;
+    }
+    case MessageHeader::TC_MESSAGE:
+    case MessageHeader::LQ_TC_MESSAGE:
+        NS_ASSERT(bodySize >= 4);
+        NS_ASSERT((bodySize - 4) % addressSize == 0);
+        break;
+    case MessageHeader::DELTA_TC_MESSAGE:
+        NS_ASSERT(bodySize >= 8);
+        NS_ASSERT((bodySize - 8) % addressSize == 0);
+        NS_ASSERT(ReadNtohU16(m_data + OLSR_MSG_HEADER_SIZE + 4) <=
+                  (bodySize - 8) / addressSize);
+        break;
+    case MessageHeader::HNA_MESSAGE:
+        NS_ASSERT(bodySize % (IPV4_ADDRESS_SIZE * 2) == 0);
+        break;
+    }
+#endif // NS3_ASSERT_ENABLE
+}
+
+uint32_t
+MessageView::GetAddressStride() const
+{
+    if (m_messageType == MessageHeader::LQ_HELLO_MESSAGE ||
+        m_messageType == MessageHeader::LQ_TC_MESSAGE)
+    {
+        return IPV4_ADDRESS_SIZE + OLSR_LQ_SIZE;
+    }
+    return IPV4_ADDRESS_SIZE;
+}
+
+MessageView::Hello
+MessageView::GetHello() const
+{
+    NS_ASSERT(m_messageType == MessageHeader::HELLO_MESSAGE ||
+              m_messageType == MessageHeader::LQ_HELLO_MESSAGE);
+    CheckBody();
+    const uint8_t* body = m_data + OLSR_MSG_HEADER_SIZE;
+    uint32_t stride = GetAddressStride();
+    return Hello{body[2],
+                 Willingness(body[3]),
+                 Range<LinkMessageIterator>(LinkMessageIterator(body + 4, stride),
+                                            LinkMessageIterator(m_data + m_messageSize, stride))};
+}
+
+MessageView::Tc
+MessageView::GetTc() const
+{
+    NS_ASSERT(m_messageType == MessageHeader::TC_MESSAGE ||
+              m_messageType == MessageHeader::LQ_TC_MESSAGE ||
+              m_messageType == MessageHeader::DELTA_TC_MESSAGE);
+    CheckBody();
+    const uint8_t* body = m_data + OLSR_MSG_HEADER_SIZE;
+    const uint8_t* end = m_data + m_messageSize;
+    if (m_messageType == MessageHeader::DELTA_TC_MESSAGE)
+    {
+        const uint8_t* added = body + 8 + ReadNtohU16(body + 4) * IPV4_ADDRESS_SIZE;
+        return Tc{ReadNtohU16(body),
+                  AddressRange(added, end),
+                  ReadNtohU16(body + 2),
+                  AddressRange(body + 8, added)};
+    }
+    uint32_t stride = GetAddressStride();
+    return Tc{ReadNtohU16(body),
+              AddressRange(AddressIterator(body + 4, stride), AddressIterator(end, stride)),
+              0,
+              AddressRange(end, end)};
+}
+
+MessageView::Mid
+MessageView::GetMid() const
+{
+    NS_ASSERT(m_messageType == MessageHeader::MID_MESSAGE);
+    CheckBody();
+    return Mid{AddressRange(m_data + OLSR_MSG_HEADER_SIZE, m_data + m_messageSize)};
+}
+
+MessageView::Hna
+MessageView::GetHna() const
+{
+    NS_ASSERT(m_messageType == MessageHeader::HNA_MESSAGE);
+    CheckBody();
+    return Hna{AssociationRange(m_data + OLSR_MSG_HEADER_SIZE, m_data + m_messageSize)};
+}
+
+MessageHeader
+MessageView::GetMessageHeader() const
+{
+    Buffer buffer;
+    buffer.AddAtStart(m_messageSize);
+    buffer.Begin().Write(m_data, m_messageSize);
+    MessageHeader message;
+    message.Deserialize(buffer.Begin());
+    return message;
+}
+
+void
+MessageView::Print(std::ostream& os) const
+{
+    switch (m_messageType)
+    {
+    case MessageHeader::HELLO_MESSAGE:
+        os << "type: HELLO";
+        break;
+    case MessageHeader::TC_MESSAGE:
+        os << "type: TC";
+        break;
+    case MessageHeader::MID_MESSAGE:
+        os << "type: MID";
+        break;
+    case MessageHeader::HNA_MESSAGE:
+        os << "type: HNA";
+        break;
+    case MessageHeader::LQ_HELLO_MESSAGE:
+        os << "type: LQ_HELLO";
+        break;
+    case MessageHeader::LQ_TC_MESSAGE:
+        os << "type: LQ_TC";
+        break;
+    case MessageHeader::DELTA_TC_MESSAGE:
+        os << "type: DELTA_TC";
+        break;
+    }
+
+    os << " TTL: " << +m_timeToLive;
+    os << " Orig: " << m_originatorAddress;
+    os << " SeqNo: " << m_messageSequenceNumber;
+    os << " Validity: " << +m_vTime;
+    os << " Hop count: " << +m_hopCount;
+    os << " Size: " << m_messageSize;
+}
+
 } // namespace olsr
 } // namespace ns3
@@ -169,6 +169,19 @@ class MessageHeader : public Header
         TC_MESSAGE = 2,
         MID_MESSAGE = 3,
         HNA_MESSAGE = 4,
+        LQ_HELLO_MESSAGE = 201, //!< HELLO message with link qualities (olsrd numbering).
+        LQ_TC_MESSAGE = 202,    //!< TC message with link qualities (olsrd numbering).
+        DELTA_TC_MESSAGE = 203, //!< TC message advertising the changes since a previous ANSN.
+    };
+
+    /**
+     * Link quality advertised by the link quality extension (LQ_HELLO and LQ_TC
+     * messages), following the ETX metric. Both ratios are scaled to [0, 255].
+     */
+    struct LinkQuality
+    {
+        uint8_t lq;  //!< Ratio of the packets received through the link.
+        uint8_t nlq; //!< Ratio of the packets received by the neighbor through the link.
     };
 
     MessageHeader();
@@ -380,6 +393,14 @@ class MessageHeader : public Header
      +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
      :                                                               :
        (etc.)
+    \endverbatim
+     *
+     * In LQ_HELLO messages, each neighbor interface address is followed by:
+     *
+    \verbatim
+     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+     |      LQ       |      NLQ      |           Reserved            |
+     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
     \endverbatim
     */
     struct Hello
@@ -392,6 +413,8 @@ class MessageHeader : public Header
             uint8_t linkCode; //!< Link code
             std::vector<Ipv4Address>
                 neighborInterfaceAddresses; //!< Neighbor interface address container.
+            std::vector<LinkQuality>
+                linkQualities; //!< Qualities of the neighbor interfaces links (LQ_HELLO only).
         };
 
         uint8_t hTime; //!< HELLO emission interval (coded)
@@ -425,17 +448,19 @@ class MessageHeader : public Header
         void Print(std::ostream& os) const;
         /**
          * Returns the expected size of the header.
+         * \param linkQuality whether the message is a LQ_HELLO message.
          * \returns the expected size of the header.
          */
-        uint32_t GetSerializedSize() const;
+        uint32_t GetSerializedSize(bool linkQuality = false) const;
         /**
          * This method is used by Packet::AddHeader to
          * store a header into the byte buffer of a packet.
          *
          * \param start an iterator which points to where the header should
          *        be written.
+         * \param linkQuality whether the message is a LQ_HELLO message.
          */
-        void Serialize(Buffer::Iterator start) const;
+        void Serialize(Buffer::Iterator start, bool linkQuality = false) const;
         /**
          * This method is used by Packet::RemoveHeader to
          * re-create a header from the byte buffer of a packet.
@@ -443,9 +468,12 @@ class MessageHeader : public Header
          * \param start an iterator which points to where the header should
          *        read from.
          * \param messageSize the message size.
+         * \param linkQuality whether the message is a LQ_HELLO message.
          * \returns the number of bytes read.
          */
-        uint32_t Deserialize(Buffer::Iterator start, uint32_t messageSize);
+        uint32_t Deserialize(Buffer::Iterator start,
+                             uint32_t messageSize,
+                             bool linkQuality = false);
     };
 
     /**
@@ -465,11 +493,41 @@ class MessageHeader : public Header
       |                              ...                              |
       +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
      \endverbatim
+     *
+     * In LQ_TC messages, each advertised neighbor main address is followed by
+     * the LQ, NLQ and Reserved fields, as in LQ_HELLO messages.
+     *
+     * DELTA_TC messages only carry the changes of the advertised neighbor set
+     * since the message of sequence number Base ANSN: the removed addresses,
+     * followed by the added ones.
+     *
+     \verbatim
+       0                   1                   2                   3
+       0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+      +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+      |              ANSN             |           Base ANSN           |
+      +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+      |         Removed Count         |           Reserved            |
+      +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+      |                 Removed Neighbor Main Address                 |
+      +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+      |                              ...                              |
+      +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+      |                  Added Neighbor Main Address                  |
+      +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+      |                              ...                              |
+      +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+     \endverbatim
      */
     struct Tc
     {
         std::vector<Ipv4Address> neighborAddresses; //!< Neighbor address container.
-        uint16_t ansn;                              //!< Advertised Neighbor Sequence Number.
+        std::vector<LinkQuality>
+            neighborQualities; //!< Qualities of the advertised neighbors links (LQ_TC only).
+        std::vector<Ipv4Address>
+            removedAddresses; //!< Neighbors no longer advertised since baseAnsn (DELTA_TC only).
+        uint16_t ansn;        //!< Advertised Neighbor Sequence Number.
+        uint16_t baseAnsn{0}; //!< ANSN the changes are relative to (DELTA_TC only).
 
         /**
          * This method is used to print the content of a Tc message.
@@ -478,17 +536,19 @@ class MessageHeader : public Header
         void Print(std::ostream& os) const;
         /**
          * Returns the expected size of the header.
+         * \param type the message type (TC, LQ_TC or DELTA_TC).
          * \returns the expected size of the header.
          */
-        uint32_t GetSerializedSize() const;
+        uint32_t GetSerializedSize(MessageType type = TC_MESSAGE) const;
         /**
          * This method is used by Packet::AddHeader to
          * store a header into the byte buffer of a packet.
          *
          * \param start an iterator which points to where the header should
          *        be written.
+         * \param type the message type (TC, LQ_TC or DELTA_TC).
          */
-        void Serialize(Buffer::Iterator start) const;
+        void Serialize(Buffer::Iterator start, MessageType type = TC_MESSAGE) const;
         /**
          * This method is used by Packet::RemoveHeader to
          * re-create a header from the byte buffer of a packet.
@@ -496,9 +556,12 @@ class MessageHeader : public Header
          * \param start an iterator which points to where the header should
          *        read from.
          * \param messageSize the message size.
+         * \param type the message type (TC, LQ_TC or DELTA_TC).
          * \returns the number of bytes read.
          */
-        uint32_t Deserialize(Buffer::Iterator start, uint32_t messageSize);
+        uint32_t Deserialize(Buffer::Iterator start,
+                             uint32_t messageSize,
+                             MessageType type = TC_MESSAGE);
     };
 
     /**
@@ -595,7 +658,7 @@ class MessageHeader : public Header
     }
 
     /**
-     * Set the message type to HELLO and return the message content.
+     * Set the message type to HELLO, unless it is LQ_HELLO, and return the message content.
      * \returns The HELLO message.
      */
     Hello& GetHello()
@@ -606,13 +669,13 @@ class MessageHeader : public Header
         }
         else
         {
-            NS_ASSERT(m_messageType == HELLO_MESSAGE);
+            NS_ASSERT(m_messageType == HELLO_MESSAGE || m_messageType == LQ_HELLO_MESSAGE);
         }
         return m_message.hello;
     }
 
     /**
-     * Set the message type to TC and return the message content.
+     * Set the message type to TC, unless it is LQ_TC or DELTA_TC, and return the message content.
      * \returns The TC message.
      */
     Tc& GetTc()
@@ -623,7 +686,8 @@ class MessageHeader : public Header
         }
         else
         {
-            NS_ASSERT(m_messageType == TC_MESSAGE);
+            NS_ASSERT(m_messageType == TC_MESSAGE || m_messageType == LQ_TC_MESSAGE ||
+                      m_messageType == DELTA_TC_MESSAGE);
         }
         return m_message.tc;
     }
@@ -661,7 +725,7 @@ class MessageHeader : public Header
      */
     const Hello& GetHello() const
     {
-        NS_ASSERT(m_messageType == HELLO_MESSAGE);
+        NS_ASSERT(m_messageType == HELLO_MESSAGE || m_messageType == LQ_HELLO_MESSAGE);
         return m_message.hello;
     }
 
@@ -671,7 +735,8 @@ class MessageHeader : public Header
      */
     const Tc& GetTc() const
     {
-        NS_ASSERT(m_messageType == TC_MESSAGE);
+        NS_ASSERT(m_messageType == TC_MESSAGE || m_messageType == LQ_TC_MESSAGE ||
+                  m_messageType == DELTA_TC_MESSAGE);
         return m_message.tc;
     }
 
@@ -686,6 +751,554 @@ class MessageHeader : public Header
     }
 };
 
+/**
+ * \ingroup olsr
+ *
+ * Non-owning, read-only view of a serialized %OLSR message.
+ *
+ * A MessageView exposes the same fields as a MessageHeader, but decodes them
+ * directly from a contiguous byte buffer (e.g., the payload of a received
+ * packet). Address lists are presented as ranges over that buffer, so parsing
+ * a message does not allocate any memory.
+ *
+ * The buffer must outlive the view and all the ranges obtained from it.
+ */
+class MessageView
+{
+  public:
+    /**
+     * A pair of iterators over the content of a message, usable in range-based for loops.
+     * \tparam Iterator The iterator type.
+     */
+    template <typename Iterator>
+    class Range
+    {
+      public:
+        /**
+         * Constructor.
+         * \param begin First byte of the range.
+         * \param end One past the last byte of the range.
+         */
+        Range(const uint8_t* begin, const uint8_t* end)
+            : m_begin(begin),
+              m_end(end)
+        {
+        }
+
+        /**
+         * Constructor.
+         * \param begin Iterator to the first element.
+         * \param end Iterator past the last element.
+         */
+        Range(Iterator begin, Iterator end)
+            : m_begin(begin),
+              m_end(end)
+        {
+        }
+
+        /**
+         * \returns An iterator to the first element.
+         */
+        Iterator begin() const
+        {
+            return m_begin;
+        }
+
+        /**
+         * \returns An iterator past the last element.
+         */
+        Iterator end() const
+        {
+            return m_end;
+        }
+
+        /**
+         * \returns True if the range holds no element.
+         */
+        bool empty() const
+        {
+            return m_begin == m_end;
+        }
+
+      private:
+        Iterator m_begin; //!< Iterator to the first element.
+        Iterator m_end;   //!< Iterator past the last element.
+    };
+
+    /**
+     * Holds a decoded element so that iterators can provide operator->.
+     * \tparam T The element type.
+     */
+    template <typename T>
+    struct ArrowProxy
+    {
+        T value; //!< The decoded element.
+
+        /**
+         * \returns A pointer to the decoded element.
+         */
+        const T* operator->() const
+        {
+            return &value;
+        }
+    };
+
+    /**
+     * Iterator over a list of serialized IPv4 addresses.
+     *
+     * In LQ_HELLO and LQ_TC messages, each address is followed by its link quality.
+     */
+    class AddressIterator
+    {
+      public:
+        /**
+         * Constructor.
+         * \param pos Position of the address in the buffer.
+         * \param stride Distance between two consecutive addresses.
+         */
+        explicit AddressIterator(const uint8_t* pos, uint32_t stride = 4)
+            : m_pos(pos),
+              m_stride(stride)
+        {
+        }
+
+        /**
+         * \returns The link quality of the current address (LQ_HELLO and LQ_TC only).
+         */
+        MessageHeader::LinkQuality GetLinkQuality() const
+        {
+            NS_ASSERT(m_stride == 8);
+            return MessageHeader::LinkQuality{m_pos[4], m_pos[5]};
+        }
+
+        /**
+         * \returns The current address.
+         */
+        Ipv4Address operator*() const
+        {
+            return Ipv4Address(ReadNtohU32(m_pos));
+        }
+
+        /**
+         * \returns A proxy giving access to the members of the current element.
+         */
+        ArrowProxy<Ipv4Address> operator->() const
+        {
+            return ArrowProxy<Ipv4Address>{**this};
+        }
+
+        /**
+         * Advance to the next address.
+         * \returns A reference to this iterator.
+         */
+        AddressIterator& operator++()
+        {
+            m_pos += m_stride;
+            return *this;
+        }
+
+        /**
+         * Advance to the next element.
+         * \returns A copy of this iterator before it was advanced.
+         */
+        AddressIterator operator++(int)
+        {
+            AddressIterator previous = *this;
+            ++(*this);
+            return previous;
+        }
+
+        /**
+         * \param o The other iterator.
+         * \returns True if both iterators point to the same position.
+         */
+        bool operator==(const AddressIterator& o) const
+        {
+            return m_pos == o.m_pos;
+        }
+
+        /**
+         * \param o The other iterator.
+         * \returns True if the iterators point to different positions.
+         */
+        bool operator!=(const AddressIterator& o) const
+        {
+            return m_pos != o.m_pos;
+        }
+
+      private:
+        const uint8_t* m_pos; //!< Current position in the buffer.
+        uint32_t m_stride;    //!< Distance between two consecutive addresses.
+    };
+
+    /**
+     * Iterator over a list of serialized (network address, netmask) pairs.
+     */
+    class AssociationIterator
+    {
+      public:
+        /**
+         * Constructor.
+         * \param pos Position of the association in the buffer.
+         */
+        explicit AssociationIterator(const uint8_t* pos)
+            : m_pos(pos)
+        {
+        }
+
+        /**
+         * \returns The current association.
+         */
+        MessageHeader::Hna::Association operator*() const
+        {
+            return MessageHeader::Hna::Association{Ipv4Address(ReadNtohU32(m_pos)),
+                                                   Ipv4Mask(ReadNtohU32(m_pos + 4))};
+        }
+
+        /**
+         * \returns A proxy giving access to the members of the current element.
+         */
+        ArrowProxy<MessageHeader::Hna::Association> operator->() const
+        {
+            return ArrowProxy<MessageHeader::Hna::Association>{**this};
+        }
+
+        /**
+         * Advance to the next association.
+         * \returns A reference to this iterator.
+         */
+        AssociationIterator& operator++()
+        {
+            m_pos += 8;
+            return *this;
+        }
+
+        /**
+         * Advance to the next element.
+         * \returns A copy of this iterator before it was advanced.
+         */
+        AssociationIterator operator++(int)
+        {
+            AssociationIterator previous = *this;
+            ++(*this);
+            return previous;
+        }
+
+        /**
+         * \param o The other iterator.
+         * \returns True if both iterators point to the same position.
+         */
+        bool operator==(const AssociationIterator& o) const
+        {
+            return m_pos == o.m_pos;
+        }
+
+        /**
+         * \param o The other iterator.
+         * \returns True if the iterators point to different positions.
+         */
+        bool operator!=(const AssociationIterator& o) const
+        {
+            return m_pos != o.m_pos;
+        }
+
+      private:
+        const uint8_t* m_pos; //!< Current position in the buffer.
+    };
+
+    typedef Range<AddressIterator> AddressRange;         //!< Range of IPv4 addresses.
+    typedef Range<AssociationIterator> AssociationRange; //!< Range of HNA associations.
+
+    /**
+     * View of a HELLO link message.
+     */
+    struct LinkMessage
+    {
+        uint8_t linkCode;                        //!< Link code
+        AddressRange neighborInterfaceAddresses; //!< Neighbor interface addresses.
+    };
+
+    /**
+     * Iterator over the link messages of a HELLO message.
+     */
+    class LinkMessageIterator
+    {
+      public:
+        /**
+         * Constructor.
+         * \param pos Position of the link message in the buffer.
+         * \param addressStride Distance between two consecutive neighbor interface addresses.
+         */
+        explicit LinkMessageIterator(const uint8_t* pos, uint32_t addressStride = 4)
+            : m_pos(pos),
+              m_addressStride(addressStride)
+        {
+        }
+
+        /**
+         * \returns The current link message.
+         */
+        LinkMessage operator*() const
+        {
+            return LinkMessage{
+                m_pos[0],
+                AddressRange(AddressIterator(m_pos + 4, m_addressStride),
+                             AddressIterator(m_pos + ReadNtohU16(m_pos + 2), m_addressStride))};
+        }
+
+        /**
+         * \returns A proxy giving access to the members of the current element.
+         */
+        ArrowProxy<LinkMessage> operator->() const
+        {
+            return ArrowProxy<LinkMessage>{**this};
+        }
+
+        /**
+         * Advance to the next link message.
+         * \returns A reference to this iterator.
+         */
+        LinkMessageIterator& operator++()
+        {
+            m_pos += ReadNtohU16(m_pos + 2);
+            return *this;
+        }
+
+        /**
+         * Advance to the next element.
+         * \returns A copy of this iterator before it was advanced.
+         */
+        LinkMessageIterator operator++(int)
+        {
+            LinkMessageIterator previous = *this;
+            ++(*this);
+            return previous;
+        }
+
+        /**
+         * \param o The other iterator.
+         * \returns True if both iterators point to the same position.
+         */
+        bool operator==(const LinkMessageIterator& o) const
+        {
+            return m_pos == o.m_pos;
+        }
+
+        /**
+         * \param o The other iterator.
+         * \returns True if the iterators point to different positions.
+         */
+        bool operator!=(const LinkMessageIterator& o) const
+        {
+            return m_pos != o.m_pos;
+        }
+
+      private:
+        const uint8_t* m_pos;     //!< Current position in the buffer.
+        uint32_t m_addressStride; //!< Distance between two consecutive addresses.
+    };
+
+    /**
+     * View of a HELLO message.
+     */
+    struct Hello
+    {
+        uint8_t hTime;                           //!< HELLO emission interval (coded)
+        Willingness willingness;                 //!< The willingness of the node.
+        Range<LinkMessageIterator> linkMessages; //!< Link messages.
+
+        /**
+         * Get the HELLO emission interval.
+         * \return The HELLO emission interval.
+         */
+        Time GetHTime() const
+        {
+            return Seconds(EmfToSeconds(this->hTime));
+        }
+    };
+
+    /**
+     * View of a TC message.
+     */
+    struct Tc
+    {
+        uint16_t ansn;                  //!< Advertised Neighbor Sequence Number.
+        AddressRange neighborAddresses; //!< Advertised (or, in DELTA_TC, added) addresses.
+        uint16_t baseAnsn;              //!< ANSN the changes are relative to (DELTA_TC only).
+        AddressRange removedAddresses;  //!< Removed neighbor addresses (DELTA_TC only).
+    };
+
+    /**
+     * View of a MID message.
+     */
+    struct Mid
+    {
+        AddressRange interfaceAddresses; //!< Interface addresses.
+    };
+
+    /**
+     * View of a HNA message.
+     */
+    struct Hna
+    {
+        AssociationRange associations; //!< Associations.
+    };
+
+    MessageView();
+
+    /**
+     * Creates a view of the message starting at the beginning of the buffer.
+     *
+     * Only the fixed fields of the message are decoded and its type is checked,
+     * so that the messages which are not processed (e.g., duplicates) can be
+     * skipped by their size. The message body is checked and decoded on demand.
+     *
+     * \param buffer Start of the serialized message.
+     * \param size Number of bytes available in the buffer, at least the message size.
+     */
+    MessageView(const uint8_t* buffer, uint32_t size);
+
+    /**
+     * Get the message type.
+     * \return The message type.
+     */
+    MessageHeader::MessageType GetMessageType() const
+    {
+        return m_messageType;
+    }
+
+    /**
+     * Get the validity time.
+     * \return The validity time.
+     */
+    Time GetVTime() const
+    {
+        return Seconds(EmfToSeconds(m_vTime));
+    }
+
+    /**
+     * Get the originator address.
+     * \return The originator address.
+     */
+    Ipv4Address GetOriginatorAddress() const
+    {
+        return m_originatorAddress;
+    }
+
+    /**
+     * Get the time to live.
+     * \return The time to live.
+     */
+    uint8_t GetTimeToLive() const
+    {
+        return m_timeToLive;
+    }
+
+    /**
+     * Get the hop count.
+     * \return The hop count.
+     */
+    uint8_t GetHopCount() const
+    {
+        return m_hopCount;
+    }
+
+    /**
+     * Get the message sequence number.
+     * \return The message sequence number.
+     */
+    uint16_t GetMessageSequenceNumber() const
+    {
+        return m_messageSequenceNumber;
+    }
+
+    /**
+     * Get the size of the serialized message, as advertised in its Message Size field.
+     * \return The message size.
+     */
+    uint32_t GetSerializedSize() const
+    {
+        return m_messageSize;
+    }
+
+    /**
+     * Get the HELLO message.
+     * \returns The HELLO message.
+     */
+    Hello GetHello() const;
+
+    /**
+     * Get the TC message.
+     * \returns The TC message.
+     */
+    Tc GetTc() const;
+
+    /**
+     * Get the MID message.
+     * \returns The MID message.
+     */
+    Mid GetMid() const;
+
+    /**
+     * Get the HNA message.
+     * \returns The HNA message.
+     */
+    Hna GetHna() const;
+
+    /**
+     * Deserializes the viewed message into an owning MessageHeader.
+     * \returns The message.
+     */
+    MessageHeader GetMessageHeader() const;
+
+    /**
+     * Print the message fixed fields.
+     * \param os output stream
+     */
+    void Print(std::ostream& os) const;
+
+  private:
+    /**
+     * \returns The distance between two consecutive addresses in the message body.
+     */
+    uint32_t GetAddressStride() const;
+
+    /**
+     * Checks the layout of the message body against its type (debug builds only).
+     */
+    void CheckBody() const;
+
+    /**
+     * Reads a 16-bit integer in network byte order.
+     * \param pos Position in the buffer.
+     * \returns The integer.
+     */
+    static uint16_t ReadNtohU16(const uint8_t* pos)
+    {
+        return (uint16_t(pos[0]) << 8) | pos[1];
+    }
+
+    /**
+     * Reads a 32-bit integer in network byte order.
+     * \param pos Position in the buffer.
+     * \returns The integer.
+     */
+    static uint32_t ReadNtohU32(const uint8_t* pos)
+    {
+        return (uint32_t(pos[0]) << 24) | (uint32_t(pos[1]) << 16) | (uint32_t(pos[2]) << 8) |
+               pos[3];
+    }
+
+    const uint8_t* m_data;                    //!< Start of the serialized message.
+    MessageHeader::MessageType m_messageType; //!< The message type
+    uint8_t m_vTime;                          //!< The validity time.
+    Ipv4Address m_originatorAddress;          //!< The originator address.
+    uint8_t m_timeToLive;                     //!< The time to live.
+    uint8_t m_hopCount;                       //!< The hop count.
+    uint16_t m_messageSequenceNumber;         //!< The message sequence number.
+    uint16_t m_messageSize;                   //!< The message size.
+};
+
 inline std::ostream&
 operator<<(std::ostream& os, const PacketHeader& packet)
 {
@@ -700,6 +1313,13 @@ operator<<(std::ostream& os, const MessageHeader& message)
     return os;
 }
 
+inline std::ostream&
+operator<<(std::ostream& os, const MessageView& message)
+{
+    message.Print(os);
+    return os;
+}
+
 typedef std::vector<MessageHeader> MessageList;
 
 inline std::ostream&
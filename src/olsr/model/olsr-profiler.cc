@@ -0,0 +1,106 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "olsr-profiler.h"
+
+#include "ns3/assert.h"
+
+namespace ns3
+{
+namespace olsr
+{
+
+ProfileCounters&
+operator+=(ProfileCounters& a, const ProfileCounters& b)
+{
+    a.invocations += b.invocations;
+    a.wallClockTime += b.wallClockTime;
+    a.tuples += b.tuples;
+    a.tableSize += b.tableSize;
+    return a;
+}
+
+Profiler::Scope::Scope(Profiler& profiler, ProfilePhase phase)
+    : m_counters(profiler.m_counters[static_cast<std::size_t>(phase)]),
+      m_start(std::chrono::steady_clock::now())
+{
+}
+
+Profiler::Scope::~Scope()
+{
+    m_counters.invocations++;
+    m_counters.wallClockTime += std::chrono::steady_clock::now() - m_start;
+}
+
+const ProfileCounters&
+Profiler::GetCounters(ProfilePhase phase) const
+{
+    NS_ASSERT(phase < ProfilePhase::COUNT);
+    return m_counters[static_cast<std::size_t>(phase)];
+}
+
+void
+Profiler::Reset()
+{
+    m_counters.fill(ProfileCounters());
+}
+
+std::string
+Profiler::GetPhaseName(ProfilePhase phase)
+{
+    switch (phase)
+    {
+    case ProfilePhase::RECV_OLSR:
+        return "RecvOlsr";
+    case ProfilePhase::PROCESS_HELLO:
+        return "ProcessHello";
+    case ProfilePhase::PROCESS_TC:
+        return "ProcessTc";
+    case ProfilePhase::PROCESS_MID:
+        return "ProcessMid";
+    case ProfilePhase::PROCESS_HNA:
+        return "ProcessHna";
+    case ProfilePhase::MPR_COMPUTATION:
+        return "MprComputation";
+    case ProfilePhase::ROUTING_TABLE_COMPUTATION:
+        return "RoutingTableComputation";
+    case ProfilePhase::SEND_QUEUED_MESSAGES:
+        return "SendQueuedMessages";
+    default:
+        return "Unknown";
+    }
+}
+
+void
+Profiler::PrintCsvHeader(std::ostream& os)
+{
+    os << "Time,Node,Phase,Invocations,WallClockNs,Tuples,TableSize" << std::endl;
+}
+
+void
+Profiler::PrintCsv(std::ostream& os, Time now, uint32_t nodeId) const
+{
+    for (std::size_t i = 0; i < m_counters.size(); i++)
+    {
+        const ProfileCounters& counters = m_counters[i];
+        os << now.GetSeconds() << "," << nodeId << ","
+           << GetPhaseName(static_cast<ProfilePhase>(i)) << "," << counters.invocations << ","
+           << counters.wallClockTime.count() << "," << counters.tuples << ","
+           << counters.tableSize << std::endl;
+    }
+}
+
+} // namespace olsr
+} // namespace ns3
@@ -0,0 +1,193 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef OLSR_PROFILER_H
+#define OLSR_PROFILER_H
+
+#include "ns3/nstime.h"
+
+#include <array>
+#include <chrono>
+#include <ostream>
+#include <string>
+
+/**
+ * \ingroup olsr
+ * \file
+ * Profiling counters of the OLSR control plane.
+ *
+ * The counters are only updated when the module is built with the
+ * NS3_OLSR_PROFILING option. Otherwise the instrumentation macros expand to
+ * nothing, and all the counters remain zero.
+ */
+
+#ifdef NS3_OLSR_PROFILING
+/**
+ * \ingroup olsr
+ * Profiles the rest of the enclosing block as a phase.
+ * \param profiler The Profiler.
+ * \param phase The ProfilePhase.
+ */
+#define OLSR_PROFILE_SCOPE(profiler, phase)                                                        \
+    ns3::olsr::Profiler::Scope olsrProfileScope(profiler, phase)
+/**
+ * \ingroup olsr
+ * Adds tuples to the phase profiled by OLSR_PROFILE_SCOPE in the enclosing block.
+ * \param tuples The number of tuples touched.
+ */
+#define OLSR_PROFILE_TUPLES(tuples) olsrProfileScope.AddTuples(tuples)
+/**
+ * \ingroup olsr
+ * Records the table size of the phase profiled by OLSR_PROFILE_SCOPE in the enclosing block.
+ * \param size The size of the table.
+ */
+#define OLSR_PROFILE_TABLE_SIZE(size) olsrProfileScope.SetTableSize(size)
+#else
+#define OLSR_PROFILE_SCOPE(profiler, phase)
+#define OLSR_PROFILE_TUPLES(tuples)
+#define OLSR_PROFILE_TABLE_SIZE(size)
+#endif /* NS3_OLSR_PROFILING */
+
+namespace ns3
+{
+namespace olsr
+{
+
+/// \ingroup olsr
+/// Phases of the OLSR control plane measured by the Profiler.
+enum class ProfilePhase : uint8_t
+{
+    RECV_OLSR,                 //!< Reception of a packet, including the phases below.
+    PROCESS_HELLO,             //!< Processing of a HELLO message.
+    PROCESS_TC,                //!< Processing of a TC message.
+    PROCESS_MID,               //!< Processing of a MID message.
+    PROCESS_HNA,               //!< Processing of a HNA message.
+    MPR_COMPUTATION,           //!< MPR set computation.
+    ROUTING_TABLE_COMPUTATION, //!< Routing table computation.
+    SEND_QUEUED_MESSAGES,      //!< Emission of the queued messages.
+    COUNT,                     //!< Number of phases.
+};
+
+/// \ingroup olsr
+/// Counters of a profiled phase.
+struct ProfileCounters
+{
+    uint64_t invocations{0};                   //!< Number of invocations.
+    std::chrono::nanoseconds wallClockTime{0}; //!< Total wall-clock time (steady clock).
+    uint64_t tuples{0};                        //!< Number of tuples and message entries touched.
+    uint64_t tableSize{0}; //!< Size of the table handled by the last invocation.
+};
+
+/**
+ * Adds the counters of another node or phase.
+ * \param a The counters to update.
+ * \param b The counters to add.
+ * \returns The updated counters.
+ */
+ProfileCounters& operator+=(ProfileCounters& a, const ProfileCounters& b);
+
+/**
+ * \ingroup olsr
+ *
+ * Invocation counts, wall-clock time, tuples touched and table size of each
+ * phase of the OLSR control plane of a node.
+ *
+ * The phases are measured inclusively: the time of RECV_OLSR includes the
+ * processing of the messages and the computations it triggers.
+ */
+class Profiler
+{
+  public:
+    /**
+     * Measures a phase from construction to destruction.
+     */
+    class Scope
+    {
+      public:
+        /**
+         * Starts measuring a phase.
+         * \param profiler The profiler.
+         * \param phase The phase.
+         */
+        Scope(Profiler& profiler, ProfilePhase phase);
+
+        /// Stops measuring the phase.
+        ~Scope();
+
+        // Delete copy constructor and assignment operator to avoid misuse
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        /**
+         * Adds tuples touched by the phase.
+         * \param tuples The number of tuples.
+         */
+        void AddTuples(uint64_t tuples)
+        {
+            m_counters.tuples += tuples;
+        }
+
+        /**
+         * Records the size of the table handled by the phase.
+         * \param size The size of the table.
+         */
+        void SetTableSize(uint64_t size)
+        {
+            m_counters.tableSize = size;
+        }
+
+      private:
+        ProfileCounters& m_counters;                   //!< Counters of the phase.
+        std::chrono::steady_clock::time_point m_start; //!< Start of the measure.
+    };
+
+    /**
+     * \param phase The phase.
+     * \returns The counters of the phase.
+     */
+    const ProfileCounters& GetCounters(ProfilePhase phase) const;
+
+    /// Resets all the counters.
+    void Reset();
+
+    /**
+     * \param phase The phase.
+     * \returns The name of the phase, as written in the CSV output.
+     */
+    static std::string GetPhaseName(ProfilePhase phase);
+
+    /**
+     * Writes the header line of the CSV output.
+     * \param os The output stream.
+     */
+    static void PrintCsvHeader(std::ostream& os);
+
+    /**
+     * Writes one CSV line per phase.
+     * \param os The output stream.
+     * \param now The current simulation time.
+     * \param nodeId The ID of the node.
+     */
+    void PrintCsv(std::ostream& os, Time now, uint32_t nodeId) const;
+
+  private:
+    /// Counters of each phase.
+    std::array<ProfileCounters, static_cast<std::size_t>(ProfilePhase::COUNT)> m_counters;
+};
+
+} // namespace olsr
+} // namespace ns3
+
+#endif /* OLSR_PROFILER_H */
@@ -120,6 +120,13 @@ struct LinkTuple
     Time asymTime;
     /// Time at which this tuple expires and must be removed.
     Time time;
+    /// Ratio of the neighbor HELLO messages received on this link (link quality extension).
+    double linkQuality{0};
+    /// Ratio of our HELLO messages received by the neighbor, as it advertised it (link quality
+    /// extension).
+    double neighborLinkQuality{0};
+    /// Time at which the last HELLO message was received on this link (link quality extension).
+    Time lastHelloTime;
 };
 
 inline bool
@@ -185,6 +192,8 @@ struct TwoHopNeighborTuple
     Ipv4Address twoHopNeighborAddr;
     /// Time at which this tuple expires and must be removed.
     Time expirationTime; // previously called 'time_'
+    /// ETX cost of the link between the neighbor and the 2-hop neighbor (link quality extension).
+    double linkCost{1};
 };
 
 inline std::ostream&
@@ -256,6 +265,8 @@ struct TopologyTuple
     uint16_t sequenceNumber;
     /// Time at which this tuple expires and must be removed.
     Time expirationTime;
+    /// ETX cost of the link between the two nodes (link quality extension).
+    double linkCost{1};
 };
 
 inline bool
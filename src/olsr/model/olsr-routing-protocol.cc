@@ -36,10 +36,15 @@
 
 #include "olsr-repositories.h"
 
+#include "ns3/abort.h"
+#include "ns3/arp-cache.h"
 #include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "ns3/enum.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/ipv4-header.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-l3-protocol.h"
 #include "ns3/ipv4-packet-info-tag.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv4-routing-protocol.h"
@@ -48,12 +53,26 @@
 #include "ns3/names.h"
 #include "ns3/simulator.h"
 #include "ns3/socket-factory.h"
+#include "ns3/string.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/udp-socket-factory.h"
 #include "ns3/uinteger.h"
-
+#include "ns3/wifi-mac-header.h"
+#include "ns3/wifi-mac.h"
+#include "ns3/wifi-mpdu.h"
+#include "ns3/wifi-net-device.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <queue>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 
 /********** Useful macros **********/
 
@@ -72,14 +91,14 @@
 ///
 /// We only use this value in order to define OLSR_NEIGHB_HOLD_TIME.
 ///
-#define OLSR_REFRESH_INTERVAL m_helloInterval
+#define OLSR_REFRESH_INTERVAL GetHelloInterval()
 
 /********** Holding times **********/
 
 /// Neighbor holding time.
 #define OLSR_NEIGHB_HOLD_TIME Time(3 * OLSR_REFRESH_INTERVAL)
 /// Top holding time.
-#define OLSR_TOP_HOLD_TIME Time(3 * m_tcInterval)
+#define OLSR_TOP_HOLD_TIME Time(3 * GetTcInterval())
 /// Dup holding time.
 #define OLSR_DUP_HOLD_TIME Seconds(30)
 /// MID holding time.
@@ -90,7 +109,7 @@
 /********** Miscellaneous constants **********/
 
 /// Maximum allowed jitter.
-#define OLSR_MAXJITTER (m_helloInterval.GetSeconds() / 4)
+#define OLSR_MAXJITTER (GetHelloInterval().GetSeconds() / 4)
 /// Maximum allowed sequence number.
 #define OLSR_MAX_SEQ_NUM 65535
 /// Random number between [0-OLSR_MAXJITTER] used to jitter OLSR packet transmission.
@@ -188,6 +207,163 @@ operator<<(std::ostream& os, NeighborType neighborType)
     }
 }
 
+namespace
+{
+/**
+ * Scales a delivery ratio to the 8-bit representation of LQ_HELLO and LQ_TC messages.
+ * \param quality The delivery ratio, in [0, 1].
+ * \returns The scaled delivery ratio.
+ */
+uint8_t
+EncodeLinkQuality(double quality)
+{
+    return static_cast<uint8_t>(std::lround(std::min(std::max(quality, 0.0), 1.0) * 255));
+}
+
+/**
+ * Converts an 8-bit link quality of LQ_HELLO and LQ_TC messages to a delivery ratio.
+ * \param quality The scaled delivery ratio.
+ * \returns The delivery ratio, in [0, 1].
+ */
+double
+DecodeLinkQuality(uint8_t quality)
+{
+    return quality / 255.0;
+}
+
+/**
+ * Computes the ETX cost of a link, i.e., the expected number of transmissions
+ * needed to deliver a packet over it.
+ * \param lq Delivery ratio from the neighbor.
+ * \param nlq Delivery ratio to the neighbor.
+ * \returns The ETX cost, infinite if the link is unusable.
+ */
+double
+LinkCost(double lq, double nlq)
+{
+    if (lq <= 0 || nlq <= 0)
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+    return 1 / (lq * nlq);
+}
+
+/**
+ * Computes the ETX cost of a link advertised in a LQ_HELLO or LQ_TC message.
+ * \param quality The advertised link quality.
+ * \returns The ETX cost, infinite if the link is unusable.
+ */
+double
+LinkCost(const MessageHeader::LinkQuality& quality)
+{
+    return LinkCost(DecodeLinkQuality(quality.lq), DecodeLinkQuality(quality.nlq));
+}
+
+/**
+ * Computes the ETX cost of a link of the link set.
+ * \param tuple The link tuple.
+ * \returns The ETX cost, infinite if the link is unusable.
+ */
+double
+LinkCost(const LinkTuple& tuple)
+{
+    return LinkCost(tuple.linkQuality, tuple.neighborLinkQuality);
+}
+
+/**
+ * Computes a hashable key identifying a network association.
+ * \param association The association.
+ * \returns The key.
+ */
+uint64_t
+AssociationKey(const Association& association)
+{
+    return (static_cast<uint64_t>(association.networkAddr.Get()) << 32) |
+           association.netmask.Get();
+}
+
+/**
+ * Writes an unsigned integer to a checkpoint, in network byte order.
+ * \param os The checkpoint stream.
+ * \param value The value.
+ * \param size The size of the value, in bytes.
+ */
+void
+WriteCheckpointValue(std::ostream& os, uint64_t value, uint32_t size)
+{
+    for (uint32_t i = size; i > 0; i--)
+    {
+        os.put(static_cast<char>(value >> (8 * (i - 1))));
+    }
+}
+
+/**
+ * Reads an unsigned integer from a checkpoint, in network byte order.
+ * \param is The checkpoint stream.
+ * \param size The size of the value, in bytes.
+ * \returns The value.
+ */
+uint64_t
+ReadCheckpointValue(std::istream& is, uint32_t size)
+{
+    uint64_t value = 0;
+    for (uint32_t i = 0; i < size; i++)
+    {
+        value = (value << 8) | static_cast<uint8_t>(is.get());
+    }
+    return value;
+}
+
+/**
+ * Writes a time to a checkpoint, relative to the current time.
+ * \param os The checkpoint stream.
+ * \param time The time.
+ */
+void
+WriteCheckpointTime(std::ostream& os, Time time)
+{
+    WriteCheckpointValue(os, (time - Simulator::Now()).GetNanoSeconds(), 8);
+}
+
+/**
+ * Reads a time from a checkpoint, rebased on the current time.
+ * \param is The checkpoint stream.
+ * \returns The time.
+ */
+Time
+ReadCheckpointTime(std::istream& is)
+{
+    return Simulator::Now() + NanoSeconds(static_cast<int64_t>(ReadCheckpointValue(is, 8)));
+}
+
+/**
+ * Writes a double to a checkpoint.
+ * \param os The checkpoint stream.
+ * \param value The value.
+ */
+void
+WriteCheckpointDouble(std::ostream& os, double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    WriteCheckpointValue(os, bits, 8);
+}
+
+/**
+ * Reads a double from a checkpoint.
+ * \param is The checkpoint stream.
+ * \returns The value.
+ */
+double
+ReadCheckpointDouble(std::istream& is)
+{
+    uint64_t bits = ReadCheckpointValue(is, 8);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+} // unnamed namespace
+
 /********** OLSR class **********/
 
 NS_OBJECT_ENSURE_REGISTERED(RoutingProtocol);
@@ -237,6 +413,84 @@ RoutingProtocol::GetTypeId()
                                           "high",
                                           Willingness::ALWAYS,
                                           "always"))
+            .AddAttribute("LinkQuality",
+                          "Enable the link quality extension: the HELLO delivery ratio of each "
+                          "link is measured and advertised in LQ_HELLO and LQ_TC messages, and "
+                          "MPRs and routes are selected to minimize the ETX metric instead of "
+                          "the hop count.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RoutingProtocol::m_linkQuality),
+                          MakeBooleanChecker())
+            .AddAttribute("LinkQualityAging",
+                          "Weight of the last HELLO message in the link quality estimation "
+                          "(exponential moving average of the HELLO delivery ratio).",
+                          DoubleValue(0.1),
+                          MakeDoubleAccessor(&RoutingProtocol::m_linkQualityAging),
+                          MakeDoubleChecker<double>(0.0, 1.0))
+            .AddAttribute("LinkLayerFeedback",
+                          "Consider a neighbor lost as soon as the Wi-Fi MAC layer fails to "
+                          "deliver a frame to it, instead of waiting for its link to expire.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RoutingProtocol::m_linkLayerFeedback),
+                          MakeBooleanChecker())
+            .AddAttribute("Oracle",
+                          "Do not run the protocol: no control message is sent, and the routing "
+                          "table is only set by an oracle (see OlsrHelper::EnableOracle).",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RoutingProtocol::m_oracle),
+                          MakeBooleanChecker())
+            .AddAttribute("ForwardAggregation",
+                          "Hold the forwarded messages for up to ForwardAggregationWindow, drop "
+                          "the TC messages superseded by newer ones, and pack the queued "
+                          "messages in as few packets of the interface MTU as possible.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RoutingProtocol::m_forwardAggregation),
+                          MakeBooleanChecker())
+            .AddAttribute("ForwardAggregationWindow",
+                          "In forward aggregation mode, maximum time a forwarded message is held.",
+                          TimeValue(Seconds(0.5)),
+                          MakeTimeAccessor(&RoutingProtocol::m_forwardAggregationWindow),
+                          MakeTimeChecker())
+            .AddAttribute("DeltaTc",
+                          "Advertise in TC messages only the changes of the MPR selector set "
+                          "since the previous TC message. Ignored with link quality or fisheye "
+                          "scopes.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RoutingProtocol::m_deltaTc),
+                          MakeBooleanChecker())
+            .AddAttribute("DeltaTcRefresh",
+                          "In delta TC mode, number of TC messages between two full TC messages.",
+                          UintegerValue(4),
+                          MakeUintegerAccessor(&RoutingProtocol::m_deltaTcRefresh),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("AdaptiveIntervals",
+                          "Adapt the HELLO and TC intervals to the link churn: they shrink as "
+                          "soon as the link set changes, and grow while it remains stable.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RoutingProtocol::m_adaptiveIntervals),
+                          MakeBooleanChecker())
+            .AddAttribute("AdaptiveIntervalMinScale",
+                          "In adaptive interval mode, smallest factor applied to HelloInterval "
+                          "and TcInterval.",
+                          DoubleValue(0.5),
+                          MakeDoubleAccessor(&RoutingProtocol::m_minIntervalScale),
+                          MakeDoubleChecker<double>(0.01, 1.0))
+            .AddAttribute("AdaptiveIntervalMaxScale",
+                          "In adaptive interval mode, largest factor applied to HelloInterval "
+                          "and TcInterval.",
+                          DoubleValue(4.0),
+                          MakeDoubleAccessor(&RoutingProtocol::m_maxIntervalScale),
+                          MakeDoubleChecker<double>(1.0))
+            .AddAttribute("FisheyeScopes",
+                          "Fisheye TC dissemination scopes, as a space separated list of "
+                          "TTL:interval pairs (e.g., \"2:5s 8:10s 255:20s\"). Each TC message is "
+                          "sent with the largest TTL whose interval has elapsed, so that far "
+                          "nodes receive topology updates less often. Empty to always flood "
+                          "TC messages.",
+                          StringValue(""),
+                          MakeStringAccessor(&RoutingProtocol::SetFisheyeScopes,
+                                             &RoutingProtocol::GetFisheyeScopes),
+                          MakeStringChecker())
             .AddTraceSource("Rx",
                             "Receive OLSR packet.",
                             MakeTraceSourceAccessor(&RoutingProtocol::m_rxPacketTrace),
@@ -254,6 +508,9 @@ RoutingProtocol::GetTypeId()
 
 RoutingProtocol::RoutingProtocol()
     : m_routingTableAssociation(nullptr),
+      m_routingTableGeneration(0),
+      m_intervalScale(1.0),
+      m_linkChanges(0),
       m_ipv4(nullptr),
       m_helloTimer(Timer::CANCEL_ON_DESTROY),
       m_tcTimer(Timer::CANCEL_ON_DESTROY),
@@ -291,12 +548,15 @@ RoutingProtocol::SetIpv4(Ptr<Ipv4> ipv4)
     m_packetSequenceNumber = OLSR_MAX_SEQ_NUM;
     m_messageSequenceNumber = OLSR_MAX_SEQ_NUM;
     m_ansn = OLSR_MAX_SEQ_NUM;
+    m_lastTcAnsn = OLSR_MAX_SEQ_NUM;
+    m_tcSinceRefresh = 0;
 
     m_linkTupleTimerFirstTime = true;
 
     m_ipv4 = ipv4;
 
     m_hnaRoutingTable->SetIpv4(ipv4);
+    UpdateInterfaceIndexes();
 }
 
 void
@@ -304,6 +564,7 @@ RoutingProtocol::DoDispose()
 {
     m_ipv4 = nullptr;
     m_hnaRoutingTable = nullptr;
+    m_hnaRoutes.clear();
     m_routingTableAssociation = nullptr;
 
     if (m_recvSocket)
@@ -397,6 +658,16 @@ RoutingProtocol::DoInitialize()
     }
 
     NS_LOG_DEBUG("Starting OLSR on node " << m_mainAddress);
+    NS_ASSERT_MSG(m_minIntervalScale <= m_maxIntervalScale,
+                  "AdaptiveIntervalMinScale must not exceed AdaptiveIntervalMaxScale");
+
+    UpdateInterfaceIndexes();
+
+    if (m_oracle)
+    {
+        NS_LOG_DEBUG("OLSR on node " << m_mainAddress << " started in oracle mode");
+        return;
+    }
 
     Ipv4Address loopback("127.0.0.1");
 
@@ -455,6 +726,15 @@ RoutingProtocol::DoInitialize()
         socket->SetRecvPktInfo(true);
         m_sendSockets[socket] = m_ipv4->GetAddress(i, 0);
 
+        // Use the layer 2 feedback of this interface if possible
+        Ptr<WifiNetDevice> wifi = m_ipv4->GetNetDevice(i)->GetObject<WifiNetDevice>();
+        if (m_linkLayerFeedback && wifi && wifi->GetMac())
+        {
+            wifi->GetMac()->TraceConnectWithoutContext(
+                "DroppedMpdu",
+                MakeCallback(&RoutingProtocol::NotifyTxError, this));
+        }
+
         canRunOlsr = true;
     }
 
@@ -486,6 +766,8 @@ RoutingProtocol::SetInterfaceExclusions(std::set<uint32_t> exceptions)
 void
 RoutingProtocol::RecvOlsr(Ptr<Socket> socket)
 {
+    OLSR_PROFILE_SCOPE(m_profiler, ProfilePhase::RECV_OLSR);
+
     Ptr<Packet> receivedPacket;
     Address sourceAddress;
     receivedPacket = socket->RecvFrom(sourceAddress);
@@ -496,9 +778,17 @@ RoutingProtocol::RecvOlsr(Ptr<Socket> socket)
         NS_ABORT_MSG("No incoming interface on OLSR message, aborting.");
     }
     uint32_t incomingIf = interfaceInfo.GetRecvIf();
-    Ptr<Node> node = this->GetObject<Node>();
-    Ptr<NetDevice> dev = node->GetDevice(incomingIf);
-    uint32_t recvInterfaceIndex = m_ipv4->GetInterfaceForDevice(dev);
+    auto recvInterface = m_interfaceForDevice.find(incomingIf);
+    uint32_t recvInterfaceIndex;
+    if (recvInterface != m_interfaceForDevice.end())
+    {
+        recvInterfaceIndex = recvInterface->second;
+    }
+    else
+    {
+        Ptr<NetDevice> dev = this->GetObject<Node>()->GetDevice(incomingIf);
+        recvInterfaceIndex = m_ipv4->GetInterfaceForDevice(dev);
+    }
 
     if (m_interfaceExclusions.find(recvInterfaceIndex) != m_interfaceExclusions.end())
     {
@@ -508,8 +798,7 @@ RoutingProtocol::RecvOlsr(Ptr<Socket> socket)
     InetSocketAddress inetSourceAddr = InetSocketAddress::ConvertFrom(sourceAddress);
     Ipv4Address senderIfaceAddr = inetSourceAddr.GetIpv4();
 
-    int32_t interfaceForAddress = m_ipv4->GetInterfaceForAddress(senderIfaceAddr);
-    if (interfaceForAddress != -1)
+    if (GetInterfaceForAddress(senderIfaceAddr) != -1)
     {
         NS_LOG_LOGIC("Ignoring a packet sent by myself.");
         return;
@@ -531,38 +820,47 @@ RoutingProtocol::RecvOlsr(Ptr<Socket> socket)
     NS_ASSERT(olsrPacketHeader.GetPacketLength() >= olsrPacketHeader.GetSerializedSize());
     uint32_t sizeLeft = olsrPacketHeader.GetPacketLength() - olsrPacketHeader.GetSerializedSize();
 
-    MessageList messages;
-
-    while (sizeLeft)
+    if (!m_rxPacketTrace.IsEmpty())
     {
-        MessageHeader messageHeader;
-        if (packet->RemoveHeader(messageHeader) == 0)
+        // Owning copies of the messages are only built for the trace sinks.
+        MessageList messages;
+        Ptr<Packet> tracedPacket = packet->Copy();
+        for (uint32_t tracedSizeLeft = sizeLeft; tracedSizeLeft;)
         {
-            NS_ASSERT(false);
+            MessageHeader messageHeader;
+            if (tracedPacket->RemoveHeader(messageHeader) == 0)
+            {
+                NS_ASSERT(false);
+            }
+            tracedSizeLeft -= messageHeader.GetSerializedSize();
+            messages.push_back(messageHeader);
         }
+        m_rxPacketTrace(olsrPacketHeader, messages);
+    }
 
-        sizeLeft -= messageHeader.GetSerializedSize();
+    // The messages are copied once into the receive buffer, and processed
+    // through views into it. Only the fixed header of each message is decoded
+    // up front: the body of the expired and duplicated messages is skipped.
+    m_rxBuffer.resize(sizeLeft);
+    packet->CopyData(m_rxBuffer.data(), sizeLeft);
+
+    for (uint32_t offset = 0; offset < sizeLeft;)
+    {
+        const MessageView messageHeader(m_rxBuffer.data() + offset, sizeLeft - offset);
+        offset += messageHeader.GetSerializedSize();
+        OLSR_PROFILE_TUPLES(1);
 
         NS_LOG_DEBUG("Olsr Msg received with type "
                      << std::dec << int(messageHeader.GetMessageType())
                      << " TTL=" << int(messageHeader.GetTimeToLive())
                      << " origAddr=" << messageHeader.GetOriginatorAddress());
-        messages.push_back(messageHeader);
-    }
 
-    m_rxPacketTrace(olsrPacketHeader, messages);
-
-    for (auto messageIter = messages.begin(); messageIter != messages.end(); messageIter++)
-    {
-        const MessageHeader& messageHeader = *messageIter;
         // If ttl is less than or equal to zero, or
         // the receiver is the same as the originator,
         // the message must be silently dropped
         if (messageHeader.GetTimeToLive() == 0 ||
             messageHeader.GetOriginatorAddress() == m_mainAddress)
         {
-            packet->RemoveAtStart(messageHeader.GetSerializedSize() -
-                                  messageHeader.GetSerializedSize());
             continue;
         }
 
@@ -588,6 +886,7 @@ RoutingProtocol::RecvOlsr(Ptr<Socket> socket)
             switch (messageHeader.GetMessageType())
             {
             case olsr::MessageHeader::HELLO_MESSAGE:
+            case olsr::MessageHeader::LQ_HELLO_MESSAGE:
                 NS_LOG_DEBUG(Simulator::Now().As(Time::S)
                              << " OLSR node " << m_mainAddress << " received HELLO message of size "
                              << messageHeader.GetSerializedSize());
@@ -595,12 +894,21 @@ RoutingProtocol::RecvOlsr(Ptr<Socket> socket)
                 break;
 
             case olsr::MessageHeader::TC_MESSAGE:
+            case olsr::MessageHeader::LQ_TC_MESSAGE:
                 NS_LOG_DEBUG(Simulator::Now().As(Time::S)
                              << " OLSR node " << m_mainAddress << " received TC message of size "
                              << messageHeader.GetSerializedSize());
                 ProcessTc(messageHeader, senderIfaceAddr);
                 break;
 
+            case olsr::MessageHeader::DELTA_TC_MESSAGE:
+                NS_LOG_DEBUG(Simulator::Now().As(Time::S)
+                             << " OLSR node " << m_mainAddress
+                             << " received DELTA_TC message of size "
+                             << messageHeader.GetSerializedSize());
+                ProcessDeltaTc(messageHeader, senderIfaceAddr);
+                break;
+
             case olsr::MessageHeader::MID_MESSAGE:
                 NS_LOG_DEBUG(Simulator::Now().As(Time::S)
                              << " OLSR node " << m_mainAddress << " received MID message of size "
@@ -640,7 +948,8 @@ RoutingProtocol::RecvOlsr(Ptr<Socket> socket)
             // HELLO messages are never forwarded.
             // TC and MID messages are forwarded using the default algorithm.
             // Remaining messages are also forwarded using the default algorithm.
-            if (messageHeader.GetMessageType() != olsr::MessageHeader::HELLO_MESSAGE)
+            if (messageHeader.GetMessageType() != olsr::MessageHeader::HELLO_MESSAGE &&
+                messageHeader.GetMessageType() != olsr::MessageHeader::LQ_HELLO_MESSAGE)
             {
                 ForwardDefault(messageHeader,
                                duplicated,
@@ -652,6 +961,7 @@ RoutingProtocol::RecvOlsr(Ptr<Socket> socket)
 
     // After processing all OLSR messages, we must recompute the routing table
     RoutingTableComputation();
+    OLSR_PROFILE_TABLE_SIZE(m_table.size());
 }
 
 ///
@@ -722,6 +1032,8 @@ void
 RoutingProtocol::MprComputation()
 {
     NS_LOG_FUNCTION(this);
+    OLSR_PROFILE_SCOPE(m_profiler, ProfilePhase::MPR_COMPUTATION);
+    OLSR_PROFILE_TUPLES(m_state.GetNeighbors().size() + m_state.GetTwoHopNeighbors().size());
 
     // MPR computation should be done for each interface. See section 8.3.1
     // (RFC 3626) for details.
@@ -810,6 +1122,38 @@ RoutingProtocol::MprComputation()
     }
 #endif // NS3_LOG_ENABLE
 
+    if (m_linkQuality)
+    {
+        // Link quality extension: each 2-hop neighbor is covered by the
+        // neighbor offering the cheapest path towards it, so that the best
+        // paths are advertised by the MPRs. This covers all of N2, hence
+        // steps 3 and 4 are skipped.
+        std::map<Ipv4Address, std::pair<double, Ipv4Address>> bestPaths;
+        for (auto twoHopNeigh = N2.begin(); twoHopNeigh != N2.end(); twoHopNeigh++)
+        {
+            const LinkTuple* link = FindBestLink(twoHopNeigh->neighborMainAddr);
+            if (link == nullptr)
+            {
+                continue;
+            }
+            double cost = LinkCost(*link) + twoHopNeigh->linkCost;
+            auto best = bestPaths.find(twoHopNeigh->twoHopNeighborAddr);
+            if (best == bestPaths.end() || cost < best->second.first)
+            {
+                bestPaths[twoHopNeigh->twoHopNeighborAddr] =
+                    std::make_pair(cost, twoHopNeigh->neighborMainAddr);
+            }
+        }
+        for (auto best = bestPaths.begin(); best != bestPaths.end(); best++)
+        {
+            NS_LOG_LOGIC("Neighbor " << best->second.second
+                                     << " offers the best path to 2-hop neigh. " << best->first
+                                     << " => select as MPR.");
+            mprSet.insert(best->second.second);
+        }
+        N2.clear();
+    }
+
     // 1. Start with an MPR set made of all members of N with
     // N_willingness equal to Willingness::ALWAYS
     for (auto neighbor = N.begin(); neighbor != N.end(); neighbor++)
@@ -996,6 +1340,7 @@ RoutingProtocol::MprComputation()
     }
 #endif // NS3_LOG_ENABLE
 
+    OLSR_PROFILE_TABLE_SIZE(mprSet.size());
     m_state.SetMprSet(mprSet);
 }
 
@@ -1017,12 +1362,163 @@ RoutingProtocol::GetMainAddress(Ipv4Address iface_addr) const
 void
 RoutingProtocol::RoutingTableComputation()
 {
+    OLSR_PROFILE_SCOPE(m_profiler, ProfilePhase::ROUTING_TABLE_COMPUTATION);
+    OLSR_PROFILE_TUPLES(m_state.GetLinks().size() + m_state.GetNeighbors().size() +
+                        m_state.GetTwoHopNeighbors().size() + m_state.GetTopologySet().size() +
+                        m_state.GetIfaceAssocSet().size() + m_state.GetAssociationSet().size());
     NS_LOG_DEBUG(Simulator::Now().As(Time::S)
                  << " : Node " << m_mainAddress << ": RoutingTableComputation begin...");
     //NS_LOG_INFO("너무 짜요!");
-    // 1. All the entries from the routing table are removed.
-    Clear();
+    // 1. All the entries from the routing table are removed. They are kept
+    // aside to find out whether the routing table changed.
+    std::map<Ipv4Address, RoutingTableEntry> previousTable;
+    previousTable.swap(m_table);
+
+    // 2. and 3. The routes to the neighbors, 2-hop neighbors and topology set
+    // destinations are added.
+    if (m_linkQuality)
+    {
+        LinkQualityRouteComputation();
+    }
+    else
+    {
+        HopCountRouteComputation();
+    }
+
+    // 4. For each entry in the multiple interface association base
+    // where there exists a routing entry such that:
+    // R_dest_addr == I_main_addr (of the multiple interface association entry)
+    // AND there is no routing entry such that:
+    // R_dest_addr == I_iface_addr
+    const IfaceAssocSet& ifaceAssocSet = m_state.GetIfaceAssocSet();
+    for (auto it = ifaceAssocSet.begin(); it != ifaceAssocSet.end(); it++)
+    {
+        const IfaceAssocTuple& tuple = *it;
+        RoutingTableEntry entry1;
+        RoutingTableEntry entry2;
+        bool have_entry1 = Lookup(tuple.mainAddr, entry1);
+        bool have_entry2 = Lookup(tuple.ifaceAddr, entry2);
+        if (have_entry1 && !have_entry2)
+        {
+            // then a route entry is created in the routing table with:
+            //       R_dest_addr  =  I_iface_addr (of the multiple interface
+            //                                     association entry)
+            //       R_next_addr  =  R_next_addr  (of the recorded route entry)
+            //       R_dist       =  R_dist       (of the recorded route entry)
+            //       R_iface_addr =  R_iface_addr (of the recorded route entry).
+            AddEntry(tuple.ifaceAddr, entry1.nextAddr, entry1.interface, entry1.distance);
+        }
+    }
+
+    HnaRouteComputation();
+
+    if (m_table != previousTable)
+    {
+        m_routingTableGeneration++;
+    }
+
+    NS_LOG_DEBUG("Node " << m_mainAddress << ": RoutingTableComputation end.");
+    OLSR_PROFILE_TABLE_SIZE(m_table.size());
+    m_routingTableChanged(GetSize());
+}
 
+void
+RoutingProtocol::HnaRouteComputation()
+{
+    // 5. For each tuple in the association set,
+    //    If there is no entry in the routing table with:
+    //        R_dest_addr     == A_network_addr/A_netmask
+    //   and if the announced network is not announced by the node itself,
+    //   then a new routing entry is created.
+    const AssociationSet& associationSet = m_state.GetAssociationSet();
+
+    std::unordered_set<uint64_t> localHnaAssociations;
+    for (const auto& localHnaAssoc : m_state.GetAssociations())
+    {
+        localHnaAssociations.insert(AssociationKey(localHnaAssoc));
+    }
+    NS_LOG_DEBUG("Nb local associations: " << localHnaAssociations.size());
+
+    // The shortest route to each announced network, by order of announcement.
+    std::vector<HnaRoute> hnaRoutes;
+    std::unordered_map<uint64_t, std::size_t> hnaRouteIndexes;
+    for (auto it = associationSet.begin(); it != associationSet.end(); it++)
+    {
+        const AssociationTuple& tuple = *it;
+        Association association{tuple.networkAddr, tuple.netmask};
+        uint64_t key = AssociationKey(association);
+
+        // Test if HNA associations received from other gateways
+        // are also announced by this node. In such a case, no route
+        // is created for this association tuple (go to the next one).
+        if (localHnaAssociations.find(key) != localHnaAssociations.end())
+        {
+            NS_LOG_DEBUG("HNA association received from another GW is part of local HNA "
+                         "associations: no route added for network "
+                         << tuple.networkAddr << "/" << tuple.netmask);
+            continue;
+        }
+
+        RoutingTableEntry gatewayEntry;
+        if (!Lookup(tuple.gatewayAddr, gatewayEntry))
+        {
+            continue;
+        }
+        gatewayEntry.destAddr = tuple.networkAddr;
+
+        auto index = hnaRouteIndexes.find(key);
+        if (index == hnaRouteIndexes.end())
+        {
+            hnaRouteIndexes[key] = hnaRoutes.size();
+            hnaRoutes.emplace_back(association, gatewayEntry);
+        }
+        else if (hnaRoutes[index->second].second.distance > gatewayEntry.distance)
+        {
+            hnaRoutes[index->second].second = gatewayEntry;
+        }
+    }
+
+    // Only the routes which changed are removed from and added to the HNA
+    // routing table. m_hnaRoutes mirrors its content, in the same order, and
+    // is compacted in one pass: the kept routes are moved down to the index
+    // they have in the routing table once the stale routes before them are removed.
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < m_hnaRoutes.size(); i++)
+    {
+        HnaRoute& route = m_hnaRoutes[i];
+        auto index = hnaRouteIndexes.find(AssociationKey(route.first));
+        if (index != hnaRouteIndexes.end() && hnaRoutes[index->second].second == route.second)
+        {
+            hnaRouteIndexes.erase(index);
+            if (kept != i)
+            {
+                m_hnaRoutes[kept] = std::move(route);
+            }
+            kept++;
+            continue;
+        }
+        NS_ASSERT(m_hnaRoutingTable->GetRoute(kept).GetDestNetwork() == route.first.networkAddr);
+        m_hnaRoutingTable->RemoveRoute(kept);
+    }
+    m_hnaRoutes.erase(m_hnaRoutes.begin() + kept, m_hnaRoutes.end());
+    for (const auto& route : hnaRoutes)
+    {
+        if (hnaRouteIndexes.find(AssociationKey(route.first)) == hnaRouteIndexes.end())
+        {
+            continue;
+        }
+        m_hnaRoutingTable->AddNetworkRouteTo(route.first.networkAddr,
+                                             route.first.netmask,
+                                             route.second.nextAddr,
+                                             route.second.interface,
+                                             route.second.distance);
+        m_hnaRoutes.push_back(route);
+    }
+}
+
+void
+RoutingProtocol::HopCountRouteComputation()
+{
     // 2. The new routing entries are added starting with the
     // symmetric neighbors (h=1) as the destination nodes.
     const NeighborSet& neighborSet = m_state.GetNeighbors();
@@ -1211,124 +1707,161 @@ RoutingProtocol::RoutingTableComputation()
             break;
         }
     }
+}
 
-    // 4. For each entry in the multiple interface association base
-    // where there exists a routing entry such that:
-    // R_dest_addr == I_main_addr (of the multiple interface association entry)
-    // AND there is no routing entry such that:
-    // R_dest_addr == I_iface_addr
-    const IfaceAssocSet& ifaceAssocSet = m_state.GetIfaceAssocSet();
-    for (auto it = ifaceAssocSet.begin(); it != ifaceAssocSet.end(); it++)
+void
+RoutingProtocol::LinkQualityRouteComputation()
+{
+    NS_LOG_FUNCTION(this);
+
+    /// Cheapest path found towards a node.
+    struct Path
     {
-        const IfaceAssocTuple& tuple = *it;
-        RoutingTableEntry entry1;
-        RoutingTableEntry entry2;
-        bool have_entry1 = Lookup(tuple.mainAddr, entry1);
-        bool have_entry2 = Lookup(tuple.ifaceAddr, entry2);
-        if (have_entry1 && !have_entry2)
+        double cost;           //!< ETX cost of the path.
+        uint32_t hops;         //!< Number of hops of the path.
+        Ipv4Address nextAddr;  //!< Interface address of the first hop.
+        Ipv4Address ifaceAddr; //!< Local interface address towards the first hop.
+    };
+
+    // The links advertised by the neighbors and in the topology set, by origin
+    std::map<Ipv4Address, std::vector<std::pair<Ipv4Address, double>>> edges;
+    for (auto it = m_state.GetTwoHopNeighbors().begin(); it != m_state.GetTwoHopNeighbors().end();
+         it++)
+    {
+        const NeighborTuple* neighbor = m_state.FindSymNeighborTuple(it->neighborMainAddr);
+        if (neighbor != nullptr && neighbor->willingness != Willingness::NEVER)
         {
-            // then a route entry is created in the routing table with:
-            //       R_dest_addr  =  I_iface_addr (of the multiple interface
-            //                                     association entry)
-            //       R_next_addr  =  R_next_addr  (of the recorded route entry)
-            //       R_dist       =  R_dist       (of the recorded route entry)
-            //       R_iface_addr =  R_iface_addr (of the recorded route entry).
-            AddEntry(tuple.ifaceAddr, entry1.nextAddr, entry1.interface, entry1.distance);
+            edges[it->neighborMainAddr].emplace_back(it->twoHopNeighborAddr, it->linkCost);
         }
     }
-
-    // 5. For each tuple in the association set,
-    //    If there is no entry in the routing table with:
-    //        R_dest_addr     == A_network_addr/A_netmask
-    //   and if the announced network is not announced by the node itself,
-    //   then a new routing entry is created.
-    const AssociationSet& associationSet = m_state.GetAssociationSet();
-
-    // Clear HNA routing table
-    for (uint32_t i = 0; i < m_hnaRoutingTable->GetNRoutes(); i++)
+    for (auto it = m_state.GetTopologySet().begin(); it != m_state.GetTopologySet().end(); it++)
     {
-        m_hnaRoutingTable->RemoveRoute(0);
+        edges[it->lastAddr].emplace_back(it->destAddr, it->linkCost);
     }
 
-    for (auto it = associationSet.begin(); it != associationSet.end(); it++)
+    // Dijkstra's algorithm, starting from the symmetric neighbors
+    std::map<Ipv4Address, Path> paths;
+    typedef std::pair<double, Ipv4Address> Candidate;
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+    for (auto it = m_state.GetNeighbors().begin(); it != m_state.GetNeighbors().end(); it++)
     {
-        const AssociationTuple& tuple = *it;
+        const LinkTuple* link = FindBestLink(it->neighborMainAddr);
+        if (it->status != NeighborTuple::STATUS_SYM || link == nullptr ||
+            std::isinf(LinkCost(*link)))
+        {
+            continue;
+        }
+        paths[it->neighborMainAddr] =
+            Path{LinkCost(*link), 1, link->neighborIfaceAddr, link->localIfaceAddr};
+        candidates.emplace(LinkCost(*link), it->neighborMainAddr);
+    }
 
-        // Test if HNA associations received from other gateways
-        // are also announced by this node. In such a case, no route
-        // is created for this association tuple (go to the next one).
-        bool goToNextAssociationTuple = false;
-        const Associations& localHnaAssociations = m_state.GetAssociations();
-        NS_LOG_DEBUG("Nb local associations: " << localHnaAssociations.size());
-        for (auto assocIterator = localHnaAssociations.begin();
-             assocIterator != localHnaAssociations.end();
-             assocIterator++)
-        {
-            const Association& localHnaAssoc = *assocIterator;
-            if (localHnaAssoc.networkAddr == tuple.networkAddr &&
-                localHnaAssoc.netmask == tuple.netmask)
-            {
-                NS_LOG_DEBUG("HNA association received from another GW is part of local HNA "
-                             "associations: no route added for network "
-                             << tuple.networkAddr << "/" << tuple.netmask);
-                goToNextAssociationTuple = true;
-            }
+    while (!candidates.empty())
+    {
+        Candidate candidate = candidates.top();
+        candidates.pop();
+        const Path path = paths[candidate.second];
+        if (candidate.first > path.cost)
+        {
+            continue; // already reached through a cheaper path
         }
-        if (goToNextAssociationTuple)
+        auto adjacent = edges.find(candidate.second);
+        if (adjacent == edges.end())
         {
             continue;
         }
-
-        RoutingTableEntry gatewayEntry;
-
-        bool gatewayEntryExists = Lookup(tuple.gatewayAddr, gatewayEntry);
-        bool addRoute = false;
-
-        uint32_t routeIndex = 0;
-
-        for (routeIndex = 0; routeIndex < m_hnaRoutingTable->GetNRoutes(); routeIndex++)
+        for (auto edge = adjacent->second.begin(); edge != adjacent->second.end(); edge++)
         {
-            Ipv4RoutingTableEntry route = m_hnaRoutingTable->GetRoute(routeIndex);
-            if (route.GetDestNetwork() == tuple.networkAddr &&
-                route.GetDestNetworkMask() == tuple.netmask)
+            double cost = path.cost + edge->second;
+            if (edge->first == m_mainAddress || std::isinf(cost))
             {
-                break;
+                continue;
+            }
+            auto known = paths.find(edge->first);
+            if (known == paths.end() || cost < known->second.cost)
+            {
+                paths[edge->first] = Path{cost, path.hops + 1, path.nextAddr, path.ifaceAddr};
+                candidates.emplace(cost, edge->first);
             }
         }
+    }
 
-        if (routeIndex == m_hnaRoutingTable->GetNRoutes())
-        {
-            addRoute = true;
-        }
-        else if (gatewayEntryExists &&
-                 m_hnaRoutingTable->GetMetric(routeIndex) > gatewayEntry.distance)
+    for (auto it = paths.begin(); it != paths.end(); it++)
+    {
+        NS_LOG_LOGIC("Route to " << it->first << " via " << it->second.nextAddr
+                                 << ", cost=" << it->second.cost);
+        AddEntry(it->first, it->second.nextAddr, it->second.ifaceAddr, it->second.hops);
+    }
+
+    // As in step 2, the interfaces of the symmetric neighbors are reached directly
+    for (auto link = m_state.GetLinks().begin(); link != m_state.GetLinks().end(); link++)
+    {
+        RoutingTableEntry entry;
+        if (link->time >= Simulator::Now() &&
+            m_state.FindSymNeighborTuple(GetMainAddress(link->neighborIfaceAddr)) != nullptr &&
+            !Lookup(link->neighborIfaceAddr, entry))
         {
-            m_hnaRoutingTable->RemoveRoute(routeIndex);
-            addRoute = true;
+            AddEntry(link->neighborIfaceAddr, link->neighborIfaceAddr, link->localIfaceAddr, 1);
         }
+    }
+}
+
+void
+RoutingProtocol::UpdateLinkQuality(LinkTuple& tuple, Time hTime)
+{
+    Time now = Simulator::Now();
+
+    // The neighbor sends a HELLO message every hTime: the ones that did not
+    // arrive since the last one are accounted as lost.
+    int64_t missed =
+        std::llround((now - tuple.lastHelloTime).GetSeconds() / hTime.GetSeconds()) - 1;
+    if (missed > 0)
+    {
+        tuple.linkQuality *= std::pow(1 - m_linkQualityAging, missed);
+    }
+    tuple.linkQuality = (1 - m_linkQualityAging) * tuple.linkQuality + m_linkQualityAging;
+    tuple.lastHelloTime = now;
+    NS_LOG_DEBUG("Link quality of " << tuple.neighborIfaceAddr << ": " << tuple.linkQuality
+                                    << " (" << missed << " HELLO messages missed)");
+}
 
-        if (addRoute && gatewayEntryExists)
+const LinkTuple*
+RoutingProtocol::FindBestLink(const Ipv4Address& neighborMainAddr) const
+{
+    Time now = Simulator::Now();
+    const LinkTuple* best = nullptr;
+    for (auto link = m_state.GetLinks().begin(); link != m_state.GetLinks().end(); link++)
+    {
+        if (link->time >= now && GetMainAddress(link->neighborIfaceAddr) == neighborMainAddr &&
+            (best == nullptr || LinkCost(*link) < LinkCost(*best)))
         {
-            m_hnaRoutingTable->AddNetworkRouteTo(tuple.networkAddr,
-                                                 tuple.netmask,
-                                                 gatewayEntry.nextAddr,
-                                                 gatewayEntry.interface,
-                                                 gatewayEntry.distance);
+            best = &(*link);
         }
     }
-
-    NS_LOG_DEBUG("Node " << m_mainAddress << ": RoutingTableComputation end.");
-    m_routingTableChanged(GetSize());
+    return best;
 }
 
 void
-RoutingProtocol::ProcessHello(const olsr::MessageHeader& msg,
+RoutingProtocol::ProcessHello(const olsr::MessageView& msg,
                               const Ipv4Address& receiverIface,
                               const Ipv4Address& senderIface)
 {
     NS_LOG_FUNCTION(msg << receiverIface << senderIface);
+    OLSR_PROFILE_SCOPE(m_profiler, ProfilePhase::PROCESS_HELLO);
+    OLSR_PROFILE_TABLE_SIZE(m_state.GetLinks().size());
 
-    const olsr::MessageHeader::Hello& hello = msg.GetHello();
+    const olsr::MessageView::Hello hello = msg.GetHello();
+
+#ifdef NS3_OLSR_PROFILING
+    for (const auto& linkMessage : hello.linkMessages)
+    {
+        const auto& addresses = linkMessage.neighborInterfaceAddresses;
+        for (auto address = addresses.begin(); address != addresses.end(); address++)
+        {
+            OLSR_PROFILE_TUPLES(1);
+        }
+    }
+#endif // NS3_OLSR_PROFILING
 
     LinkSensing(msg, hello, receiverIface, senderIface);
 
@@ -1375,9 +1908,11 @@ RoutingProtocol::ProcessHello(const olsr::MessageHeader& msg,
 }
 
 void
-RoutingProtocol::ProcessTc(const olsr::MessageHeader& msg, const Ipv4Address& senderIface)
+RoutingProtocol::ProcessTc(const olsr::MessageView& msg, const Ipv4Address& senderIface)
 {
-    const olsr::MessageHeader::Tc& tc = msg.GetTc();
+    OLSR_PROFILE_SCOPE(m_profiler, ProfilePhase::PROCESS_TC);
+    OLSR_PROFILE_TABLE_SIZE(m_state.GetTopologySet().size());
+    const olsr::MessageView::Tc tc = msg.GetTc();
     Time now = Simulator::Now();
 
     // 1. If the sender interface of this message is not in the symmetric
@@ -1410,7 +1945,13 @@ RoutingProtocol::ProcessTc(const olsr::MessageHeader& msg, const Ipv4Address& se
     // the TC message:
     for (auto i = tc.neighborAddresses.begin(); i != tc.neighborAddresses.end(); i++)
     {
+        OLSR_PROFILE_TUPLES(1);
         const Ipv4Address& addr = *i;
+        double linkCost = 1;
+        if (msg.GetMessageType() == olsr::MessageHeader::LQ_TC_MESSAGE)
+        {
+            linkCost = LinkCost(i.GetLinkQuality());
+        }
         // 4.1. If there exist some tuple in the topology set where:
         //      T_dest_addr == advertised neighbor main address, AND
         //      T_last_addr == originator address,
@@ -1421,6 +1962,7 @@ RoutingProtocol::ProcessTc(const olsr::MessageHeader& msg, const Ipv4Address& se
         if (topologyTuple != nullptr)
         {
             topologyTuple->expirationTime = now + msg.GetVTime();
+            topologyTuple->linkCost = linkCost;
         }
         else
         {
@@ -1435,6 +1977,7 @@ RoutingProtocol::ProcessTc(const olsr::MessageHeader& msg, const Ipv4Address& se
             topologyTuple.lastAddr = msg.GetOriginatorAddress();
             topologyTuple.sequenceNumber = tc.ansn;
             topologyTuple.expirationTime = now + msg.GetVTime();
+            topologyTuple.linkCost = linkCost;
             AddTopologyTuple(topologyTuple);
 
             // Schedules topology tuple deletion
@@ -1461,9 +2004,92 @@ RoutingProtocol::ProcessTc(const olsr::MessageHeader& msg, const Ipv4Address& se
 }
 
 void
-RoutingProtocol::ProcessMid(const olsr::MessageHeader& msg, const Ipv4Address& senderIface)
+RoutingProtocol::ProcessDeltaTc(const olsr::MessageView& msg, const Ipv4Address& senderIface)
+{
+    OLSR_PROFILE_SCOPE(m_profiler, ProfilePhase::PROCESS_TC);
+    OLSR_PROFILE_TABLE_SIZE(m_state.GetTopologySet().size());
+    const olsr::MessageView::Tc tc = msg.GetTc();
+    const Ipv4Address& originator = msg.GetOriginatorAddress();
+    Time now = Simulator::Now();
+
+    // As for TC messages, the message must come from a symmetric neighbor,
+    // and must not be older than the known topology of the originator.
+    if (m_state.FindSymLinkTuple(senderIface, now) == nullptr ||
+        m_state.FindNewerTopologyTuple(originator, tc.ansn) != nullptr)
+    {
+        return;
+    }
+
+    // The changes are relative to the topology advertised with the base ANSN.
+    bool known = false;
+    for (const auto& tuple : m_state.GetTopologySet())
+    {
+        if (tuple.lastAddr == originator)
+        {
+            if (tuple.sequenceNumber != tc.baseAnsn)
+            {
+                known = false;
+                break;
+            }
+            known = true;
+        }
+    }
+    if (!known)
+    {
+        NS_LOG_DEBUG("Node " << m_mainAddress << ": missed TC messages from " << originator
+                             << ", waiting for a full TC message.");
+        return;
+    }
+
+    for (const auto& addr : tc.removedAddresses)
+    {
+        OLSR_PROFILE_TUPLES(1);
+        TopologyTuple* topologyTuple = m_state.FindTopologyTuple(addr, originator);
+        if (topologyTuple != nullptr)
+        {
+            RemoveTopologyTuple(*topologyTuple);
+        }
+    }
+
+    // The remaining tuples are still advertised by the originator.
+    for (auto& tuple : m_state.GetTopologySet())
+    {
+        if (tuple.lastAddr == originator)
+        {
+            tuple.sequenceNumber = tc.ansn;
+            tuple.expirationTime = now + msg.GetVTime();
+        }
+    }
+
+    for (const auto& addr : tc.neighborAddresses)
+    {
+        OLSR_PROFILE_TUPLES(1);
+        if (m_state.FindTopologyTuple(addr, originator) != nullptr)
+        {
+            continue;
+        }
+        TopologyTuple topologyTuple;
+        topologyTuple.destAddr = addr;
+        topologyTuple.lastAddr = originator;
+        topologyTuple.sequenceNumber = tc.ansn;
+        topologyTuple.expirationTime = now + msg.GetVTime();
+        AddTopologyTuple(topologyTuple);
+
+        // Schedules topology tuple deletion
+        m_events.Track(Simulator::Schedule(DELAY(topologyTuple.expirationTime),
+                                           &RoutingProtocol::TopologyTupleTimerExpire,
+                                           this,
+                                           topologyTuple.destAddr,
+                                           topologyTuple.lastAddr));
+    }
+}
+
+void
+RoutingProtocol::ProcessMid(const olsr::MessageView& msg, const Ipv4Address& senderIface)
 {
-    const olsr::MessageHeader::Mid& mid = msg.GetMid();
+    OLSR_PROFILE_SCOPE(m_profiler, ProfilePhase::PROCESS_MID);
+    OLSR_PROFILE_TABLE_SIZE(m_state.GetIfaceAssocSet().size());
+    const olsr::MessageView::Mid mid = msg.GetMid();
     Time now = Simulator::Now();
 
     NS_LOG_DEBUG("Node " << m_mainAddress << " ProcessMid from " << senderIface);
@@ -1482,6 +2108,7 @@ RoutingProtocol::ProcessMid(const olsr::MessageHeader& msg, const Ipv4Address& s
     // 2. For each interface address listed in the MID message
     for (auto i = mid.interfaceAddresses.begin(); i != mid.interfaceAddresses.end(); i++)
     {
+        OLSR_PROFILE_TUPLES(1);
         bool updated = false;
         IfaceAssocSet& ifaceAssoc = m_state.GetIfaceAssocSetMutable();
         for (auto tuple = ifaceAssoc.begin(); tuple != ifaceAssoc.end(); tuple++)
@@ -1529,9 +2156,11 @@ RoutingProtocol::ProcessMid(const olsr::MessageHeader& msg, const Ipv4Address& s
 }
 
 void
-RoutingProtocol::ProcessHna(const olsr::MessageHeader& msg, const Ipv4Address& senderIface)
+RoutingProtocol::ProcessHna(const olsr::MessageView& msg, const Ipv4Address& senderIface)
 {
-    const olsr::MessageHeader::Hna& hna = msg.GetHna();
+    OLSR_PROFILE_SCOPE(m_profiler, ProfilePhase::PROCESS_HNA);
+    OLSR_PROFILE_TABLE_SIZE(m_state.GetAssociationSet().size());
+    const olsr::MessageView::Hna hna = msg.GetHna();
     Time now = Simulator::Now();
 
     // 1. If the sender interface of this message is not in the symmetric
@@ -1547,6 +2176,7 @@ RoutingProtocol::ProcessHna(const olsr::MessageHeader& msg, const Ipv4Address& s
 
     for (auto it = hna.associations.begin(); it != hna.associations.end(); it++)
     {
+        OLSR_PROFILE_TUPLES(1);
         AssociationTuple* tuple =
             m_state.FindAssociationTuple(msg.GetOriginatorAddress(), it->address, it->mask);
 
@@ -1586,7 +2216,7 @@ RoutingProtocol::ProcessHna(const olsr::MessageHeader& msg, const Ipv4Address& s
 }
 
 void
-RoutingProtocol::ForwardDefault(olsr::MessageHeader olsrMessage,
+RoutingProtocol::ForwardDefault(const olsr::MessageView& olsrMessage,
                                 DuplicateTuple* duplicated,
                                 const Ipv4Address& localIface,
                                 const Ipv4Address& senderAddress)
@@ -1623,11 +2253,23 @@ RoutingProtocol::ForwardDefault(olsr::MessageHeader olsrMessage,
             m_state.FindMprSelectorTuple(GetMainAddress(senderAddress));
         if (mprselTuple != nullptr)
         {
-            olsrMessage.SetTimeToLive(olsrMessage.GetTimeToLive() - 1);
-            olsrMessage.SetHopCount(olsrMessage.GetHopCount() + 1);
+            olsr::MessageHeader message = olsrMessage.GetMessageHeader();
+            message.SetTimeToLive(message.GetTimeToLive() - 1);
+            message.SetHopCount(message.GetHopCount() + 1);
             // We have to introduce a random delay to avoid
             // synchronization with neighbors.
-            QueueMessage(olsrMessage, JITTER);
+            if (m_forwardAggregation)
+            {
+                // Wait at least half the window, so that the messages flooded
+                // by other originators meanwhile go in the same packet.
+                double window = m_forwardAggregationWindow.GetSeconds();
+                Time delay = Seconds(m_uniformRandomVariable->GetValue(window / 2, window));
+                QueueMessage(message, delay);
+            }
+            else
+            {
+                QueueMessage(message, JITTER);
+            }
             retransmitted = true;
         }
     }
@@ -1683,10 +2325,11 @@ RoutingProtocol::SendPacket(Ptr<Packet> packet, const MessageList& containedMess
     // Trace it
     m_txPacketTrace(header, containedMessages);
 
-    // Send it
+    // Send it. All sockets share the same packet buffer: every socket but the
+    // last one gets a (copy-on-write) copy, the last one sends the original.
     for (auto i = m_sendSockets.begin(); i != m_sendSockets.end(); i++)
     {
-        Ptr<Packet> pkt = packet->Copy();
+        Ptr<Packet> pkt = (std::next(i) == m_sendSockets.end()) ? packet : packet->Copy();
         Ipv4Address bcast = i->second.GetLocal().GetSubnetDirectedBroadcast(i->second.GetMask());
         i->first->SendTo(pkt, 0, InetSocketAddress(bcast, OLSR_PORT_NUMBER));
     }
@@ -1695,37 +2338,146 @@ RoutingProtocol::SendPacket(Ptr<Packet> packet, const MessageList& containedMess
 void
 RoutingProtocol::SendQueuedMessages()
 {
-    Ptr<Packet> packet = Create<Packet>();
-    int numMessages = 0;
-
     NS_LOG_DEBUG("Olsr node " << m_mainAddress << ": SendQueuedMessages");
+    OLSR_PROFILE_SCOPE(m_profiler, ProfilePhase::SEND_QUEUED_MESSAGES);
+    OLSR_PROFILE_TUPLES(m_queuedMessages.size());
+    OLSR_PROFILE_TABLE_SIZE(m_queuedMessages.size());
 
-    MessageList msglist;
-
-    for (auto message = m_queuedMessages.begin(); message != m_queuedMessages.end(); message++)
+    if (m_forwardAggregation)
     {
-        Ptr<Packet> p = Create<Packet>();
-        p->AddHeader(*message);
-        packet->AddAtEnd(p);
-        msglist.push_back(*message);
-        if (++numMessages == OLSR_MAX_MSGS)
+        DropSupersededTcMessages();
+        for (const auto& messages : PackQueuedMessages(GetMaxMessagesSize()))
         {
-            SendPacket(packet, msglist);
-            msglist.clear();
-            // Reset variables for next packet
-            numMessages = 0;
-            packet = Create<Packet>();
+            SendPacket(SerializeMessages(messages.begin(), messages.end()), messages);
         }
+        m_queuedMessages.clear();
+        return;
     }
 
-    if (packet->GetSize())
+    auto first = m_queuedMessages.begin();
+    while (first != m_queuedMessages.end())
     {
-        SendPacket(packet, msglist);
+        // Select the messages that go into this packet.
+        int numMessages = 0;
+        auto last = first;
+        while (last != m_queuedMessages.end() && numMessages < OLSR_MAX_MSGS)
+        {
+            numMessages++;
+            last++;
+        }
+
+        Ptr<Packet> packet = SerializeMessages(first, last);
+        if (first == m_queuedMessages.begin() && last == m_queuedMessages.end())
+        {
+            SendPacket(packet, m_queuedMessages);
+        }
+        else
+        {
+            SendPacket(packet, MessageList(first, last));
+        }
+        first = last;
     }
 
     m_queuedMessages.clear();
 }
 
+Ptr<Packet>
+RoutingProtocol::SerializeMessages(MessageList::const_iterator first,
+                                   MessageList::const_iterator last)
+{
+    uint32_t size = 0;
+    for (auto message = first; message != last; message++)
+    {
+        size += message->GetSerializedSize();
+    }
+
+    // Serialize the messages one after the other into a single buffer of
+    // their total size, instead of growing the packet buffer with each header.
+    Buffer buffer;
+    buffer.AddAtStart(size);
+    Buffer::Iterator i = buffer.Begin();
+    for (auto message = first; message != last; message++)
+    {
+        message->Serialize(i);
+        i.Next(message->GetSerializedSize());
+    }
+    return Create<Packet>(buffer.PeekData(), size);
+}
+
+void
+RoutingProtocol::DropSupersededTcMessages()
+{
+    // Newest ANSN of the full TC messages of each originator.
+    std::map<Ipv4Address, uint16_t> newestAnsn;
+    for (const auto& message : m_queuedMessages)
+    {
+        if (message.GetMessageType() == olsr::MessageHeader::TC_MESSAGE ||
+            message.GetMessageType() == olsr::MessageHeader::LQ_TC_MESSAGE)
+        {
+            auto ansn = newestAnsn.insert({message.GetOriginatorAddress(), message.GetTc().ansn});
+            ansn.first->second = std::max(ansn.first->second, message.GetTc().ansn);
+        }
+    }
+
+    auto superseded = [&newestAnsn](const olsr::MessageHeader& message) {
+        if (message.GetMessageType() != olsr::MessageHeader::TC_MESSAGE &&
+            message.GetMessageType() != olsr::MessageHeader::LQ_TC_MESSAGE &&
+            message.GetMessageType() != olsr::MessageHeader::DELTA_TC_MESSAGE)
+        {
+            return false;
+        }
+        auto ansn = newestAnsn.find(message.GetOriginatorAddress());
+        return ansn != newestAnsn.end() && message.GetTc().ansn < ansn->second;
+    };
+    auto end = std::remove_if(m_queuedMessages.begin(), m_queuedMessages.end(), superseded);
+    NS_LOG_DEBUG("Node " << m_mainAddress << ": dropping " << (m_queuedMessages.end() - end)
+                         << " superseded TC messages");
+    m_queuedMessages.erase(end, m_queuedMessages.end());
+}
+
+std::vector<MessageList>
+RoutingProtocol::PackQueuedMessages(uint32_t maxSize) const
+{
+    std::vector<MessageList> packets;
+    std::vector<uint32_t> sizes;
+    for (const auto& message : m_queuedMessages)
+    {
+        uint32_t size = message.GetSerializedSize();
+        std::size_t i = 0;
+        while (i < packets.size() &&
+               (sizes[i] + size > maxSize || packets[i].size() >= OLSR_MAX_MSGS))
+        {
+            i++;
+        }
+        if (i == packets.size())
+        {
+            packets.emplace_back();
+            sizes.push_back(0);
+        }
+        packets[i].push_back(message);
+        sizes[i] += size;
+    }
+    return packets;
+}
+
+uint32_t
+RoutingProtocol::GetMaxMessagesSize() const
+{
+    // IPv4 and UDP headers, and OLSR packet header.
+    const uint32_t overhead = 20 + 8 + olsr::PacketHeader().GetSerializedSize();
+
+    uint32_t mtu = std::numeric_limits<uint16_t>::max();
+    for (const auto& socket : m_sendSockets)
+    {
+        int32_t interface = GetInterfaceForAddress(socket.second.GetLocal());
+        if (interface != -1)
+        {
+            mtu = std::min<uint32_t>(mtu, m_ipv4->GetMtu(interface));
+        }
+    }
+    return mtu > overhead ? mtu - overhead : 1;
+}
+
 void
 RoutingProtocol::SendHello()
 {
@@ -1739,9 +2491,13 @@ RoutingProtocol::SendHello()
     msg.SetTimeToLive(1);
     msg.SetHopCount(0);
     msg.SetMessageSequenceNumber(GetMessageSequenceNumber());
+    if (m_linkQuality)
+    {
+        msg.SetMessageType(olsr::MessageHeader::LQ_HELLO_MESSAGE);
+    }
     olsr::MessageHeader::Hello& hello = msg.GetHello();
 
-    hello.SetHTime(m_helloInterval);
+    hello.SetHTime(GetHelloInterval());
     hello.willingness = m_willingness;
 
     std::vector<olsr::MessageHeader::Hello::LinkMessage>& linkMessages = hello.linkMessages;
@@ -1829,6 +2585,16 @@ RoutingProtocol::SendHello()
                                                       interfaces.begin(),
                                                       interfaces.end());
 
+        if (m_linkQuality)
+        {
+            // All the interfaces of the neighbor are advertised with the quality of this link
+            olsr::MessageHeader::LinkQuality quality = {
+                EncodeLinkQuality(link_tuple->linkQuality),
+                EncodeLinkQuality(link_tuple->neighborLinkQuality)};
+            linkMessage.linkQualities.assign(linkMessage.neighborInterfaceAddresses.size(),
+                                             quality);
+        }
+
         linkMessages.push_back(linkMessage);
     }
     NS_LOG_DEBUG("OLSR HELLO message size: " << int(msg.GetSerializedSize()) << " (with "
@@ -1849,14 +2615,70 @@ RoutingProtocol::SendTc()
     msg.SetHopCount(0);
     msg.SetMessageSequenceNumber(GetMessageSequenceNumber());
 
+    if (!m_fisheyeScopes.empty())
+    {
+        // The nodes in a scope only hear from us every scope interval, so the
+        // advertised topology must remain valid at least that long.
+        const FisheyeScope& scope = NextFisheyeScope();
+        msg.SetTimeToLive(scope.ttl);
+        msg.SetVTime(std::max(OLSR_TOP_HOLD_TIME, 3 * scope.interval));
+        NS_LOG_DEBUG("Sending TC with fisheye scope TTL=" << +scope.ttl);
+    }
+
+    if (m_linkQuality)
+    {
+        msg.SetMessageType(olsr::MessageHeader::LQ_TC_MESSAGE);
+    }
     olsr::MessageHeader::Tc& tc = msg.GetTc();
     tc.ansn = m_ansn;
 
-    for (auto mprsel_tuple = m_state.GetMprSelectors().begin();
-         mprsel_tuple != m_state.GetMprSelectors().end();
-         mprsel_tuple++)
+    for (auto mprsel_tuple = m_state.GetMprSelectors().begin();
+         mprsel_tuple != m_state.GetMprSelectors().end();
+         mprsel_tuple++)
+    {
+        tc.neighborAddresses.push_back(mprsel_tuple->mainAddr);
+        if (m_linkQuality)
+        {
+            olsr::MessageHeader::LinkQuality quality = {0, 0};
+            const LinkTuple* link = FindBestLink(mprsel_tuple->mainAddr);
+            if (link != nullptr)
+            {
+                quality.lq = EncodeLinkQuality(link->linkQuality);
+                quality.nlq = EncodeLinkQuality(link->neighborLinkQuality);
+            }
+            tc.neighborQualities.push_back(quality);
+        }
+    }
+
+    // Link qualities change at every TC message, and the nodes of a fisheye
+    // scope do not hear every TC message: delta TC only applies without them.
+    if (m_deltaTc && !m_linkQuality && m_fisheyeScopes.empty())
     {
-        tc.neighborAddresses.push_back(mprsel_tuple->mainAddr);
+        std::vector<Ipv4Address> advertised = tc.neighborAddresses;
+        std::sort(advertised.begin(), advertised.end());
+        if (m_tcSinceRefresh > 0 && m_tcSinceRefresh < m_deltaTcRefresh)
+        {
+            msg.SetMessageType(olsr::MessageHeader::DELTA_TC_MESSAGE);
+            tc.baseAnsn = m_lastTcAnsn;
+            tc.neighborAddresses.clear();
+            std::set_difference(advertised.begin(),
+                                advertised.end(),
+                                m_lastTcNeighbors.begin(),
+                                m_lastTcNeighbors.end(),
+                                std::back_inserter(tc.neighborAddresses));
+            std::set_difference(m_lastTcNeighbors.begin(),
+                                m_lastTcNeighbors.end(),
+                                advertised.begin(),
+                                advertised.end(),
+                                std::back_inserter(tc.removedAddresses));
+            m_tcSinceRefresh++;
+        }
+        else
+        {
+            m_tcSinceRefresh = 1;
+        }
+        m_lastTcAnsn = m_ansn;
+        m_lastTcNeighbors = std::move(advertised);
     }
     QueueMessage(msg, JITTER);
 }
@@ -2025,8 +2847,8 @@ RoutingProtocol::UsesNonOlsrOutgoingInterface(const Ipv4RoutingTableEntry& route
 }
 
 void
-RoutingProtocol::LinkSensing(const olsr::MessageHeader& msg,
-                             const olsr::MessageHeader::Hello& hello,
+RoutingProtocol::LinkSensing(const olsr::MessageView& msg,
+                             const olsr::MessageView::Hello& hello,
                              const Ipv4Address& receiverIface,
                              const Ipv4Address& senderIface)
 {
@@ -2047,6 +2869,8 @@ RoutingProtocol::LinkSensing(const olsr::MessageHeader& msg,
         newLinkTuple.localIfaceAddr = receiverIface;
         newLinkTuple.symTime = now - Seconds(1);
         newLinkTuple.time = now + msg.GetVTime();
+        newLinkTuple.linkQuality = 1;
+        newLinkTuple.lastHelloTime = now;
         link_tuple = &m_state.InsertLinkTuple(newLinkTuple);
         created = true;
         NS_LOG_LOGIC("Existing link tuple did not exist => creating new one");
@@ -2055,6 +2879,10 @@ RoutingProtocol::LinkSensing(const olsr::MessageHeader& msg,
     {
         NS_LOG_LOGIC("Existing link tuple already exists => will update it");
         updated = true;
+        if (m_linkQuality)
+        {
+            UpdateLinkQuality(*link_tuple, hello.GetHTime());
+        }
     }
 
     link_tuple->asymTime = now + msg.GetVTime();
@@ -2083,6 +2911,12 @@ RoutingProtocol::LinkSensing(const olsr::MessageHeader& msg,
             NS_LOG_DEBUG("   -> Neighbor: " << *neighIfaceAddr);
             if (*neighIfaceAddr == receiverIface)
             {
+                if (msg.GetMessageType() == olsr::MessageHeader::LQ_HELLO_MESSAGE)
+                {
+                    // The neighbor tells how well it receives our HELLO messages
+                    link_tuple->neighborLinkQuality =
+                        DecodeLinkQuality(neighIfaceAddr.GetLinkQuality().lq);
+                }
                 if (linkType == LinkType::LOST_LINK)
                 {
                     NS_LOG_LOGIC("link is LOST => expiring it");
@@ -2133,8 +2967,8 @@ RoutingProtocol::LinkSensing(const olsr::MessageHeader& msg,
 }
 
 void
-RoutingProtocol::PopulateNeighborSet(const olsr::MessageHeader& msg,
-                                     const olsr::MessageHeader::Hello& hello)
+RoutingProtocol::PopulateNeighborSet(const olsr::MessageView& msg,
+                                     const olsr::MessageView::Hello& hello)
 {
     NeighborTuple* nb_tuple = m_state.FindNeighborTuple(msg.GetOriginatorAddress());
     if (nb_tuple != nullptr)
@@ -2144,8 +2978,8 @@ RoutingProtocol::PopulateNeighborSet(const olsr::MessageHeader& msg,
 }
 
 void
-RoutingProtocol::PopulateTwoHopNeighborSet(const olsr::MessageHeader& msg,
-                                           const olsr::MessageHeader::Hello& hello)
+RoutingProtocol::PopulateTwoHopNeighborSet(const olsr::MessageView& msg,
+                                           const olsr::MessageView::Hello& hello)
 {
     Time now = Simulator::Now();
 
@@ -2187,6 +3021,11 @@ RoutingProtocol::PopulateTwoHopNeighborSet(const olsr::MessageHeader& msg,
                 Ipv4Address nb2hop_addr = GetMainAddress(*nb2hop_addr_iter);
                 NS_LOG_DEBUG("Looking at 2-hop neighbor address from HELLO message: "
                              << *nb2hop_addr_iter << " (main address is " << nb2hop_addr << ")");
+                double linkCost = 1;
+                if (msg.GetMessageType() == olsr::MessageHeader::LQ_HELLO_MESSAGE)
+                {
+                    linkCost = LinkCost(nb2hop_addr_iter.GetLinkQuality());
+                }
                 if (neighborType == NeighborType::SYM_NEIGH ||
                     neighborType == NeighborType::MPR_NEIGH)
                 {
@@ -2210,6 +3049,7 @@ RoutingProtocol::PopulateTwoHopNeighborSet(const olsr::MessageHeader& msg,
                         new_nb2hop_tuple.neighborMainAddr = msg.GetOriginatorAddress();
                         new_nb2hop_tuple.twoHopNeighborAddr = nb2hop_addr;
                         new_nb2hop_tuple.expirationTime = now + msg.GetVTime();
+                        new_nb2hop_tuple.linkCost = linkCost;
                         AddTwoHopNeighborTuple(new_nb2hop_tuple);
                         // Schedules nb2hop tuple deletion
                         m_events.Track(Simulator::Schedule(DELAY(new_nb2hop_tuple.expirationTime),
@@ -2221,6 +3061,7 @@ RoutingProtocol::PopulateTwoHopNeighborSet(const olsr::MessageHeader& msg,
                     else
                     {
                         nb2hop_tuple->expirationTime = now + msg.GetVTime();
+                        nb2hop_tuple->linkCost = linkCost;
                     }
                 }
                 else if (neighborType == NeighborType::NOT_NEIGH)
@@ -2248,8 +3089,8 @@ RoutingProtocol::PopulateTwoHopNeighborSet(const olsr::MessageHeader& msg,
 }
 
 void
-RoutingProtocol::PopulateMprSelectorSet(const olsr::MessageHeader& msg,
-                                        const olsr::MessageHeader::Hello& hello)
+RoutingProtocol::PopulateMprSelectorSet(const olsr::MessageView& msg,
+                                        const olsr::MessageView::Hello& hello)
 {
     NS_LOG_FUNCTION(this);
 
@@ -2301,54 +3142,64 @@ RoutingProtocol::PopulateMprSelectorSet(const olsr::MessageHeader& msg,
                                                        << m_state.PrintMprSelectorSet());
 }
 
-#if 0
-///
-/// \brief Drops a given packet because it couldn't be delivered to the corresponding
-/// destination by the MAC layer. This may cause a neighbor loss, and appropriate
-/// actions are then taken.
-///
-/// \param p the packet which couldn't be delivered by the MAC layer.
-///
 void
-OLSR::mac_failed(Ptr<Packet> p)
+RoutingProtocol::NeighborLoss(const LinkTuple& tuple)
 {
-    double now = Simulator::Now ();
-    struct hdr_ip* ih = HDR_IP (p);
-    struct hdr_cmn* ch = HDR_CMN (p);
+    NS_LOG_DEBUG(Simulator::Now().As(Time::S) << ": OLSR Node " << m_mainAddress << " LinkTuple "
+                                              << tuple.neighborIfaceAddr << " -> neighbor loss.");
+    LinkTupleUpdated(tuple, Willingness::DEFAULT);
+    m_state.EraseTwoHopNeighborTuples(GetMainAddress(tuple.neighborIfaceAddr));
+    m_state.EraseMprSelectorTuples(GetMainAddress(tuple.neighborIfaceAddr));
 
-    debug("%f: Node %d MAC Layer detects a breakage on link to %d\n",
-          now,
-          OLSR::node_id (ra_addr ()),
-          OLSR::node_id (ch->next_hop ()));
+    MprComputation();
+    RoutingTableComputation();
+}
 
-    if ((uint32_t)ih->daddr () == IP_BROADCAST)
+void
+RoutingProtocol::NotifyTxError(WifiMacDropReason reason, Ptr<const WifiMpdu> mpdu)
+{
+    const WifiMacHeader& hdr = mpdu->GetHeader();
+    // Frames dropped for other reasons (e.g., a full queue) say nothing about the link.
+    if (reason != WIFI_MAC_DROP_REACHED_RETRY_LIMIT || !hdr.IsData() || hdr.GetAddr1().IsGroup())
     {
-        drop (p, DROP_RTR_MAC_CALLBACK);
         return;
     }
 
-    OLSR_link_tuple* link_tuple = state_.find_link_tuple(ch->next_hop());
-    if (link_tuple)
+    Ptr<Ipv4L3Protocol> l3 = m_ipv4->GetObject<Ipv4L3Protocol>();
+    for (uint32_t i = 0; i < l3->GetNInterfaces(); i++)
     {
-        link_tuple->lost_time() = now + OLSR_NEIGHB_HOLD_TIME;
-        link_tuple->time() = now + OLSR_NEIGHB_HOLD_TIME;
-        nb_loss(link_tuple);
+        Ptr<ArpCache> arpCache = l3->GetInterface(i)->GetArpCache();
+        if (!arpCache)
+        {
+            continue;
+        }
+        for (ArpCache::Entry* entry : arpCache->LookupInverse(hdr.GetAddr1()))
+        {
+            LinkLayerNeighborLoss(entry->GetIpv4Address());
+        }
     }
-    drop(p, DROP_RTR_MAC_CALLBACK);
 }
-#endif
 
 void
-RoutingProtocol::NeighborLoss(const LinkTuple& tuple)
+RoutingProtocol::LinkLayerNeighborLoss(const Ipv4Address& neighborIfaceAddr)
 {
-    NS_LOG_DEBUG(Simulator::Now().As(Time::S) << ": OLSR Node " << m_mainAddress << " LinkTuple "
-                                              << tuple.neighborIfaceAddr << " -> neighbor loss.");
-    LinkTupleUpdated(tuple, Willingness::DEFAULT);
-    m_state.EraseTwoHopNeighborTuples(GetMainAddress(tuple.neighborIfaceAddr));
-    m_state.EraseMprSelectorTuples(GetMainAddress(tuple.neighborIfaceAddr));
+    Time now = Simulator::Now();
+    LinkTuple* link_tuple = m_state.FindLinkTuple(neighborIfaceAddr);
+    if (link_tuple == nullptr || link_tuple->symTime < now)
+    {
+        return;
+    }
 
-    MprComputation();
-    RoutingTableComputation();
+    NS_LOG_DEBUG(now.As(Time::S) << ": OLSR Node " << m_mainAddress
+                                 << " MAC layer detects a breakage on link to "
+                                 << neighborIfaceAddr);
+
+    // Advertise the link as lost, and keep the tuple for a neighbor hold time
+    // so that the neighbors learn about it.
+    link_tuple->symTime = now - NanoSeconds(1);
+    link_tuple->asymTime = link_tuple->symTime;
+    link_tuple->time = now + OLSR_NEIGHB_HOLD_TIME;
+    NeighborLoss(*link_tuple);
 }
 
 void
@@ -2391,6 +3242,7 @@ RoutingProtocol::LinkTupleAdded(const LinkTuple& tuple, Willingness willingness)
     }
 
     AddNeighborTuple(nb_tuple);
+    LinkSetChanged();
 }
 
 void
@@ -2401,6 +3253,7 @@ RoutingProtocol::RemoveLinkTuple(const LinkTuple& tuple)
 
     m_state.EraseNeighborTuple(GetMainAddress(tuple.neighborIfaceAddr));
     m_state.EraseLinkTuple(tuple);
+    LinkSetChanged();
 }
 
 void
@@ -2615,8 +3468,9 @@ RoutingProtocol::GetMessageSequenceNumber()
 void
 RoutingProtocol::HelloTimerExpire()
 {
+    AdaptIntervals();
     SendHello();
-    m_helloTimer.Schedule(m_helloInterval);
+    m_helloTimer.Schedule(GetHelloInterval());
 }
 
 void
@@ -2629,8 +3483,379 @@ RoutingProtocol::TcTimerExpire()
     else
     {
         NS_LOG_DEBUG("Not sending any TC, no one selected me as MPR.");
+        // Our topology expires at the other nodes: the next TC must be a full one.
+        m_tcSinceRefresh = 0;
+    }
+    m_tcTimer.Schedule(GetTcInterval());
+}
+
+Time
+RoutingProtocol::GetHelloInterval() const
+{
+    if (!m_adaptiveIntervals)
+    {
+        return m_helloInterval;
+    }
+    return Seconds(m_helloInterval.GetSeconds() * m_intervalScale);
+}
+
+Time
+RoutingProtocol::GetTcInterval() const
+{
+    if (!m_adaptiveIntervals)
+    {
+        return m_tcInterval;
+    }
+    return Seconds(m_tcInterval.GetSeconds() * m_intervalScale);
+}
+
+void
+RoutingProtocol::LinkSetChanged()
+{
+    if (!m_adaptiveIntervals || m_linkChanges++ > 0)
+    {
+        return;
+    }
+
+    m_intervalScale = std::max(m_minIntervalScale, m_intervalScale / 2);
+    NS_LOG_DEBUG("Node " << m_mainAddress << ": link set changed, HELLO interval now "
+                         << GetHelloInterval().As(Time::S));
+
+    // Advertise the new links (or their loss) without waiting for the
+    // interval chosen while the link set was stable.
+    if (m_helloTimer.IsRunning() && m_helloTimer.GetDelayLeft() > GetHelloInterval())
+    {
+        m_helloTimer.Cancel();
+        m_helloTimer.Schedule(GetHelloInterval());
+    }
+    if (m_tcTimer.IsRunning() && m_tcTimer.GetDelayLeft() > GetTcInterval())
+    {
+        m_tcTimer.Cancel();
+        m_tcTimer.Schedule(GetTcInterval());
+    }
+}
+
+void
+RoutingProtocol::AdaptIntervals()
+{
+    if (!m_adaptiveIntervals)
+    {
+        return;
+    }
+
+    // The validity time advertised with the previous messages is three times
+    // their interval, so growing by 25% keeps our state alive at the neighbors.
+    if (m_linkChanges == 0)
+    {
+        m_intervalScale = std::min(m_maxIntervalScale, m_intervalScale * 1.25);
+    }
+    m_linkChanges = 0;
+}
+
+void
+RoutingProtocol::SaveCheckpoint(std::ostream& os) const
+{
+    NS_LOG_FUNCTION(this);
+
+    WriteCheckpointValue(os, m_ansn, 2);
+
+    const LinkSet& links = m_state.GetLinks();
+    WriteCheckpointValue(os, links.size(), 4);
+    for (const auto& tuple : links)
+    {
+        WriteCheckpointValue(os, tuple.localIfaceAddr.Get(), 4);
+        WriteCheckpointValue(os, tuple.neighborIfaceAddr.Get(), 4);
+        WriteCheckpointTime(os, tuple.symTime);
+        WriteCheckpointTime(os, tuple.asymTime);
+        WriteCheckpointTime(os, tuple.time);
+        WriteCheckpointDouble(os, tuple.linkQuality);
+        WriteCheckpointDouble(os, tuple.neighborLinkQuality);
+        WriteCheckpointTime(os, tuple.lastHelloTime);
+    }
+
+    const NeighborSet& neighbors = m_state.GetNeighbors();
+    WriteCheckpointValue(os, neighbors.size(), 4);
+    for (const auto& tuple : neighbors)
+    {
+        WriteCheckpointValue(os, tuple.neighborMainAddr.Get(), 4);
+        WriteCheckpointValue(os, tuple.status, 1);
+        WriteCheckpointValue(os, static_cast<uint8_t>(tuple.willingness), 1);
+    }
+
+    const TwoHopNeighborSet& twoHopNeighbors = m_state.GetTwoHopNeighbors();
+    WriteCheckpointValue(os, twoHopNeighbors.size(), 4);
+    for (const auto& tuple : twoHopNeighbors)
+    {
+        WriteCheckpointValue(os, tuple.neighborMainAddr.Get(), 4);
+        WriteCheckpointValue(os, tuple.twoHopNeighborAddr.Get(), 4);
+        WriteCheckpointTime(os, tuple.expirationTime);
+        WriteCheckpointDouble(os, tuple.linkCost);
+    }
+
+    const TopologySet& topology = m_state.GetTopologySet();
+    WriteCheckpointValue(os, topology.size(), 4);
+    for (const auto& tuple : topology)
+    {
+        WriteCheckpointValue(os, tuple.destAddr.Get(), 4);
+        WriteCheckpointValue(os, tuple.lastAddr.Get(), 4);
+        WriteCheckpointValue(os, tuple.sequenceNumber, 2);
+        WriteCheckpointTime(os, tuple.expirationTime);
+        WriteCheckpointDouble(os, tuple.linkCost);
+    }
+
+    MprSet mprSet = m_state.GetMprSet();
+    WriteCheckpointValue(os, mprSet.size(), 4);
+    for (const auto& addr : mprSet)
+    {
+        WriteCheckpointValue(os, addr.Get(), 4);
+    }
+
+    const MprSelectorSet& mprSelectors = m_state.GetMprSelectors();
+    WriteCheckpointValue(os, mprSelectors.size(), 4);
+    for (const auto& tuple : mprSelectors)
+    {
+        WriteCheckpointValue(os, tuple.mainAddr.Get(), 4);
+        WriteCheckpointTime(os, tuple.expirationTime);
+    }
+
+    // The associations of our own interfaces are created again when OLSR starts.
+    IfaceAssocSet ifaceAssocSet;
+    std::copy_if(m_state.GetIfaceAssocSet().begin(),
+                 m_state.GetIfaceAssocSet().end(),
+                 std::back_inserter(ifaceAssocSet),
+                 [this](const IfaceAssocTuple& tuple) { return tuple.mainAddr != m_mainAddress; });
+    WriteCheckpointValue(os, ifaceAssocSet.size(), 4);
+    for (const auto& tuple : ifaceAssocSet)
+    {
+        WriteCheckpointValue(os, tuple.ifaceAddr.Get(), 4);
+        WriteCheckpointValue(os, tuple.mainAddr.Get(), 4);
+        WriteCheckpointTime(os, tuple.time);
+    }
+
+    const AssociationSet& associationSet = m_state.GetAssociationSet();
+    WriteCheckpointValue(os, associationSet.size(), 4);
+    for (const auto& tuple : associationSet)
+    {
+        WriteCheckpointValue(os, tuple.gatewayAddr.Get(), 4);
+        WriteCheckpointValue(os, tuple.networkAddr.Get(), 4);
+        WriteCheckpointValue(os, tuple.netmask.Get(), 4);
+        WriteCheckpointTime(os, tuple.expirationTime);
+    }
+
+    WriteCheckpointValue(os, m_table.size(), 4);
+    for (const auto& entry : m_table)
+    {
+        WriteCheckpointValue(os, entry.second.destAddr.Get(), 4);
+        WriteCheckpointValue(os, entry.second.nextAddr.Get(), 4);
+        WriteCheckpointValue(os, entry.second.interface, 4);
+        WriteCheckpointValue(os, entry.second.distance, 4);
+    }
+}
+
+void
+RoutingProtocol::LoadCheckpoint(std::istream& is)
+{
+    NS_LOG_FUNCTION(this);
+
+    // The checkpoint replaces the learned state, and the expiry events of its
+    // tuples are cancelled with the collector which tracked them.
+    m_state.ClearLearnedState(m_mainAddress);
+    {
+        EventGarbageCollector events;
+        std::swap(events, m_events);
+    }
+
+    m_ansn = ReadCheckpointValue(is, 2);
+
+    for (uint32_t n = ReadCheckpointValue(is, 4); n > 0 && is; n--)
+    {
+        LinkTuple tuple;
+        tuple.localIfaceAddr = Ipv4Address(ReadCheckpointValue(is, 4));
+        tuple.neighborIfaceAddr = Ipv4Address(ReadCheckpointValue(is, 4));
+        tuple.symTime = ReadCheckpointTime(is);
+        tuple.asymTime = ReadCheckpointTime(is);
+        tuple.time = ReadCheckpointTime(is);
+        tuple.linkQuality = ReadCheckpointDouble(is);
+        tuple.neighborLinkQuality = ReadCheckpointDouble(is);
+        tuple.lastHelloTime = ReadCheckpointTime(is);
+        m_state.InsertLinkTuple(tuple);
+        m_events.Track(Simulator::Schedule(DELAY(std::min(tuple.time, tuple.symTime)),
+                                           &RoutingProtocol::LinkTupleTimerExpire,
+                                           this,
+                                           tuple.neighborIfaceAddr));
+    }
+
+    for (uint32_t n = ReadCheckpointValue(is, 4); n > 0 && is; n--)
+    {
+        NeighborTuple tuple;
+        tuple.neighborMainAddr = Ipv4Address(ReadCheckpointValue(is, 4));
+        tuple.status = NeighborTuple::Status(ReadCheckpointValue(is, 1));
+        tuple.willingness = Willingness(ReadCheckpointValue(is, 1));
+        m_state.InsertNeighborTuple(tuple);
+    }
+
+    for (uint32_t n = ReadCheckpointValue(is, 4); n > 0 && is; n--)
+    {
+        TwoHopNeighborTuple tuple;
+        tuple.neighborMainAddr = Ipv4Address(ReadCheckpointValue(is, 4));
+        tuple.twoHopNeighborAddr = Ipv4Address(ReadCheckpointValue(is, 4));
+        tuple.expirationTime = ReadCheckpointTime(is);
+        tuple.linkCost = ReadCheckpointDouble(is);
+        m_state.InsertTwoHopNeighborTuple(tuple);
+        m_events.Track(Simulator::Schedule(DELAY(tuple.expirationTime),
+                                           &RoutingProtocol::Nb2hopTupleTimerExpire,
+                                           this,
+                                           tuple.neighborMainAddr,
+                                           tuple.twoHopNeighborAddr));
+    }
+
+    for (uint32_t n = ReadCheckpointValue(is, 4); n > 0 && is; n--)
+    {
+        TopologyTuple tuple;
+        tuple.destAddr = Ipv4Address(ReadCheckpointValue(is, 4));
+        tuple.lastAddr = Ipv4Address(ReadCheckpointValue(is, 4));
+        tuple.sequenceNumber = ReadCheckpointValue(is, 2);
+        tuple.expirationTime = ReadCheckpointTime(is);
+        tuple.linkCost = ReadCheckpointDouble(is);
+        m_state.InsertTopologyTuple(tuple);
+        m_events.Track(Simulator::Schedule(DELAY(tuple.expirationTime),
+                                           &RoutingProtocol::TopologyTupleTimerExpire,
+                                           this,
+                                           tuple.destAddr,
+                                           tuple.lastAddr));
+    }
+
+    MprSet mprSet;
+    for (uint32_t n = ReadCheckpointValue(is, 4); n > 0 && is; n--)
+    {
+        mprSet.insert(Ipv4Address(ReadCheckpointValue(is, 4)));
+    }
+    m_state.SetMprSet(mprSet);
+
+    for (uint32_t n = ReadCheckpointValue(is, 4); n > 0 && is; n--)
+    {
+        MprSelectorTuple tuple;
+        tuple.mainAddr = Ipv4Address(ReadCheckpointValue(is, 4));
+        tuple.expirationTime = ReadCheckpointTime(is);
+        m_state.InsertMprSelectorTuple(tuple);
+        m_events.Track(Simulator::Schedule(DELAY(tuple.expirationTime),
+                                           &RoutingProtocol::MprSelTupleTimerExpire,
+                                           this,
+                                           tuple.mainAddr));
+    }
+
+    for (uint32_t n = ReadCheckpointValue(is, 4); n > 0 && is; n--)
+    {
+        IfaceAssocTuple tuple;
+        tuple.ifaceAddr = Ipv4Address(ReadCheckpointValue(is, 4));
+        tuple.mainAddr = Ipv4Address(ReadCheckpointValue(is, 4));
+        tuple.time = ReadCheckpointTime(is);
+        m_state.InsertIfaceAssocTuple(tuple);
+        m_events.Track(Simulator::Schedule(DELAY(tuple.time),
+                                           &RoutingProtocol::IfaceAssocTupleTimerExpire,
+                                           this,
+                                           tuple.ifaceAddr));
+    }
+
+    for (uint32_t n = ReadCheckpointValue(is, 4); n > 0 && is; n--)
+    {
+        AssociationTuple tuple;
+        tuple.gatewayAddr = Ipv4Address(ReadCheckpointValue(is, 4));
+        tuple.networkAddr = Ipv4Address(ReadCheckpointValue(is, 4));
+        tuple.netmask = Ipv4Mask(ReadCheckpointValue(is, 4));
+        tuple.expirationTime = ReadCheckpointTime(is);
+        m_state.InsertAssociationTuple(tuple);
+        m_events.Track(Simulator::Schedule(DELAY(tuple.expirationTime),
+                                           &RoutingProtocol::AssociationTupleTimerExpire,
+                                           this,
+                                           tuple.gatewayAddr,
+                                           tuple.networkAddr,
+                                           tuple.netmask));
+    }
+
+    m_table.clear();
+    for (uint32_t n = ReadCheckpointValue(is, 4); n > 0 && is; n--)
+    {
+        RoutingTableEntry entry;
+        entry.destAddr = Ipv4Address(ReadCheckpointValue(is, 4));
+        entry.nextAddr = Ipv4Address(ReadCheckpointValue(is, 4));
+        entry.interface = ReadCheckpointValue(is, 4);
+        entry.distance = ReadCheckpointValue(is, 4);
+        m_table[entry.destAddr] = entry;
+    }
+    NS_ABORT_MSG_IF(!is, "Truncated OLSR checkpoint");
+    HnaRouteComputation();
+    m_routingTableGeneration++;
+
+    NS_LOG_DEBUG("Node " << m_mainAddress << ": restored " << m_table.size()
+                         << " routes from checkpoint");
+    m_routingTableChanged(GetSize());
+}
+
+void
+RoutingProtocol::SetFisheyeScopes(std::string scopes)
+{
+    m_fisheyeScopes.clear();
+    std::istringstream iss(scopes);
+    std::string token;
+    while (iss >> token)
+    {
+        std::size_t colon = token.find(':');
+        NS_ABORT_MSG_IF(colon == std::string::npos,
+                        "Invalid fisheye scope \"" << token << "\", expected TTL:interval");
+        std::string ttlToken = token.substr(0, colon);
+        NS_ABORT_MSG_IF(ttlToken.empty() || ttlToken.size() > 3 ||
+                            ttlToken.find_first_not_of("0123456789") != std::string::npos,
+                        "Invalid fisheye scope TTL \"" << ttlToken << "\"");
+        uint32_t ttl = std::stoul(ttlToken);
+        Time interval(token.substr(colon + 1));
+        NS_ABORT_MSG_IF(ttl == 0 || ttl > 255, "Invalid fisheye scope TTL " << ttl);
+        NS_ABORT_MSG_IF(!interval.IsStrictlyPositive(),
+                        "Invalid fisheye scope interval " << interval);
+        m_fisheyeScopes.push_back(FisheyeScope{uint8_t(ttl), interval, Seconds(0)});
+    }
+    std::sort(m_fisheyeScopes.begin(),
+              m_fisheyeScopes.end(),
+              [](const FisheyeScope& a, const FisheyeScope& b) { return a.ttl < b.ttl; });
+}
+
+std::string
+RoutingProtocol::GetFisheyeScopes() const
+{
+    std::ostringstream oss;
+    for (auto scope = m_fisheyeScopes.begin(); scope != m_fisheyeScopes.end(); scope++)
+    {
+        if (scope != m_fisheyeScopes.begin())
+        {
+            oss << " ";
+        }
+        oss << +scope->ttl << ":" << scope->interval.GetSeconds() << "s";
+    }
+    return oss.str();
+}
+
+const RoutingProtocol::FisheyeScope&
+RoutingProtocol::NextFisheyeScope()
+{
+    NS_ASSERT(!m_fisheyeScopes.empty());
+    Time now = Simulator::Now();
+
+    // TC messages are sent every TcInterval, so a scope is considered due if
+    // its deadline falls before the next TC emission.
+    auto selected = m_fisheyeScopes.begin();
+    for (auto scope = m_fisheyeScopes.begin(); scope != m_fisheyeScopes.end(); scope++)
+    {
+        if (scope->nextDue <= now + GetTcInterval() / 2)
+        {
+            selected = scope;
+        }
+    }
+
+    for (auto scope = m_fisheyeScopes.begin(); scope != std::next(selected); scope++)
+    {
+        scope->nextDue = now + scope->interval;
     }
-    m_tcTimer.Schedule(m_tcInterval);
+    return *selected;
 }
 
 void
@@ -3077,21 +4302,60 @@ RoutingProtocol::RouteInput(Ptr<const Packet> p,
 void
 RoutingProtocol::NotifyInterfaceUp(uint32_t i)
 {
+    UpdateInterfaceIndexes();
 }
 
 void
 RoutingProtocol::NotifyInterfaceDown(uint32_t i)
 {
+    UpdateInterfaceIndexes();
 }
 
 void
 RoutingProtocol::NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress address)
 {
+    UpdateInterfaceIndexes();
 }
 
 void
 RoutingProtocol::NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress address)
 {
+    UpdateInterfaceIndexes();
+}
+
+void
+RoutingProtocol::UpdateInterfaceIndexes()
+{
+    m_interfaceForAddress.clear();
+    m_interfaceForDevice.clear();
+    if (!m_ipv4)
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < m_ipv4->GetNInterfaces(); i++)
+    {
+        Ptr<NetDevice> device = m_ipv4->GetNetDevice(i);
+        if (device)
+        {
+            m_interfaceForDevice[device->GetIfIndex()] = i;
+        }
+        for (uint32_t j = 0; j < m_ipv4->GetNAddresses(i); j++)
+        {
+            // As Ipv4::GetInterfaceForAddress, the first interface wins.
+            m_interfaceForAddress.insert(std::make_pair(m_ipv4->GetAddress(i, j).GetLocal(), i));
+        }
+    }
+}
+
+int32_t
+RoutingProtocol::GetInterfaceForAddress(const Ipv4Address& address) const
+{
+    auto it = m_interfaceForAddress.find(address);
+    if (it == m_interfaceForAddress.end())
+    {
+        return -1;
+    }
+    return it->second;
 }
 
 void
@@ -3124,17 +4388,11 @@ RoutingProtocol::AddEntry(const Ipv4Address& dest,
     NS_ASSERT(distance > 0);
     NS_ASSERT(m_ipv4);
 
-    RoutingTableEntry entry;
-    for (uint32_t i = 0; i < m_ipv4->GetNInterfaces(); i++)
+    int32_t interface = GetInterfaceForAddress(interfaceAddress);
+    if (interface != -1)
     {
-        for (uint32_t j = 0; j < m_ipv4->GetNAddresses(i); j++)
-        {
-            if (m_ipv4->GetAddress(i, j).GetLocal() == interfaceAddress)
-            {
-                AddEntry(dest, next, i, distance);
-                return;
-            }
-        }
+        AddEntry(dest, next, interface, distance);
+        return;
     }
     NS_ASSERT(false); // should not be reached
     AddEntry(dest, next, 0, distance);
@@ -3144,6 +4402,7 @@ std::vector<RoutingTableEntry>
 RoutingProtocol::GetRoutingTableEntries() const
 {
     std::vector<RoutingTableEntry> retval;
+    retval.reserve(m_table.size());
     for (auto iter = m_table.begin(); iter != m_table.end(); iter++)
     {
         retval.push_back(iter->second);
@@ -3151,7 +4410,63 @@ RoutingProtocol::GetRoutingTableEntries() const
     return retval;
 }
 
-MprSet
+void
+RoutingProtocol::SetRoutingTableEntries(const std::vector<RoutingTableEntry>& entries)
+{
+    NS_LOG_FUNCTION(this << entries.size());
+    std::map<Ipv4Address, RoutingTableEntry> table;
+    for (const auto& entry : entries)
+    {
+        table[entry.destAddr] = entry;
+    }
+    if (table != m_table)
+    {
+        m_table.swap(table);
+        m_routingTableGeneration++;
+    }
+    m_routingTableChanged(GetSize());
+}
+
+void
+RoutingProtocol::ForEachRoutingTableEntry(
+    const std::function<void(const RoutingTableEntry&)>& visitor) const
+{
+    for (const auto& entry : m_table)
+    {
+        visitor(entry.second);
+    }
+}
+
+const RoutingTableEntry*
+RoutingProtocol::FindRoutingTableEntry(const Ipv4Address& dest) const
+{
+    auto it = m_table.find(dest);
+    if (it == m_table.end())
+    {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+uint32_t
+RoutingProtocol::GetRoutingTableGeneration() const
+{
+    return m_routingTableGeneration;
+}
+
+const Profiler&
+RoutingProtocol::GetProfiler() const
+{
+    return m_profiler;
+}
+
+void
+RoutingProtocol::ResetProfiler()
+{
+    m_profiler.Reset();
+}
+
+const MprSet&
 RoutingProtocol::GetMprSet() const
 {
     return m_state.GetMprSet();
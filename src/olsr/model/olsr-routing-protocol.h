@@ -23,6 +23,7 @@
 #define OLSR_AGENT_IMPL_H
 
 #include "olsr-header.h"
+#include "olsr-profiler.h"
 #include "olsr-repositories.h"
 #include "olsr-state.h"
 
@@ -39,14 +40,51 @@
 #include "ns3/timer.h"
 #include "ns3/traced-callback.h"
 
+#include <functional>
 #include <map>
 #include <vector>
 
 /// Testcase for MPR computation mechanism
 class OlsrMprTestCase;
+/// Testcase for fisheye TC scoping
+class OlsrFisheyeTestCase;
+/// Testcase for the link quality MPR computation
+class OlsrLinkQualityMprTestCase;
+/// Testcase for the processing of DELTA_TC messages
+class OlsrDeltaTcTestCase;
+/// Testcase for the OLSR state checkpoints
+class OlsrCheckpointTestCase;
+/// Testcase for the routing table read API
+class OlsrRoutingTableAccessTestCase;
+/// Testcase for the adaptive HELLO and TC intervals
+class OlsrAdaptiveIntervalsTestCase;
+/// Testcase for the link layer feedback
+class OlsrLinkLayerFeedbackTestCase;
+/// Testcase for the filter of the Wi-Fi MAC transmission failures
+class OlsrTxErrorFilterTestCase;
+/// Testcase for the control plane profiler
+class OlsrProfilerTestCase;
+/// Testcase for the aggregation of forwarded messages
+class OlsrForwardAggregationTestCase;
+/// Testcase for the oracle routing mode
+class OlsrOracleTestCase;
+/// Testcase for the HNA routes
+class OlsrHnaRoutesTestCase;
+/// Testcase for the packets of the queued messages
+class OlsrQueuedMessagesTestCase;
+/// Testcase for the interface index cache
+class OlsrInterfaceIndexesTestCase;
+/// Testcase for the routes of the link quality extension
+class OlsrLinkQualityRoutesTestCase;
+/// Testcase for the link quality estimation
+class OlsrLinkQualityUpdateTestCase;
 
 namespace ns3
 {
+
+class WifiMpdu;
+enum WifiMacDropReason : uint8_t; // opaque enum declaration
+
 namespace olsr
 {
 
@@ -74,6 +112,19 @@ struct RoutingTableEntry
     }
 };
 
+/**
+ * Equality operator for RoutingTableEntry.
+ * \param a The first entry.
+ * \param b The second entry.
+ * \returns True if the entries are equal.
+ */
+inline bool
+operator==(const RoutingTableEntry& a, const RoutingTableEntry& b)
+{
+    return a.destAddr == b.destAddr && a.nextAddr == b.nextAddr && a.interface == b.interface &&
+           a.distance == b.distance;
+}
+
 class RoutingProtocol;
 
 ///
@@ -88,6 +139,22 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * Declared friend to enable unit tests.
      */
     friend class ::OlsrMprTestCase;
+    friend class ::OlsrFisheyeTestCase;
+    friend class ::OlsrLinkQualityMprTestCase;
+    friend class ::OlsrDeltaTcTestCase;
+    friend class ::OlsrCheckpointTestCase;
+    friend class ::OlsrRoutingTableAccessTestCase;
+    friend class ::OlsrAdaptiveIntervalsTestCase;
+    friend class ::OlsrLinkLayerFeedbackTestCase;
+    friend class ::OlsrTxErrorFilterTestCase;
+    friend class ::OlsrProfilerTestCase;
+    friend class ::OlsrForwardAggregationTestCase;
+    friend class ::OlsrOracleTestCase;
+    friend class ::OlsrHnaRoutesTestCase;
+    friend class ::OlsrQueuedMessagesTestCase;
+    friend class ::OlsrInterfaceIndexesTestCase;
+    friend class ::OlsrLinkQualityRoutesTestCase;
+    friend class ::OlsrLinkQualityUpdateTestCase;
 
     static const uint16_t OLSR_PORT_NUMBER; //!< port number (698)
 
@@ -120,11 +187,55 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      */
     std::vector<RoutingTableEntry> GetRoutingTableEntries() const;
 
+    /**
+     * Replaces the routing table with routes computed outside of the protocol,
+     * e.g., by the oracle of OlsrHelper::EnableOracle. Unless the Oracle
+     * attribute is set, the protocol overwrites them at the next routing table
+     * computation.
+     * \param entries The routing table entries, at most one per destination.
+     */
+    void SetRoutingTableEntries(const std::vector<RoutingTableEntry>& entries);
+
+    /**
+     * Calls a function on each routing table entry, without copying the table.
+     * \param visitor The function to call.
+     */
+    void ForEachRoutingTableEntry(
+        const std::function<void(const RoutingTableEntry&)>& visitor) const;
+
+    /**
+     * Looks up the route to a destination, without copying it.
+     * \param dest The destination address.
+     * \return The routing table entry (next hop, interface and distance), or a
+     * null pointer if there is no route. It is valid until the routing table changes.
+     */
+    const RoutingTableEntry* FindRoutingTableEntry(const Ipv4Address& dest) const;
+
+    /**
+     * Get the routing table generation. It changes each time the content of the
+     * routing table changes, so that the results of the lookups can be cached
+     * as long as it stays the same.
+     * \return The routing table generation.
+     */
+    uint32_t GetRoutingTableGeneration() const;
+
+    /**
+     * Get the control plane profiling counters. They remain zero unless the
+     * module is built with the NS3_OLSR_PROFILING option.
+     * \return The profiler of this node.
+     */
+    const Profiler& GetProfiler() const;
+
+    /**
+     * Reset the control plane profiling counters.
+     */
+    void ResetProfiler();
+
     /**
      * Gets the MPR set.
      * \return The MPR set.
      */
-    MprSet GetMprSet() const;
+    const MprSet& GetMprSet() const;
 
     /**
      * Gets the MPR selectors.
@@ -166,6 +277,30 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      */
     int64_t AssignStreams(int64_t stream);
 
+    /**
+     * \brief Writes the OLSR state (link, neighbor, 2-hop neighbor, topology,
+     * MPR, MPR selector, interface association and association sets) and the
+     * routing table to a compact binary checkpoint.
+     *
+     * Times are stored relative to the current simulation time, so that the
+     * checkpoint can be loaded at any time of another simulation.
+     *
+     * \param os The output stream.
+     */
+    void SaveCheckpoint(std::ostream& os) const;
+
+    /**
+     * \brief Restores the OLSR state and the routing table from a checkpoint
+     * written by SaveCheckpoint, rebasing the tuple timers on the current
+     * simulation time.
+     *
+     * This is meant to warm-start a simulation of the same topology, before it
+     * starts, so that routes are available without a convergence phase.
+     *
+     * \param is The input stream.
+     */
+    void LoadCheckpoint(std::istream& is);
+
     /**
      * TracedCallback signature for Packet transmit and receive events.
      *
@@ -251,11 +386,24 @@ class RoutingProtocol : public Ipv4RoutingProtocol
   private:
     friend class ZrpRoutingProtocol;
     std::map<Ipv4Address, RoutingTableEntry> m_table; //!< Data structure for the routing table.
+    uint32_t m_routingTableGeneration; //!< Incremented each time the routing table changes.
+
+    /// Interface index of each local address, refreshed on interface and address changes.
+    std::map<Ipv4Address, uint32_t> m_interfaceForAddress;
+    /// Interface index of each net device (by device index), refreshed with m_interfaceForAddress.
+    std::map<uint32_t, uint32_t> m_interfaceForDevice;
 
     Ptr<Ipv4StaticRouting> m_hnaRoutingTable; //!< Routing table for HNA routes
 
+    /// A route of the HNA routing table: the network, and the route to its gateway.
+    typedef std::pair<Association, RoutingTableEntry> HnaRoute;
+    /// Routes of m_hnaRoutingTable, in the same order, to update it incrementally.
+    std::vector<HnaRoute> m_hnaRoutes;
+
     EventGarbageCollector m_events; //!< Running events.
 
+    Profiler m_profiler; //!< Control plane profiling counters.
+
     uint16_t m_packetSequenceNumber;  //!< Packets sequence number counter.
     uint16_t m_messageSequenceNumber; //!< Messages sequence number counter.
     uint16_t m_ansn;                  //!< Advertised Neighbor Set sequence number.
@@ -266,6 +414,89 @@ class RoutingProtocol : public Ipv4RoutingProtocol
     Time m_hnaInterval;        //!< HNA messages' emission interval.
     Willingness m_willingness; //!< Willingness for forwarding packets on behalf of other nodes.
 
+    /// Scope of the TC messages in fisheye mode.
+    struct FisheyeScope
+    {
+        uint8_t ttl;   //!< TTL of the TC messages sent with this scope.
+        Time interval; //!< Emission interval of the TC messages sent with this scope.
+        Time nextDue;  //!< Time when a TC message must be sent again with this scope.
+    };
+
+    bool m_linkQuality;        //!< Whether the link quality extension (ETX metric) is enabled.
+    double m_linkQualityAging; //!< Weight of the last HELLO in the link quality estimation.
+
+    bool m_linkLayerFeedback; //!< Whether Wi-Fi MAC transmission failures cause neighbor losses.
+
+    bool m_oracle; //!< Whether the routing table is set by an oracle instead of the protocol.
+
+    bool m_forwardAggregation;       //!< Whether forwarded messages are aggregated.
+    Time m_forwardAggregationWindow; //!< Maximum time a forwarded message is held.
+
+    bool m_deltaTc;            //!< Whether TC messages only advertise the changes (DELTA_TC).
+    uint32_t m_deltaTcRefresh; //!< A full TC message is sent every m_deltaTcRefresh TC messages.
+    uint32_t m_tcSinceRefresh; //!< Number of TC messages sent since the last full one.
+    uint16_t m_lastTcAnsn;     //!< ANSN of the last TC message sent.
+    std::vector<Ipv4Address> m_lastTcNeighbors; //!< Sorted neighbors advertised in the last TC.
+
+    bool m_adaptiveIntervals;  //!< Whether the HELLO and TC intervals follow the link churn.
+    double m_minIntervalScale; //!< Lower bound of m_intervalScale.
+    double m_maxIntervalScale; //!< Upper bound of m_intervalScale.
+    double m_intervalScale;    //!< Current factor applied to the HELLO and TC intervals.
+    uint32_t m_linkChanges;    //!< Link set changes since the last HELLO message.
+
+    /**
+     * Gets the current HELLO emission interval.
+     * \returns HelloInterval, scaled in adaptive interval mode.
+     */
+    Time GetHelloInterval() const;
+
+    /**
+     * Gets the current TC emission interval.
+     * \returns TcInterval, scaled in adaptive interval mode.
+     */
+    Time GetTcInterval() const;
+
+    /**
+     * Records a change of the link set in adaptive interval mode.
+     *
+     * The first change after a HELLO message halves the intervals (down to
+     * the lower bound), and the pending HELLO and TC messages are brought
+     * forward accordingly.
+     */
+    void LinkSetChanged();
+
+    /**
+     * Updates the intervals before a HELLO message in adaptive interval mode:
+     * if the link set did not change since the previous HELLO message, the
+     * intervals grow by 25% (up to the upper bound).
+     */
+    void AdaptIntervals();
+
+    /// Fisheye TC scopes, by increasing TTL. Empty if the fisheye mode is disabled.
+    std::vector<FisheyeScope> m_fisheyeScopes;
+
+    /**
+     * Sets the fisheye TC scopes.
+     * \param scopes Space separated list of TTL:interval pairs, empty to disable the fisheye mode.
+     */
+    void SetFisheyeScopes(std::string scopes);
+
+    /**
+     * Gets the fisheye TC scopes.
+     * \returns Space separated list of TTL:interval pairs.
+     */
+    std::string GetFisheyeScopes() const;
+
+    /**
+     * Selects the scope of the next TC message in fisheye mode.
+     *
+     * The widest scope whose interval has elapsed is selected (or the narrowest
+     * scope if none did), and it is marked as sent along with all the narrower ones.
+     *
+     * \returns The scope of the next TC message.
+     */
+    const FisheyeScope& NextFisheyeScope();
+
     OlsrState m_state; //!< Internal state with all needed data structs.
     Ptr<Ipv4> m_ipv4;  //!< IPv4 object the routing is linked to.
 
@@ -369,6 +600,19 @@ class RoutingProtocol : public Ipv4RoutingProtocol
     void NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress address) override;
     void NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress address) override;
 
+    /**
+     * Rebuilds the cache of the interface indexes of the local addresses and
+     * net devices, after a change of the interfaces or of their addresses.
+     */
+    void UpdateInterfaceIndexes();
+
+    /**
+     * Gets the interface index of a local address, from the cache.
+     * \param address The address.
+     * \returns The interface index, or -1 if the address is not a local address.
+     */
+    int32_t GetInterfaceForAddress(const Ipv4Address& address) const;
+
     /**
      * Send an OLSR message.
      * \param packet The packet to be sent.
@@ -404,6 +648,40 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      */
     void RoutingTableComputation();
 
+    /**
+     * \brief Adds the routes to the neighbors, 2-hop neighbors and topology set
+     * destinations with the lowest hop count (steps 2 and 3 of the \RFC{3626}
+     * routing table calculation).
+     */
+    void HopCountRouteComputation();
+
+    /**
+     * \brief Adds the routes to the neighbors, 2-hop neighbors and topology set
+     * destinations with the lowest ETX cost (link quality extension).
+     */
+    void LinkQualityRouteComputation();
+
+    /**
+     * \brief Updates the HNA routing table from the association set and the
+     * routes to the gateways (step 5 of the \RFC{3626} routing table calculation).
+     */
+    void HnaRouteComputation();
+
+    /**
+     * \brief Updates the estimation of the delivery ratio of a link upon the
+     * reception of a HELLO message on it (link quality extension).
+     * \param tuple The link tuple.
+     * \param hTime The HELLO emission interval of the neighbor.
+     */
+    void UpdateLinkQuality(LinkTuple& tuple, Time hTime);
+
+    /**
+     * \brief Finds the valid link with the lowest ETX cost towards a neighbor.
+     * \param neighborMainAddr The main address of the neighbor.
+     * \returns The link tuple, or nullptr if there is no valid link to the neighbor.
+     */
+    const LinkTuple* FindBestLink(const Ipv4Address& neighborMainAddr) const;
+
   public:
     /**
      * \brief Gets the main address associated with a given interface address.
@@ -551,6 +829,9 @@ class RoutingProtocol : public Ipv4RoutingProtocol
     olsr::MessageList m_queuedMessages;
     Timer m_queuedMessagesTimer; //!< timer for throttling outgoing messages
 
+    /// Receive buffer, reused across packets, holding the messages being processed.
+    std::vector<uint8_t> m_rxBuffer;
+
     /**
      * \brief OLSR's default forwarding algorithm.
      *
@@ -562,7 +843,7 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \param localIface The address of the interface where the message was received from.
      * \param senderAddress The sender IPv4 address.
      */
-    void ForwardDefault(olsr::MessageHeader olsrMessage,
+    void ForwardDefault(const olsr::MessageView& olsrMessage,
                         DuplicateTuple* duplicated,
                         const Ipv4Address& localIface,
                         const Ipv4Address& senderAddress);
@@ -583,10 +864,48 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * %OLSR messages.
      *
      * Maximum number of messages which can be contained in an %OLSR packet is
-     * dictated by OLSR_MAX_MSGS constant.
+     * dictated by OLSR_MAX_MSGS constant. The messages of each packet are
+     * serialized directly into a single packet buffer.
      */
     void SendQueuedMessages();
 
+    /**
+     * \brief Serializes %OLSR messages into a buffer sized from their total
+     * size, and creates a packet from it.
+     *
+     * \param first the first message of the packet.
+     * \param last the end of the messages of the packet.
+     * \return the packet, with the same bytes as adding the messages as headers.
+     */
+    static Ptr<Packet> SerializeMessages(MessageList::const_iterator first,
+                                         MessageList::const_iterator last);
+
+    /**
+     * \brief Removes from the queued messages the TC messages superseded by a
+     * queued TC message of the same originator with a newer ANSN.
+     *
+     * DELTA_TC messages are only superseded by full TC messages, since each
+     * one is relative to the previous one.
+     */
+    void DropSupersededTcMessages();
+
+    /**
+     * \brief Distributes the queued messages in as few %OLSR packets as possible.
+     *
+     * Each message goes in the first packet with enough room left (first fit).
+     * A message larger than the maximum size gets a packet on its own.
+     *
+     * \param maxSize maximum size of the messages of a packet, in bytes.
+     * \return the messages of each packet.
+     */
+    std::vector<MessageList> PackQueuedMessages(uint32_t maxSize) const;
+
+    /**
+     * \return the maximum size of the messages of an %OLSR packet sent without
+     * fragmentation on all the %OLSR interfaces.
+     */
+    uint32_t GetMaxMessagesSize() const;
+
     /**
      * \brief Creates a new %OLSR HELLO message which is buffered for being sent later on.
      */
@@ -616,6 +935,27 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      */
     void NeighborLoss(const LinkTuple& tuple);
 
+    /**
+     * \brief Notifies a transmission failure of the Wi-Fi MAC layer.
+     *
+     * If the frame reached the retry limit, the neighbors using the receiver
+     * MAC address (found in the ARP caches) are considered lost.
+     *
+     * \param reason The reason why the frame was dropped.
+     * \param mpdu The dropped frame.
+     */
+    void NotifyTxError(WifiMacDropReason reason, Ptr<const WifiMpdu> mpdu);
+
+    /**
+     * \brief Performs a neighbor loss reported by the link layer (\RFC{3626} section 13).
+     *
+     * The link is advertised as lost until a HELLO message from the neighbor
+     * establishes it again.
+     *
+     * \param neighborIfaceAddr The interface address of the neighbor.
+     */
+    void LinkLayerNeighborLoss(const Ipv4Address& neighborIfaceAddr);
+
     /**
      * \brief Adds a duplicate tuple to the Duplicate Set.
      *
@@ -749,7 +1089,7 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \param receiverIface the address of the interface where the message was received from.
      * \param senderIface the address of the interface where the message was sent from.
      */
-    void ProcessHello(const olsr::MessageHeader& msg,
+    void ProcessHello(const olsr::MessageView& msg,
                       const Ipv4Address& receiverIface,
                       const Ipv4Address& senderIface);
 
@@ -763,7 +1103,20 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \param senderIface The address of the interface where the message was sent from.
      *
      */
-    void ProcessTc(const olsr::MessageHeader& msg, const Ipv4Address& senderIface);
+    void ProcessTc(const olsr::MessageView& msg, const Ipv4Address& senderIface);
+
+    /**
+     * \brief Processes a DELTA_TC message.
+     *
+     * The changes are applied to the Topology Set only if it holds the
+     * topology advertised by the originator with the base ANSN of the
+     * message. Otherwise a previous message was missed, and the message
+     * is ignored until the next full TC message of the originator.
+     *
+     * \param msg The %OLSR message which contains the DELTA_TC message.
+     * \param senderIface The address of the interface where the message was sent from.
+     */
+    void ProcessDeltaTc(const olsr::MessageView& msg, const Ipv4Address& senderIface);
 
     /**
      * \brief Processes a MID message following \RFC{3626} specification.
@@ -774,7 +1127,7 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \param msg the %OLSR message which contains the MID message.
      * \param senderIface the address of the interface where the message was sent from.
      */
-    void ProcessMid(const olsr::MessageHeader& msg, const Ipv4Address& senderIface);
+    void ProcessMid(const olsr::MessageView& msg, const Ipv4Address& senderIface);
 
     /**
      *
@@ -787,7 +1140,7 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \param senderIface the address of the interface where the message was sent from.
      *
      */
-    void ProcessHna(const olsr::MessageHeader& msg, const Ipv4Address& senderIface);
+    void ProcessHna(const olsr::MessageView& msg, const Ipv4Address& senderIface);
 
     /**
      * \brief Updates Link Set according to a new received HELLO message
@@ -797,8 +1150,8 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \param receiverIface The interface that received the message.
      * \param senderIface The sender interface.
      */
-    void LinkSensing(const olsr::MessageHeader& msg,
-                     const olsr::MessageHeader::Hello& hello,
+    void LinkSensing(const olsr::MessageView& msg,
+                     const olsr::MessageView::Hello& hello,
                      const Ipv4Address& receiverIface,
                      const Ipv4Address& senderIface);
 
@@ -808,8 +1161,7 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \param msg The received message.
      * \param hello The received HELLO sub-message.
      */
-    void PopulateNeighborSet(const olsr::MessageHeader& msg,
-                             const olsr::MessageHeader::Hello& hello);
+    void PopulateNeighborSet(const olsr::MessageView& msg, const olsr::MessageView::Hello& hello);
 
     /**
      * \brief Updates the 2-hop Neighbor Set according to the information contained
@@ -817,8 +1169,8 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \param msg The received message.
      * \param hello The received HELLO sub-message.
      */
-    void PopulateTwoHopNeighborSet(const olsr::MessageHeader& msg,
-                                   const olsr::MessageHeader::Hello& hello);
+    void PopulateTwoHopNeighborSet(const olsr::MessageView& msg,
+                                   const olsr::MessageView::Hello& hello);
 
     /**
      * \brief Updates the MPR Selector Set according to the information contained in
@@ -826,8 +1178,8 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \param msg The received message.
      * \param hello The received HELLO sub-message.
      */
-    void PopulateMprSelectorSet(const olsr::MessageHeader& msg,
-                                const olsr::MessageHeader::Hello& hello);
+    void PopulateMprSelectorSet(const olsr::MessageView& msg,
+                                const olsr::MessageView::Hello& hello);
 
     int Degree(const NeighborTuple& tuple);
 
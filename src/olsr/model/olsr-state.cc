@@ -27,6 +27,8 @@
 
 #include "olsr-state.h"
 
+#include <algorithm>
+
 namespace ns3
 {
 namespace olsr
@@ -268,7 +270,7 @@ OlsrState::SetMprSet(MprSet mprSet)
     m_mprSet = mprSet;
 }
 
-MprSet
+const MprSet&
 OlsrState::GetMprSet() const
 {
     return m_mprSet;
@@ -487,6 +489,24 @@ OlsrState::FindNeighborInterfaces(const Ipv4Address& neighborMainAddr) const
     return retval;
 }
 
+void
+OlsrState::ClearLearnedState(const Ipv4Address& mainAddr)
+{
+    m_linkSet.clear();
+    m_neighborSet.clear();
+    m_twoHopNeighborSet.clear();
+    m_topologySet.clear();
+    m_mprSet.clear();
+    m_mprSelectorSet.clear();
+    m_ifaceAssocSet.erase(std::remove_if(m_ifaceAssocSet.begin(),
+                                         m_ifaceAssocSet.end(),
+                                         [&mainAddr](const IfaceAssocTuple& tuple) {
+                                             return tuple.mainAddr != mainAddr;
+                                         }),
+                          m_ifaceAssocSet.end());
+    m_associationSet.clear();
+}
+
 /********** Host-Network Association Set Manipulation **********/
 
 AssociationTuple*
@@ -226,7 +226,7 @@ class OlsrState
      * Gets the MPR set.
      * \return The MPR set.
      */
-    MprSet GetMprSet() const;
+    const MprSet& GetMprSet() const;
 
     // Duplicate
 
@@ -296,6 +296,15 @@ class OlsrState
         return m_topologySet;
     }
 
+    /**
+     * Gets the topology set.
+     * \returns The topology set.
+     */
+    TopologySet& GetTopologySet()
+    {
+        return m_topologySet;
+    }
+
     /**
      * Finds a topology tuple.
      * \param destAddr The destination address.
@@ -427,6 +436,15 @@ class OlsrState
      * \returns A container of the neighbor addresses (excluding the main one).
      */
     std::vector<Ipv4Address> FindNeighborInterfaces(const Ipv4Address& neighborMainAddr) const;
+
+    /**
+     * Clears the state learned from the other nodes: the link, neighbor,
+     * 2-hop neighbor, topology, MPR, MPR selector and association sets, and
+     * the interface associations of the other nodes. The duplicate set and
+     * the local associations are kept.
+     * \param mainAddr The main address of the node.
+     */
+    void ClearLearnedState(const Ipv4Address& mainAddr);
 };
 
 } // namespace olsr
@@ -326,6 +326,274 @@ OlsrHnaTestCase::DoRun()
     NS_TEST_ASSERT_MSG_EQ(packet.GetSize(), 0, "All bytes in packet were not read");
 }
 
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Check views of serialized olsr messages
+ */
+class OlsrMessageViewTestCase : public TestCase
+{
+  public:
+    OlsrMessageViewTestCase();
+    void DoRun() override;
+};
+
+OlsrMessageViewTestCase::OlsrMessageViewTestCase()
+    : TestCase("Check views of serialized olsr messages")
+{
+}
+
+void
+OlsrMessageViewTestCase::DoRun()
+{
+    Packet packet;
+
+    olsr::MessageHeader helloMsg;
+    helloMsg.SetVTime(Seconds(6));
+    helloMsg.SetOriginatorAddress(Ipv4Address("10.0.0.1"));
+    helloMsg.SetTimeToLive(1);
+    helloMsg.SetMessageSequenceNumber(7);
+    olsr::MessageHeader::Hello& helloIn = helloMsg.GetHello();
+    helloIn.SetHTime(Seconds(2));
+    helloIn.willingness = olsr::Willingness::HIGH;
+    {
+        olsr::MessageHeader::Hello::LinkMessage lm1;
+        lm1.linkCode = 2;
+        lm1.neighborInterfaceAddresses.emplace_back("1.2.3.4");
+        lm1.neighborInterfaceAddresses.emplace_back("1.2.3.5");
+        helloIn.linkMessages.push_back(lm1);
+
+        olsr::MessageHeader::Hello::LinkMessage lm2;
+        lm2.linkCode = 6;
+        helloIn.linkMessages.push_back(lm2);
+
+        olsr::MessageHeader::Hello::LinkMessage lm3;
+        lm3.linkCode = 3;
+        lm3.neighborInterfaceAddresses.emplace_back("2.2.3.4");
+        helloIn.linkMessages.push_back(lm3);
+    }
+
+    olsr::MessageHeader tcMsg;
+    tcMsg.SetVTime(Seconds(15));
+    tcMsg.SetOriginatorAddress(Ipv4Address("10.0.0.2"));
+    tcMsg.SetTimeToLive(255);
+    tcMsg.SetHopCount(3);
+    tcMsg.SetMessageSequenceNumber(8);
+    olsr::MessageHeader::Tc& tcIn = tcMsg.GetTc();
+    tcIn.ansn = 0x1234;
+    tcIn.neighborAddresses.emplace_back("1.2.3.4");
+    tcIn.neighborAddresses.emplace_back("1.2.3.5");
+
+    olsr::MessageHeader hnaMsg;
+    hnaMsg.SetVTime(Seconds(15));
+    olsr::MessageHeader::Hna& hnaIn = hnaMsg.GetHna();
+    hnaIn.associations.push_back(
+        olsr::MessageHeader::Hna::Association{Ipv4Address("1.2.3.0"), Ipv4Mask("255.255.255.0")});
+
+    packet.AddHeader(hnaMsg);
+    packet.AddHeader(tcMsg);
+    packet.AddHeader(helloMsg);
+
+    std::vector<uint8_t> buffer(packet.GetSize());
+    packet.CopyData(buffer.data(), buffer.size());
+
+    olsr::MessageView helloView(buffer.data(), buffer.size());
+    NS_TEST_ASSERT_MSG_EQ(helloView.GetMessageType(), olsr::MessageHeader::HELLO_MESSAGE, "600");
+    NS_TEST_ASSERT_MSG_EQ(helloView.GetSerializedSize(), helloMsg.GetSerializedSize(), "601");
+    NS_TEST_ASSERT_MSG_EQ(helloView.GetVTime(), Seconds(6), "602");
+    NS_TEST_ASSERT_MSG_EQ(helloView.GetOriginatorAddress(), Ipv4Address("10.0.0.1"), "603");
+    NS_TEST_ASSERT_MSG_EQ(helloView.GetMessageSequenceNumber(), 7, "604");
+
+    const olsr::MessageView::Hello helloOut = helloView.GetHello();
+    NS_TEST_ASSERT_MSG_EQ(helloOut.GetHTime(), Seconds(2), "605");
+    NS_TEST_ASSERT_MSG_EQ(helloOut.willingness, olsr::Willingness::HIGH, "606");
+
+    auto lm = helloOut.linkMessages.begin();
+    NS_TEST_ASSERT_MSG_EQ(lm->linkCode, 2, "607");
+    auto addr = lm->neighborInterfaceAddresses.begin();
+    NS_TEST_ASSERT_MSG_EQ(*addr, Ipv4Address("1.2.3.4"), "608");
+    NS_TEST_ASSERT_MSG_EQ(*(++addr), Ipv4Address("1.2.3.5"), "609");
+    NS_TEST_ASSERT_MSG_EQ((++addr == lm->neighborInterfaceAddresses.end()), true, "610");
+    ++lm;
+    NS_TEST_ASSERT_MSG_EQ(lm->linkCode, 6, "611");
+    NS_TEST_ASSERT_MSG_EQ(lm->neighborInterfaceAddresses.empty(), true, "612");
+    ++lm;
+    NS_TEST_ASSERT_MSG_EQ(lm->linkCode, 3, "613");
+    NS_TEST_ASSERT_MSG_EQ(*lm->neighborInterfaceAddresses.begin(), Ipv4Address("2.2.3.4"), "614");
+    NS_TEST_ASSERT_MSG_EQ((++lm == helloOut.linkMessages.end()), true, "615");
+
+    uint32_t offset = helloView.GetSerializedSize();
+    olsr::MessageView tcView(buffer.data() + offset, buffer.size() - offset);
+    NS_TEST_ASSERT_MSG_EQ(tcView.GetMessageType(), olsr::MessageHeader::TC_MESSAGE, "616");
+    NS_TEST_ASSERT_MSG_EQ(tcView.GetTimeToLive(), 255, "617");
+    NS_TEST_ASSERT_MSG_EQ(tcView.GetHopCount(), 3, "618");
+    const olsr::MessageView::Tc tcOut = tcView.GetTc();
+    NS_TEST_ASSERT_MSG_EQ(tcOut.ansn, 0x1234, "619");
+    uint32_t count = 0;
+    for (const Ipv4Address& neighbor : tcOut.neighborAddresses)
+    {
+        NS_TEST_ASSERT_MSG_EQ(neighbor, tcIn.neighborAddresses[count], "620");
+        count++;
+    }
+    NS_TEST_ASSERT_MSG_EQ(count, 2, "621");
+
+    olsr::MessageHeader tcCopy = tcView.GetMessageHeader();
+    NS_TEST_ASSERT_MSG_EQ(tcCopy.GetTc().neighborAddresses.size(), 2, "622");
+    NS_TEST_ASSERT_MSG_EQ(tcCopy.GetOriginatorAddress(), Ipv4Address("10.0.0.2"), "623");
+
+    offset += tcView.GetSerializedSize();
+    olsr::MessageView hnaView(buffer.data() + offset, buffer.size() - offset);
+    auto assoc = hnaView.GetHna().associations.begin();
+    NS_TEST_ASSERT_MSG_EQ(assoc->address, Ipv4Address("1.2.3.0"), "624");
+    NS_TEST_ASSERT_MSG_EQ(assoc->mask, Ipv4Mask("255.255.255.0"), "625");
+    NS_TEST_ASSERT_MSG_EQ(offset + hnaView.GetSerializedSize(), buffer.size(), "626");
+
+    // Only the fixed fields are decoded when the view is created: a message
+    // with a corrupted body can still be skipped, as long as it is not read.
+    std::vector<uint8_t> corrupted = buffer;
+    corrupted[12 + 6] = 0xff; // Size of the first link message of the HELLO message
+    olsr::MessageView skippedView(corrupted.data(), corrupted.size());
+    NS_TEST_ASSERT_MSG_EQ(skippedView.GetMessageSequenceNumber(), 7, "627");
+    NS_TEST_ASSERT_MSG_EQ(skippedView.GetSerializedSize(), helloMsg.GetSerializedSize(), "628");
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Check LQ_HELLO and LQ_TC olsr messages
+ */
+class OlsrLinkQualityTestCase : public TestCase
+{
+  public:
+    OlsrLinkQualityTestCase();
+    void DoRun() override;
+};
+
+OlsrLinkQualityTestCase::OlsrLinkQualityTestCase()
+    : TestCase("Check LQ_HELLO and LQ_TC olsr messages")
+{
+}
+
+void
+OlsrLinkQualityTestCase::DoRun()
+{
+    Packet packet;
+
+    olsr::MessageHeader helloMsg;
+    helloMsg.SetMessageType(olsr::MessageHeader::LQ_HELLO_MESSAGE);
+    olsr::MessageHeader::Hello& helloIn = helloMsg.GetHello();
+    helloIn.SetHTime(Seconds(2));
+    helloIn.willingness = olsr::Willingness::DEFAULT;
+    olsr::MessageHeader::Hello::LinkMessage lm;
+    lm.linkCode = 6;
+    lm.neighborInterfaceAddresses.emplace_back("1.2.3.4");
+    lm.neighborInterfaceAddresses.emplace_back("1.2.3.5");
+    lm.linkQualities.push_back(olsr::MessageHeader::LinkQuality{255, 128});
+    lm.linkQualities.push_back(olsr::MessageHeader::LinkQuality{10, 20});
+    helloIn.linkMessages.push_back(lm);
+
+    olsr::MessageHeader tcMsg;
+    tcMsg.SetMessageType(olsr::MessageHeader::LQ_TC_MESSAGE);
+    olsr::MessageHeader::Tc& tcIn = tcMsg.GetTc();
+    tcIn.ansn = 0x4321;
+    tcIn.neighborAddresses.emplace_back("1.2.3.4");
+    tcIn.neighborQualities.push_back(olsr::MessageHeader::LinkQuality{200, 100});
+
+    NS_TEST_ASSERT_MSG_EQ(helloMsg.GetSerializedSize(), 12 + 4 + 4 + 2 * 8, "700");
+    NS_TEST_ASSERT_MSG_EQ(tcMsg.GetSerializedSize(), 12 + 4 + 8, "701");
+
+    packet.AddHeader(tcMsg);
+    packet.AddHeader(helloMsg);
+
+    std::vector<uint8_t> buffer(packet.GetSize());
+    packet.CopyData(buffer.data(), buffer.size());
+
+    olsr::MessageHeader helloOut;
+    packet.RemoveHeader(helloOut);
+    NS_TEST_ASSERT_MSG_EQ(helloOut.GetMessageType(), olsr::MessageHeader::LQ_HELLO_MESSAGE, "702");
+    const olsr::MessageHeader::Hello::LinkMessage& lmOut = helloOut.GetHello().linkMessages[0];
+    NS_TEST_ASSERT_MSG_EQ(lmOut.neighborInterfaceAddresses[1], Ipv4Address("1.2.3.5"), "703");
+    NS_TEST_ASSERT_MSG_EQ(+lmOut.linkQualities[0].lq, 255, "704");
+    NS_TEST_ASSERT_MSG_EQ(+lmOut.linkQualities[0].nlq, 128, "705");
+    NS_TEST_ASSERT_MSG_EQ(+lmOut.linkQualities[1].lq, 10, "706");
+    NS_TEST_ASSERT_MSG_EQ(+lmOut.linkQualities[1].nlq, 20, "707");
+
+    olsr::MessageHeader tcOut;
+    packet.RemoveHeader(tcOut);
+    NS_TEST_ASSERT_MSG_EQ(tcOut.GetMessageType(), olsr::MessageHeader::LQ_TC_MESSAGE, "708");
+    NS_TEST_ASSERT_MSG_EQ(tcOut.GetTc().ansn, 0x4321, "709");
+    NS_TEST_ASSERT_MSG_EQ(tcOut.GetTc().neighborAddresses[0], Ipv4Address("1.2.3.4"), "710");
+    NS_TEST_ASSERT_MSG_EQ(+tcOut.GetTc().neighborQualities[0].lq, 200, "711");
+    NS_TEST_ASSERT_MSG_EQ(+tcOut.GetTc().neighborQualities[0].nlq, 100, "712");
+    NS_TEST_ASSERT_MSG_EQ(packet.GetSize(), 0, "All bytes in packet were not read");
+
+    // The same messages, through views
+    olsr::MessageView helloView(buffer.data(), buffer.size());
+    auto lmView = helloView.GetHello().linkMessages.begin();
+    auto addr = lmView->neighborInterfaceAddresses.begin();
+    NS_TEST_ASSERT_MSG_EQ(*addr, Ipv4Address("1.2.3.4"), "713");
+    NS_TEST_ASSERT_MSG_EQ(+addr.GetLinkQuality().nlq, 128, "714");
+    ++addr;
+    NS_TEST_ASSERT_MSG_EQ(*addr, Ipv4Address("1.2.3.5"), "715");
+    NS_TEST_ASSERT_MSG_EQ(+addr.GetLinkQuality().lq, 10, "716");
+    NS_TEST_ASSERT_MSG_EQ((++addr == lmView->neighborInterfaceAddresses.end()), true, "717");
+
+    uint32_t offset = helloView.GetSerializedSize();
+    olsr::MessageView tcView(buffer.data() + offset, buffer.size() - offset);
+    auto tcAddr = tcView.GetTc().neighborAddresses.begin();
+    NS_TEST_ASSERT_MSG_EQ(*tcAddr, Ipv4Address("1.2.3.4"), "718");
+    NS_TEST_ASSERT_MSG_EQ(+tcAddr.GetLinkQuality().lq, 200, "719");
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Check DELTA_TC olsr messages
+ */
+class OlsrDeltaTcMessageTestCase : public TestCase
+{
+  public:
+    OlsrDeltaTcMessageTestCase();
+    void DoRun() override;
+};
+
+OlsrDeltaTcMessageTestCase::OlsrDeltaTcMessageTestCase()
+    : TestCase("Check DELTA_TC olsr messages")
+{
+}
+
+void
+OlsrDeltaTcMessageTestCase::DoRun()
+{
+    Packet packet;
+    olsr::MessageHeader msgIn;
+    msgIn.SetMessageType(olsr::MessageHeader::DELTA_TC_MESSAGE);
+    olsr::MessageHeader::Tc& tcIn = msgIn.GetTc();
+    tcIn.ansn = 0x1235;
+    tcIn.baseAnsn = 0x1234;
+    tcIn.neighborAddresses.emplace_back("1.2.3.4");
+    tcIn.removedAddresses.emplace_back("1.2.3.5");
+    tcIn.removedAddresses.emplace_back("1.2.3.6");
+
+    NS_TEST_ASSERT_MSG_EQ(msgIn.GetSerializedSize(), 12 + 8 + 3 * 4, "800");
+    packet.AddHeader(msgIn);
+
+    olsr::MessageHeader msgOut;
+    packet.RemoveHeader(msgOut);
+    NS_TEST_ASSERT_MSG_EQ(msgOut.GetMessageType(), olsr::MessageHeader::DELTA_TC_MESSAGE, "801");
+    const olsr::MessageHeader::Tc& tcOut = msgOut.GetTc();
+    NS_TEST_ASSERT_MSG_EQ(tcOut.ansn, 0x1235, "802");
+    NS_TEST_ASSERT_MSG_EQ(tcOut.baseAnsn, 0x1234, "803");
+    NS_TEST_ASSERT_MSG_EQ(tcOut.neighborAddresses.size(), 1, "804");
+    NS_TEST_ASSERT_MSG_EQ(tcOut.neighborAddresses[0], Ipv4Address("1.2.3.4"), "805");
+    NS_TEST_ASSERT_MSG_EQ(tcOut.removedAddresses.size(), 2, "806");
+    NS_TEST_ASSERT_MSG_EQ(tcOut.removedAddresses[1], Ipv4Address("1.2.3.6"), "807");
+    NS_TEST_ASSERT_MSG_EQ(packet.GetSize(), 0, "All bytes in packet were not read");
+}
+
 /**
  * \ingroup olsr-test
  * \ingroup tests
@@ -346,6 +614,9 @@ OlsrTestSuite::OlsrTestSuite()
     AddTestCase(new OlsrHelloTestCase(), TestCase::Duration::QUICK);
     AddTestCase(new OlsrMidTestCase(), TestCase::Duration::QUICK);
     AddTestCase(new OlsrEmfTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new OlsrMessageViewTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new OlsrLinkQualityTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new OlsrDeltaTcMessageTestCase(), TestCase::Duration::QUICK);
 }
 
 static OlsrTestSuite g_olsrTestSuite; //!< Static variable for test initialization
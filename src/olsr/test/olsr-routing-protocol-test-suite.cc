@@ -19,10 +19,37 @@
  *          Gustavo J. A. M. Carneiro <gjc@inescporto.pt>
  */
 
+#include "ns3/arp-cache.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
 #include "ns3/ipv4-header.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/mobility-model.h"
+#include "ns3/olsr-header.h"
+#include "ns3/olsr-helper.h"
+#include "ns3/olsr-profiler.h"
 #include "ns3/olsr-repositories.h"
 #include "ns3/olsr-routing-protocol.h"
+#include "ns3/packet.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
 #include "ns3/test.h"
+#include "ns3/udp-header.h"
+#include "ns3/wifi-mac-header.h"
+#include "ns3/wifi-mac.h"
+#include "ns3/wifi-mpdu.h"
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <vector>
 
 /**
  * \ingroup olsr
@@ -174,6 +201,1498 @@ OlsrMprTestCase::DoRun()
                           "Node 1 must NOT select node 8 as MPR");
 }
 
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the fisheye TC scope selection
+ */
+class OlsrFisheyeTestCase : public TestCase
+{
+  public:
+    OlsrFisheyeTestCase();
+    void DoRun() override;
+};
+
+OlsrFisheyeTestCase::OlsrFisheyeTestCase()
+    : TestCase("Check OLSR fisheye TC scope selection")
+{
+}
+
+void
+OlsrFisheyeTestCase::DoRun()
+{
+    Ptr<RoutingProtocol> protocol = CreateObject<RoutingProtocol>();
+    protocol->SetAttribute("TcInterval", TimeValue(Seconds(5)));
+    protocol->SetAttribute("FisheyeScopes", StringValue("255:20s 2:5s 8:10s"));
+
+    StringValue scopes;
+    protocol->GetAttribute("FisheyeScopes", scopes);
+    NS_TEST_EXPECT_MSG_EQ(scopes.Get(), "2:5s 8:10s 255:20s", "Scopes must be sorted by TTL");
+
+    // One TC every TcInterval: the first one reaches the whole network, then
+    // the scopes widen as their intervals elapse.
+    const uint8_t expected[] = {255, 2, 8, 2, 255, 2, 8};
+    std::vector<uint8_t> ttls;
+    for (uint32_t i = 0; i < sizeof(expected); i++)
+    {
+        Simulator::Schedule(Seconds(5 * i), [&protocol, &ttls]() {
+            ttls.push_back(protocol->NextFisheyeScope().ttl);
+        });
+    }
+    Simulator::Run();
+    Simulator::Destroy();
+
+    NS_TEST_ASSERT_MSG_EQ(ttls.size(), sizeof(expected), "One scope per TC message");
+    for (uint32_t i = 0; i < sizeof(expected); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(+ttls[i], +expected[i], "Unexpected scope for TC " << i);
+    }
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the MPR computation of the link quality extension
+ */
+class OlsrLinkQualityMprTestCase : public TestCase
+{
+  public:
+    OlsrLinkQualityMprTestCase();
+    void DoRun() override;
+};
+
+OlsrLinkQualityMprTestCase::OlsrLinkQualityMprTestCase()
+    : TestCase("Check OLSR link quality MPR computing mechanism")
+{
+}
+
+void
+OlsrLinkQualityMprTestCase::DoRun()
+{
+    Ptr<RoutingProtocol> protocol = CreateObject<RoutingProtocol>();
+    protocol->SetAttribute("LinkQuality", BooleanValue(true));
+    protocol->m_mainAddress = Ipv4Address("10.0.0.1");
+    OlsrState& state = protocol->m_state;
+
+    /*
+     *  1 -- 2 -- 4
+     *  |         |
+     *  3 ------- +
+     *
+     * Both 2 and 3 reach 4, but the link to 3 is lossy: node 1 must select 2 only.
+     */
+    LinkTuple link;
+    link.localIfaceAddr = Ipv4Address("10.0.0.1");
+    link.symTime = Seconds(3600);
+    link.asymTime = Seconds(3600);
+    link.time = Seconds(3600);
+    link.neighborIfaceAddr = Ipv4Address("10.0.0.2");
+    link.linkQuality = 1;
+    link.neighborLinkQuality = 1;
+    state.InsertLinkTuple(link);
+    link.neighborIfaceAddr = Ipv4Address("10.0.0.3");
+    link.linkQuality = 0.5;
+    link.neighborLinkQuality = 0.5;
+    state.InsertLinkTuple(link);
+
+    NeighborTuple neighbor;
+    neighbor.status = NeighborTuple::STATUS_SYM;
+    neighbor.willingness = Willingness::DEFAULT;
+    neighbor.neighborMainAddr = Ipv4Address("10.0.0.2");
+    state.InsertNeighborTuple(neighbor);
+    neighbor.neighborMainAddr = Ipv4Address("10.0.0.3");
+    state.InsertNeighborTuple(neighbor);
+
+    TwoHopNeighborTuple tuple;
+    tuple.expirationTime = Seconds(3600);
+    tuple.neighborMainAddr = Ipv4Address("10.0.0.2");
+    tuple.twoHopNeighborAddr = Ipv4Address("10.0.0.4");
+    state.InsertTwoHopNeighborTuple(tuple);
+    tuple.neighborMainAddr = Ipv4Address("10.0.0.3");
+    tuple.twoHopNeighborAddr = Ipv4Address("10.0.0.4");
+    state.InsertTwoHopNeighborTuple(tuple);
+
+    protocol->MprComputation();
+    MprSet mpr = state.GetMprSet();
+    NS_TEST_EXPECT_MSG_EQ(mpr.size(), 1, "An only address must be chosen.");
+    NS_TEST_EXPECT_MSG_EQ((mpr.find("10.0.0.2") != mpr.end()),
+                          true,
+                          "Node 1 must select node 2 as MPR");
+
+    // A very lossy 2-hop link makes the path through 3 the best one.
+    state.GetTwoHopNeighbors()[0].linkCost = 10;
+    protocol->MprComputation();
+    mpr = state.GetMprSet();
+    NS_TEST_EXPECT_MSG_EQ(mpr.size(), 1, "An only address must be chosen.");
+    NS_TEST_EXPECT_MSG_EQ((mpr.find("10.0.0.3") != mpr.end()),
+                          true,
+                          "Node 1 must select node 3 as MPR");
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the processing of DELTA_TC messages
+ */
+class OlsrDeltaTcTestCase : public TestCase
+{
+  public:
+    OlsrDeltaTcTestCase();
+    void DoRun() override;
+
+  private:
+    /**
+     * Builds a DELTA_TC message originated by 10.0.0.5.
+     * \param ansn The ANSN of the message.
+     * \param baseAnsn The ANSN the changes are relative to.
+     * \param added The added neighbor addresses.
+     * \param removed The removed neighbor addresses.
+     * \returns The serialized message.
+     */
+    std::vector<uint8_t> BuildDeltaTc(uint16_t ansn,
+                                      uint16_t baseAnsn,
+                                      const std::vector<Ipv4Address>& added,
+                                      const std::vector<Ipv4Address>& removed);
+};
+
+OlsrDeltaTcTestCase::OlsrDeltaTcTestCase()
+    : TestCase("Check OLSR DELTA_TC message processing")
+{
+}
+
+std::vector<uint8_t>
+OlsrDeltaTcTestCase::BuildDeltaTc(uint16_t ansn,
+                                  uint16_t baseAnsn,
+                                  const std::vector<Ipv4Address>& added,
+                                  const std::vector<Ipv4Address>& removed)
+{
+    MessageHeader msg;
+    msg.SetMessageType(MessageHeader::DELTA_TC_MESSAGE);
+    msg.SetVTime(Seconds(15));
+    msg.SetOriginatorAddress(Ipv4Address("10.0.0.5"));
+    msg.SetTimeToLive(255);
+    msg.SetHopCount(1);
+    msg.SetMessageSequenceNumber(ansn);
+    MessageHeader::Tc& tc = msg.GetTc();
+    tc.ansn = ansn;
+    tc.baseAnsn = baseAnsn;
+    tc.neighborAddresses = added;
+    tc.removedAddresses = removed;
+
+    Packet packet;
+    packet.AddHeader(msg);
+    std::vector<uint8_t> buffer(packet.GetSize());
+    packet.CopyData(buffer.data(), buffer.size());
+    return buffer;
+}
+
+void
+OlsrDeltaTcTestCase::DoRun()
+{
+    Ptr<RoutingProtocol> protocol = CreateObject<RoutingProtocol>();
+    protocol->m_mainAddress = Ipv4Address("10.0.0.1");
+    OlsrState& state = protocol->m_state;
+
+    LinkTuple link;
+    link.localIfaceAddr = Ipv4Address("10.0.0.1");
+    link.neighborIfaceAddr = Ipv4Address("10.0.0.2");
+    link.symTime = Seconds(3600);
+    link.asymTime = Seconds(3600);
+    link.time = Seconds(3600);
+    state.InsertLinkTuple(link);
+
+    TopologyTuple topology;
+    topology.lastAddr = Ipv4Address("10.0.0.5");
+    topology.sequenceNumber = 10;
+    topology.expirationTime = Seconds(3600);
+    topology.destAddr = Ipv4Address("10.0.0.6");
+    state.InsertTopologyTuple(topology);
+    topology.destAddr = Ipv4Address("10.0.0.7");
+    state.InsertTopologyTuple(topology);
+
+    // 10 -> 11: 10.0.0.7 is replaced by 10.0.0.8.
+    std::vector<uint8_t> buffer =
+        BuildDeltaTc(11, 10, {Ipv4Address("10.0.0.8")}, {Ipv4Address("10.0.0.7")});
+    protocol->ProcessDeltaTc(MessageView(buffer.data(), buffer.size()), Ipv4Address("10.0.0.2"));
+
+    NS_TEST_ASSERT_MSG_EQ(state.GetTopologySet().size(), 2, "Two topology tuples expected");
+    NS_TEST_EXPECT_MSG_EQ((state.FindTopologyTuple("10.0.0.7", "10.0.0.5") == nullptr),
+                          true,
+                          "10.0.0.7 must be removed");
+    const TopologyTuple* kept = state.FindTopologyTuple("10.0.0.6", "10.0.0.5");
+    NS_TEST_ASSERT_MSG_EQ((kept != nullptr), true, "10.0.0.6 must be kept");
+    NS_TEST_EXPECT_MSG_EQ(kept->sequenceNumber, 11, "10.0.0.6 must be refreshed");
+    const TopologyTuple* added = state.FindTopologyTuple("10.0.0.8", "10.0.0.5");
+    NS_TEST_ASSERT_MSG_EQ((added != nullptr), true, "10.0.0.8 must be added");
+    NS_TEST_EXPECT_MSG_EQ(added->sequenceNumber, 11, "10.0.0.8 must have the new ANSN");
+
+    // 12 -> 13: the message of ANSN 12 was missed, the changes must be ignored.
+    buffer = BuildDeltaTc(13, 12, {Ipv4Address("10.0.0.9")}, {Ipv4Address("10.0.0.6")});
+    protocol->ProcessDeltaTc(MessageView(buffer.data(), buffer.size()), Ipv4Address("10.0.0.2"));
+
+    NS_TEST_EXPECT_MSG_EQ(state.GetTopologySet().size(), 2, "The topology must be unchanged");
+    NS_TEST_EXPECT_MSG_EQ((state.FindTopologyTuple("10.0.0.9", "10.0.0.5") == nullptr),
+                          true,
+                          "10.0.0.9 must not be added");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the OLSR state checkpoints
+ */
+class OlsrCheckpointTestCase : public TestCase
+{
+  public:
+    OlsrCheckpointTestCase();
+    void DoRun() override;
+};
+
+OlsrCheckpointTestCase::OlsrCheckpointTestCase()
+    : TestCase("Check OLSR state checkpoints")
+{
+}
+
+void
+OlsrCheckpointTestCase::DoRun()
+{
+    Ptr<RoutingProtocol> saved = CreateObject<RoutingProtocol>();
+    saved->m_mainAddress = Ipv4Address("10.0.0.1");
+    saved->m_ansn = 42;
+
+    LinkTuple link;
+    link.localIfaceAddr = Ipv4Address("10.0.0.1");
+    link.neighborIfaceAddr = Ipv4Address("10.0.0.2");
+    link.symTime = Seconds(6);
+    link.asymTime = Seconds(6);
+    link.time = Seconds(12);
+    link.linkQuality = 0.75;
+    saved->m_state.InsertLinkTuple(link);
+
+    NeighborTuple neighbor;
+    neighbor.neighborMainAddr = Ipv4Address("10.0.0.2");
+    neighbor.status = NeighborTuple::STATUS_SYM;
+    neighbor.willingness = Willingness::HIGH;
+    saved->m_state.InsertNeighborTuple(neighbor);
+
+    TopologyTuple topology;
+    topology.destAddr = Ipv4Address("10.0.0.3");
+    topology.lastAddr = Ipv4Address("10.0.0.2");
+    topology.sequenceNumber = 7;
+    topology.expirationTime = Seconds(15);
+    saved->m_state.InsertTopologyTuple(topology);
+
+    MprSet mprSet;
+    mprSet.insert(Ipv4Address("10.0.0.2"));
+    saved->m_state.SetMprSet(mprSet);
+
+    AssociationTuple association;
+    association.gatewayAddr = Ipv4Address("10.0.0.3");
+    association.networkAddr = Ipv4Address("172.16.1.0");
+    association.netmask = Ipv4Mask("255.255.255.0");
+    association.expirationTime = Seconds(20);
+    saved->m_state.InsertAssociationTuple(association);
+
+    saved->AddEntry(Ipv4Address("10.0.0.2"), Ipv4Address("10.0.0.2"), 1, 1);
+    saved->AddEntry(Ipv4Address("10.0.0.3"), Ipv4Address("10.0.0.2"), 1, 2);
+
+    std::stringstream checkpoint;
+    saved->SaveCheckpoint(checkpoint);
+
+    // Load the checkpoint 100 seconds later: the timers are rebased.
+    Ptr<RoutingProtocol> loaded = CreateObject<RoutingProtocol>();
+    Simulator::Schedule(Seconds(100), [&loaded, &checkpoint]() {
+        loaded->LoadCheckpoint(checkpoint);
+    });
+    Simulator::Stop(Seconds(100));
+    Simulator::Run();
+
+    const OlsrState& state = loaded->m_state;
+    NS_TEST_EXPECT_MSG_EQ(loaded->m_ansn, 42, "ANSN must be restored");
+    NS_TEST_ASSERT_MSG_EQ(state.GetLinks().size(), 1, "One link tuple expected");
+    NS_TEST_EXPECT_MSG_EQ(state.GetLinks()[0].neighborIfaceAddr,
+                          Ipv4Address("10.0.0.2"),
+                          "Link neighbor must be restored");
+    NS_TEST_EXPECT_MSG_EQ(state.GetLinks()[0].time, Seconds(112), "Link time must be rebased");
+    NS_TEST_EXPECT_MSG_EQ(state.GetLinks()[0].linkQuality, 0.75, "Link quality must be restored");
+    NS_TEST_ASSERT_MSG_EQ(state.GetNeighbors().size(), 1, "One neighbor tuple expected");
+    NS_TEST_EXPECT_MSG_EQ(state.GetNeighbors()[0].willingness,
+                          Willingness::HIGH,
+                          "Willingness must be restored");
+    NS_TEST_ASSERT_MSG_EQ(state.GetTopologySet().size(), 1, "One topology tuple expected");
+    NS_TEST_EXPECT_MSG_EQ(state.GetTopologySet()[0].sequenceNumber, 7, "ANSN must be restored");
+    NS_TEST_EXPECT_MSG_EQ(state.GetTopologySet()[0].expirationTime,
+                          Seconds(115),
+                          "Topology time must be rebased");
+    NS_TEST_EXPECT_MSG_EQ(state.GetMprSet().size(), 1, "MPR set must be restored");
+    NS_TEST_ASSERT_MSG_EQ(loaded->m_table.size(), 2, "Two routes expected");
+    NS_TEST_EXPECT_MSG_EQ(loaded->m_table[Ipv4Address("10.0.0.3")].nextAddr,
+                          Ipv4Address("10.0.0.2"),
+                          "Route must be restored");
+    NS_TEST_EXPECT_MSG_EQ(loaded->m_table[Ipv4Address("10.0.0.3")].distance,
+                          2,
+                          "Route distance must be restored");
+    NS_TEST_ASSERT_MSG_EQ(loaded->m_hnaRoutingTable->GetNRoutes(), 1, "One HNA route expected");
+    NS_TEST_EXPECT_MSG_EQ(loaded->m_hnaRoutingTable->GetRoute(0).GetDestNetwork(),
+                          Ipv4Address("172.16.1.0"),
+                          "HNA route must be rebuilt");
+    NS_TEST_EXPECT_MSG_EQ(loaded->m_hnaRoutingTable->GetRoute(0).GetGateway(),
+                          Ipv4Address("10.0.0.2"),
+                          "HNA route must go through the route to the gateway");
+
+    // Loading the same checkpoint again replaces the state instead of adding to it.
+    checkpoint.clear();
+    checkpoint.seekg(0);
+    loaded->LoadCheckpoint(checkpoint);
+    NS_TEST_EXPECT_MSG_EQ(state.GetLinks().size(), 1, "One link tuple expected");
+    NS_TEST_EXPECT_MSG_EQ(state.GetNeighbors().size(), 1, "One neighbor tuple expected");
+    NS_TEST_EXPECT_MSG_EQ(state.GetTopologySet().size(), 1, "One topology tuple expected");
+    NS_TEST_EXPECT_MSG_EQ(state.GetAssociationSet().size(), 1, "One association expected");
+    NS_TEST_EXPECT_MSG_EQ(loaded->m_table.size(), 2, "Two routes expected");
+    NS_TEST_EXPECT_MSG_EQ(loaded->m_hnaRoutingTable->GetNRoutes(), 1, "One HNA route expected");
+    NS_TEST_EXPECT_MSG_EQ(loaded->m_hnaRoutes.size(), 1, "One HNA route expected");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the routing table read API
+ */
+class OlsrRoutingTableAccessTestCase : public TestCase
+{
+  public:
+    OlsrRoutingTableAccessTestCase();
+    void DoRun() override;
+};
+
+OlsrRoutingTableAccessTestCase::OlsrRoutingTableAccessTestCase()
+    : TestCase("Check OLSR routing table read API")
+{
+}
+
+void
+OlsrRoutingTableAccessTestCase::DoRun()
+{
+    Ptr<RoutingProtocol> protocol = CreateObject<RoutingProtocol>();
+    protocol->m_mainAddress = Ipv4Address("10.0.0.1");
+    protocol->AddEntry(Ipv4Address("10.0.0.2"), Ipv4Address("10.0.0.2"), 1, 1);
+    protocol->AddEntry(Ipv4Address("10.0.0.3"), Ipv4Address("10.0.0.2"), 1, 2);
+
+    const RoutingTableEntry* entry = protocol->FindRoutingTableEntry("10.0.0.3");
+    NS_TEST_ASSERT_MSG_EQ((entry != nullptr), true, "A route to 10.0.0.3 must exist");
+    NS_TEST_EXPECT_MSG_EQ(entry->nextAddr, Ipv4Address("10.0.0.2"), "Wrong next hop");
+    NS_TEST_EXPECT_MSG_EQ(entry->distance, 2, "Wrong distance");
+    NS_TEST_EXPECT_MSG_EQ((protocol->FindRoutingTableEntry("10.0.0.4") == nullptr),
+                          true,
+                          "No route to 10.0.0.4 must exist");
+
+    uint32_t distances = 0;
+    protocol->ForEachRoutingTableEntry(
+        [&distances](const RoutingTableEntry& route) { distances += route.distance; });
+    NS_TEST_EXPECT_MSG_EQ(distances, 3, "Each entry must be visited once");
+
+    // Without any neighbor, the computation empties the routing table.
+    uint32_t generation = protocol->GetRoutingTableGeneration();
+    protocol->RoutingTableComputation();
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetRoutingTableEntries().size(), 0, "No route expected");
+    NS_TEST_EXPECT_MSG_NE(protocol->GetRoutingTableGeneration(),
+                          generation,
+                          "The generation must change with the routing table");
+    generation = protocol->GetRoutingTableGeneration();
+    protocol->RoutingTableComputation();
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetRoutingTableGeneration(),
+                          generation,
+                          "The generation must not change with the same routing table");
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the adaptive HELLO and TC intervals
+ */
+class OlsrAdaptiveIntervalsTestCase : public TestCase
+{
+  public:
+    OlsrAdaptiveIntervalsTestCase();
+    void DoRun() override;
+};
+
+OlsrAdaptiveIntervalsTestCase::OlsrAdaptiveIntervalsTestCase()
+    : TestCase("Check OLSR adaptive HELLO and TC intervals")
+{
+}
+
+void
+OlsrAdaptiveIntervalsTestCase::DoRun()
+{
+    Ptr<RoutingProtocol> protocol = CreateObject<RoutingProtocol>();
+    protocol->SetAttribute("HelloInterval", TimeValue(Seconds(2)));
+    protocol->SetAttribute("TcInterval", TimeValue(Seconds(5)));
+
+    // Disabled by default: the intervals are the configured ones.
+    protocol->LinkSetChanged();
+    protocol->AdaptIntervals();
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetHelloInterval(), Seconds(2), "Wrong HELLO interval");
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetTcInterval(), Seconds(5), "Wrong TC interval");
+
+    protocol->SetAttribute("AdaptiveIntervals", BooleanValue(true));
+
+    // A stable link set makes the intervals grow up to the upper bound.
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        protocol->AdaptIntervals();
+    }
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetHelloInterval(), Seconds(8), "HELLO interval not bounded");
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetTcInterval(), Seconds(20), "TC interval not bounded");
+
+    // Only the first change of a HELLO period shrinks the intervals.
+    protocol->LinkSetChanged();
+    protocol->LinkSetChanged();
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetHelloInterval(), Seconds(4), "HELLO interval not halved");
+    protocol->AdaptIntervals();
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetHelloInterval(), Seconds(4), "No growth after a change");
+    protocol->AdaptIntervals();
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetHelloInterval(), Seconds(5), "Growth while stable");
+
+    // Continuous churn makes the intervals shrink down to the lower bound.
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        protocol->LinkSetChanged();
+        protocol->AdaptIntervals();
+    }
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetHelloInterval(), Seconds(1), "HELLO interval not bounded");
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetTcInterval(), Seconds(2.5), "TC interval not bounded");
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the neighbor losses reported by the link layer
+ */
+class OlsrLinkLayerFeedbackTestCase : public TestCase
+{
+  public:
+    OlsrLinkLayerFeedbackTestCase();
+    void DoRun() override;
+};
+
+OlsrLinkLayerFeedbackTestCase::OlsrLinkLayerFeedbackTestCase()
+    : TestCase("Check OLSR neighbor loss on link layer feedback")
+{
+}
+
+void
+OlsrLinkLayerFeedbackTestCase::DoRun()
+{
+    Ptr<RoutingProtocol> protocol = CreateObject<RoutingProtocol>();
+    protocol->m_mainAddress = Ipv4Address("10.0.0.1");
+    OlsrState& state = protocol->m_state;
+
+    LinkTuple link;
+    link.localIfaceAddr = Ipv4Address("10.0.0.1");
+    link.neighborIfaceAddr = Ipv4Address("10.0.0.2");
+    link.symTime = Seconds(4);
+    link.asymTime = Seconds(4);
+    link.time = Seconds(4);
+    state.InsertLinkTuple(link);
+    NeighborTuple neighbor;
+    neighbor.neighborMainAddr = Ipv4Address("10.0.0.2");
+    neighbor.status = NeighborTuple::STATUS_SYM;
+    neighbor.willingness = Willingness::DEFAULT;
+    state.InsertNeighborTuple(neighbor);
+    MprSelectorTuple selector;
+    selector.mainAddr = Ipv4Address("10.0.0.2");
+    selector.expirationTime = Seconds(4);
+    state.InsertMprSelectorTuple(selector);
+
+    // Unknown neighbors are ignored.
+    protocol->LinkLayerNeighborLoss(Ipv4Address("10.0.0.3"));
+    NS_TEST_EXPECT_MSG_EQ(state.GetLinks().size(), 1, "Unexpected link set change");
+
+    protocol->LinkLayerNeighborLoss(Ipv4Address("10.0.0.2"));
+    const LinkTuple* lost = state.FindLinkTuple(Ipv4Address("10.0.0.2"));
+    NS_TEST_ASSERT_MSG_EQ((lost != nullptr), true, "The lost link must be kept");
+    NS_TEST_EXPECT_MSG_LT(lost->symTime, Simulator::Now(), "The link must not be symmetric");
+    NS_TEST_EXPECT_MSG_LT(lost->asymTime, Simulator::Now(), "The link must be advertised lost");
+    NS_TEST_EXPECT_MSG_EQ(lost->time, Seconds(6), "The link must be kept a neighbor hold time");
+    const NeighborTuple* neighborTuple = state.FindNeighborTuple(Ipv4Address("10.0.0.2"));
+    NS_TEST_ASSERT_MSG_EQ((neighborTuple != nullptr), true, "The neighbor tuple must be kept");
+    NS_TEST_EXPECT_MSG_EQ(neighborTuple->status,
+                          NeighborTuple::STATUS_NOT_SYM,
+                          "The neighbor must not be symmetric");
+    NS_TEST_EXPECT_MSG_EQ(state.GetMprSelectors().size(), 0, "The MPR selector must be lost");
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the filter of the Wi-Fi MAC transmission failures
+ *
+ * Only the data frames to a unicast address which reached the retry limit
+ * must cause the loss of the neighbors found in the ARP cache.
+ */
+class OlsrTxErrorFilterTestCase : public TestCase
+{
+  public:
+    OlsrTxErrorFilterTestCase();
+    void DoRun() override;
+};
+
+OlsrTxErrorFilterTestCase::OlsrTxErrorFilterTestCase()
+    : TestCase("Check OLSR filter of the MAC transmission failures")
+{
+}
+
+void
+OlsrTxErrorFilterTestCase::DoRun()
+{
+    // A node at 10.0.0.1, with the symmetric neighbors 10.0.0.2 and 10.0.0.3.
+    NodeContainer c;
+    c.Create(1);
+    OlsrHelper olsr;
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(olsr);
+    internet.Install(c);
+    SimpleNetDeviceHelper simpleNetHelper;
+    NetDeviceContainer nd = simpleNetHelper.Install(c);
+    Ipv4AddressHelper ipv4Address;
+    ipv4Address.SetBase("10.0.0.0", "255.255.255.0");
+    ipv4Address.Assign(nd);
+
+    Ptr<Ipv4L3Protocol> ipv4 = c.Get(0)->GetObject<Ipv4L3Protocol>();
+    Ptr<RoutingProtocol> protocol = DynamicCast<RoutingProtocol>(ipv4->GetRoutingProtocol());
+    NS_TEST_ASSERT_MSG_NE(protocol, nullptr, "OLSR must be the routing protocol");
+    protocol->m_mainAddress = Ipv4Address("10.0.0.1");
+    OlsrState& state = protocol->m_state;
+    Ipv4Address unicastNeighbor("10.0.0.2");
+    Ipv4Address groupNeighbor("10.0.0.3");
+    for (const auto& addr : {unicastNeighbor, groupNeighbor})
+    {
+        LinkTuple link;
+        link.localIfaceAddr = Ipv4Address("10.0.0.1");
+        link.neighborIfaceAddr = addr;
+        link.symTime = Seconds(4);
+        link.asymTime = Seconds(4);
+        link.time = Seconds(4);
+        state.InsertLinkTuple(link);
+        NeighborTuple neighbor;
+        neighbor.neighborMainAddr = addr;
+        neighbor.status = NeighborTuple::STATUS_SYM;
+        neighbor.willingness = Willingness::DEFAULT;
+        state.InsertNeighborTuple(neighbor);
+    }
+
+    // The second neighbor is resolved to a group address.
+    Mac48Address unicastMac("00:00:00:00:00:02");
+    Mac48Address groupMac("01:00:5e:00:00:03");
+    Ptr<ArpCache> arpCache = ipv4->GetInterface(1)->GetArpCache();
+    NS_TEST_ASSERT_MSG_NE(arpCache, nullptr, "The interface must have an ARP cache");
+    for (const auto& [addr, mac] : {std::make_pair(unicastNeighbor, unicastMac),
+                                    std::make_pair(groupNeighbor, groupMac)})
+    {
+        ArpCache::Entry* entry = arpCache->Add(addr);
+        entry->SetMacAddress(mac);
+        entry->MarkPermanent();
+    }
+
+    auto isSymmetric = [&state](Ipv4Address addr) {
+        const LinkTuple* link = state.FindLinkTuple(addr);
+        return link != nullptr && link->symTime >= Simulator::Now();
+    };
+    auto dropFrame = [&protocol](WifiMacDropReason reason, WifiMacType type, Mac48Address to) {
+        WifiMacHeader hdr;
+        hdr.SetType(type);
+        hdr.SetAddr1(to);
+        protocol->NotifyTxError(reason, Create<WifiMpdu>(Create<Packet>(), hdr));
+    };
+
+    dropFrame(WIFI_MAC_DROP_FAILED_ENQUEUE, WIFI_MAC_DATA, unicastMac);
+    NS_TEST_EXPECT_MSG_EQ(isSymmetric(unicastNeighbor), true, "A full queue is not a loss");
+    dropFrame(WIFI_MAC_DROP_REACHED_RETRY_LIMIT, WIFI_MAC_MGT_ACTION, unicastMac);
+    NS_TEST_EXPECT_MSG_EQ(isSymmetric(unicastNeighbor), true, "Management frames are ignored");
+    dropFrame(WIFI_MAC_DROP_REACHED_RETRY_LIMIT, WIFI_MAC_DATA, groupMac);
+    NS_TEST_EXPECT_MSG_EQ(isSymmetric(groupNeighbor), true, "Group addresses are ignored");
+
+    dropFrame(WIFI_MAC_DROP_REACHED_RETRY_LIMIT, WIFI_MAC_DATA, unicastMac);
+    NS_TEST_EXPECT_MSG_EQ(isSymmetric(unicastNeighbor), false, "The neighbor must be lost");
+    NS_TEST_EXPECT_MSG_EQ(isSymmetric(groupNeighbor), true, "The other neighbor must be kept");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the control plane profiler
+ */
+class OlsrProfilerTestCase : public TestCase
+{
+  public:
+    OlsrProfilerTestCase();
+    void DoRun() override;
+};
+
+OlsrProfilerTestCase::OlsrProfilerTestCase()
+    : TestCase("Check OLSR control plane profiler")
+{
+}
+
+void
+OlsrProfilerTestCase::DoRun()
+{
+    Profiler profiler;
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        Profiler::Scope scope(profiler, ProfilePhase::PROCESS_TC);
+        scope.AddTuples(3);
+        scope.SetTableSize(i + 5);
+    }
+    const ProfileCounters& counters = profiler.GetCounters(ProfilePhase::PROCESS_TC);
+    NS_TEST_EXPECT_MSG_EQ(counters.invocations, 2, "Wrong number of invocations");
+    NS_TEST_EXPECT_MSG_EQ(counters.tuples, 6, "Wrong number of tuples");
+    NS_TEST_EXPECT_MSG_EQ(counters.tableSize, 6, "The last table size must be kept");
+    NS_TEST_EXPECT_MSG_EQ(profiler.GetCounters(ProfilePhase::PROCESS_HELLO).invocations,
+                          0,
+                          "Other phases must not be affected");
+
+    std::ostringstream csv;
+    Profiler::PrintCsvHeader(csv);
+    profiler.PrintCsv(csv, Seconds(1), 7);
+    std::string line;
+    std::istringstream lines(csv.str());
+    uint32_t nLines = 0;
+    while (std::getline(lines, line))
+    {
+        nLines++;
+        if (line.find("ProcessTc") != std::string::npos)
+        {
+            NS_TEST_EXPECT_MSG_EQ(line.substr(0, 14), "1,7,ProcessTc,", "Wrong CSV line");
+        }
+    }
+    NS_TEST_EXPECT_MSG_EQ(nLines,
+                          static_cast<uint32_t>(ProfilePhase::COUNT) + 1,
+                          "One CSV line per phase expected");
+
+    profiler.Reset();
+    NS_TEST_EXPECT_MSG_EQ(profiler.GetCounters(ProfilePhase::PROCESS_TC).invocations,
+                          0,
+                          "The counters must be reset");
+
+    // The protocol is only instrumented when profiling is enabled at build time.
+    Ptr<RoutingProtocol> protocol = CreateObject<RoutingProtocol>();
+    protocol->m_mainAddress = Ipv4Address("10.0.0.1");
+    protocol->AddEntry(Ipv4Address("10.0.0.2"), Ipv4Address("10.0.0.2"), 1, 1);
+    protocol->MprComputation();
+    protocol->RoutingTableComputation();
+#ifdef NS3_OLSR_PROFILING
+    const uint64_t expected = 1;
+#else
+    const uint64_t expected = 0;
+#endif
+    const Profiler& protocolProfiler = protocol->GetProfiler();
+    NS_TEST_EXPECT_MSG_EQ(protocolProfiler.GetCounters(ProfilePhase::MPR_COMPUTATION).invocations,
+                          expected,
+                          "Wrong number of MPR computations");
+    NS_TEST_EXPECT_MSG_EQ(
+        protocolProfiler.GetCounters(ProfilePhase::ROUTING_TABLE_COMPUTATION).invocations,
+        expected,
+        "Wrong number of routing table computations");
+    protocol->ResetProfiler();
+    NS_TEST_EXPECT_MSG_EQ(
+        protocolProfiler.GetCounters(ProfilePhase::ROUTING_TABLE_COMPUTATION).invocations,
+        0,
+        "The counters must be reset");
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the aggregation of forwarded messages
+ */
+class OlsrForwardAggregationTestCase : public TestCase
+{
+  public:
+    OlsrForwardAggregationTestCase();
+    void DoRun() override;
+
+  private:
+    /**
+     * Builds a TC message.
+     * \param type The message type (TC, LQ_TC or DELTA_TC).
+     * \param originator The originator of the message.
+     * \param ansn The ANSN of the message.
+     * \returns The message.
+     */
+    MessageHeader BuildTc(MessageHeader::MessageType type, Ipv4Address originator, uint16_t ansn);
+
+    /**
+     * Builds a MID message.
+     * \param addresses The number of interface addresses.
+     * \returns The message, of size 12 + 4 * addresses bytes.
+     */
+    MessageHeader BuildMid(uint32_t addresses);
+};
+
+OlsrForwardAggregationTestCase::OlsrForwardAggregationTestCase()
+    : TestCase("Check OLSR aggregation of forwarded messages")
+{
+}
+
+MessageHeader
+OlsrForwardAggregationTestCase::BuildTc(MessageHeader::MessageType type,
+                                        Ipv4Address originator,
+                                        uint16_t ansn)
+{
+    MessageHeader msg;
+    msg.SetMessageType(type);
+    msg.SetOriginatorAddress(originator);
+    msg.GetTc().ansn = ansn;
+    return msg;
+}
+
+MessageHeader
+OlsrForwardAggregationTestCase::BuildMid(uint32_t addresses)
+{
+    MessageHeader msg;
+    msg.GetMid().interfaceAddresses.assign(addresses, Ipv4Address("10.1.0.1"));
+    return msg;
+}
+
+void
+OlsrForwardAggregationTestCase::DoRun()
+{
+    Ptr<RoutingProtocol> protocol = CreateObject<RoutingProtocol>();
+    MessageList& queue = protocol->m_queuedMessages;
+
+    Ipv4Address a("10.0.0.5");
+    Ipv4Address b("10.0.0.6");
+    queue.push_back(BuildTc(MessageHeader::TC_MESSAGE, a, 3));
+    queue.push_back(BuildTc(MessageHeader::DELTA_TC_MESSAGE, a, 4));
+    queue.push_back(BuildMid(1));
+    queue.push_back(BuildTc(MessageHeader::TC_MESSAGE, b, 1));
+    queue.push_back(BuildTc(MessageHeader::TC_MESSAGE, a, 5));
+    queue.push_back(BuildTc(MessageHeader::DELTA_TC_MESSAGE, a, 6));
+
+    // The full TC message with ANSN 5 supersedes the older TC and DELTA_TC
+    // messages of the same originator, but not the newer DELTA_TC message.
+    protocol->DropSupersededTcMessages();
+    NS_TEST_ASSERT_MSG_EQ(queue.size(), 4, "Two messages must be dropped");
+    NS_TEST_EXPECT_MSG_EQ(queue[0].GetMessageType(), MessageHeader::MID_MESSAGE, "Wrong message");
+    NS_TEST_EXPECT_MSG_EQ(queue[1].GetOriginatorAddress(), b, "Wrong originator");
+    NS_TEST_EXPECT_MSG_EQ(queue[2].GetTc().ansn, 5, "Wrong ANSN");
+    NS_TEST_EXPECT_MSG_EQ(queue[3].GetTc().ansn, 6, "Wrong ANSN");
+
+    // First fit: the 16 bytes messages fill the room left by the 24 bytes ones,
+    // and the oversized message is sent alone.
+    queue.clear();
+    queue.push_back(BuildMid(3));
+    queue.push_back(BuildMid(3));
+    queue.push_back(BuildMid(1));
+    queue.push_back(BuildMid(12));
+    queue.push_back(BuildMid(1));
+    std::vector<MessageList> packets = protocol->PackQueuedMessages(40);
+    NS_TEST_ASSERT_MSG_EQ(packets.size(), 3, "Wrong number of packets");
+    NS_TEST_EXPECT_MSG_EQ(packets[0].size(), 2, "Wrong number of messages");
+    NS_TEST_EXPECT_MSG_EQ(packets[0][1].GetSerializedSize(), 16, "Wrong message");
+    NS_TEST_EXPECT_MSG_EQ(packets[1].size(), 2, "Wrong number of messages");
+    NS_TEST_EXPECT_MSG_EQ(packets[1][1].GetSerializedSize(), 16, "Wrong message");
+    NS_TEST_EXPECT_MSG_EQ(packets[2].size(), 1, "The oversized message must be alone");
+    NS_TEST_EXPECT_MSG_EQ(packets[2][0].GetSerializedSize(), 60, "Wrong message");
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the routing tables installed by the oracle
+ */
+class OlsrOracleTestCase : public TestCase
+{
+  public:
+    OlsrOracleTestCase();
+    void DoRun() override;
+};
+
+OlsrOracleTestCase::OlsrOracleTestCase()
+    : TestCase("Check OLSR routing tables set by an oracle")
+{
+}
+
+void
+OlsrOracleTestCase::DoRun()
+{
+    Ptr<RoutingProtocol> protocol = CreateObject<RoutingProtocol>();
+    protocol->m_mainAddress = Ipv4Address("10.0.0.1");
+
+    // 10.0.0.1 -- 10.0.0.2 -- 10.0.0.3, where 10.0.0.3 also owns 10.1.0.3.
+    std::vector<RoutingTableEntry> entries;
+    RoutingTableEntry entry;
+    entry.destAddr = Ipv4Address("10.0.0.2");
+    entry.nextAddr = Ipv4Address("10.0.0.2");
+    entry.interface = 1;
+    entry.distance = 1;
+    entries.push_back(entry);
+    entry.destAddr = Ipv4Address("10.0.0.3");
+    entry.nextAddr = Ipv4Address("10.0.0.2");
+    entry.distance = 2;
+    entries.push_back(entry);
+    entry.destAddr = Ipv4Address("10.1.0.3");
+    entries.push_back(entry);
+
+    uint32_t generation = protocol->GetRoutingTableGeneration();
+    protocol->SetRoutingTableEntries(entries);
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetRoutingTableEntries().size(), 3, "Wrong number of routes");
+    NS_TEST_EXPECT_MSG_NE(protocol->GetRoutingTableGeneration(),
+                          generation,
+                          "The generation must change with the routing table");
+
+    RoutingTableEntry sendEntry;
+    NS_TEST_ASSERT_MSG_EQ(protocol->FindSendEntry(*protocol->FindRoutingTableEntry("10.1.0.3"),
+                                                  sendEntry),
+                          true,
+                          "The next hop of 10.1.0.3 must be reachable");
+    NS_TEST_EXPECT_MSG_EQ(sendEntry.destAddr, Ipv4Address("10.0.0.2"), "Wrong next hop");
+
+    generation = protocol->GetRoutingTableGeneration();
+    protocol->SetRoutingTableEntries(entries);
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetRoutingTableGeneration(),
+                          generation,
+                          "The generation must not change with the same routing table");
+
+    entries.pop_back();
+    protocol->SetRoutingTableEntries(entries);
+    NS_TEST_EXPECT_MSG_EQ((protocol->FindRoutingTableEntry("10.1.0.3") == nullptr),
+                          true,
+                          "The route to 10.1.0.3 must be replaced");
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the shortest paths computed by OlsrHelper::EnableOracle
+ */
+class OlsrHelperOracleTestCase : public TestCase
+{
+  public:
+    OlsrHelperOracleTestCase();
+    void DoRun() override;
+
+  private:
+    /**
+     * Checks the routes of a node against the expected next hops and distances.
+     * \param node The node.
+     * \param expected The expected (next hop, distance) of each destination.
+     */
+    void CheckRoutes(Ptr<Node> node,
+                     const std::map<Ipv4Address, std::pair<Ipv4Address, uint32_t>>& expected);
+};
+
+OlsrHelperOracleTestCase::OlsrHelperOracleTestCase()
+    : TestCase("Check the shortest paths of the OLSR oracle")
+{
+}
+
+void
+OlsrHelperOracleTestCase::CheckRoutes(
+    Ptr<Node> node,
+    const std::map<Ipv4Address, std::pair<Ipv4Address, uint32_t>>& expected)
+{
+    Ptr<RoutingProtocol> olsr =
+        DynamicCast<RoutingProtocol>(node->GetObject<Ipv4>()->GetRoutingProtocol());
+    NS_TEST_ASSERT_MSG_NE(olsr, nullptr, "OLSR must be the routing protocol");
+    std::vector<RoutingTableEntry> entries = olsr->GetRoutingTableEntries();
+    NS_TEST_EXPECT_MSG_EQ(entries.size(), expected.size(), "Wrong number of routes");
+    for (const auto& entry : entries)
+    {
+        auto i = expected.find(entry.destAddr);
+        NS_TEST_ASSERT_MSG_EQ((i != expected.end()),
+                              true,
+                              "Unexpected route to " << entry.destAddr);
+        NS_TEST_EXPECT_MSG_EQ(entry.nextAddr, i->second.first, "Wrong next hop");
+        NS_TEST_EXPECT_MSG_EQ(entry.distance, i->second.second, "Wrong distance");
+        NS_TEST_EXPECT_MSG_EQ(entry.interface, 1, "Wrong interface");
+    }
+}
+
+void
+OlsrHelperOracleTestCase::DoRun()
+{
+    // 10.0.0.1 -- 10.0.0.2 -- 10.0.0.3 -- 10.0.0.4, 100 m apart with a range of 150 m.
+    NodeContainer c;
+    c.Create(4);
+    MobilityHelper mobility;
+    Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator>();
+    for (uint32_t i = 0; i < c.GetN(); i++)
+    {
+        positions->Add(Vector(100 * i, 0, 0));
+    }
+    mobility.SetPositionAllocator(positions);
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.Install(c);
+
+    OlsrHelper olsr;
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(olsr);
+    internet.Install(c);
+    SimpleNetDeviceHelper simpleNetHelper;
+    NetDeviceContainer nd = simpleNetHelper.Install(c);
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase("10.0.0.0", "255.255.255.0");
+    ipv4.Assign(nd);
+
+    olsr.EnableOracle(c, 150, Seconds(1), 2);
+
+    Simulator::Stop(Seconds(0.5));
+    Simulator::Run();
+    CheckRoutes(c.Get(0),
+                {{Ipv4Address("10.0.0.2"), {Ipv4Address("10.0.0.2"), 1}},
+                 {Ipv4Address("10.0.0.3"), {Ipv4Address("10.0.0.2"), 2}},
+                 {Ipv4Address("10.0.0.4"), {Ipv4Address("10.0.0.2"), 3}}});
+    CheckRoutes(c.Get(2),
+                {{Ipv4Address("10.0.0.1"), {Ipv4Address("10.0.0.2"), 2}},
+                 {Ipv4Address("10.0.0.2"), {Ipv4Address("10.0.0.2"), 1}},
+                 {Ipv4Address("10.0.0.4"), {Ipv4Address("10.0.0.4"), 1}}});
+
+    // Move the last node to the other end of the line; the next epoch must follow.
+    c.Get(3)->GetObject<MobilityModel>()->SetPosition(Vector(-100, 0, 0));
+    Simulator::Stop(Seconds(1));
+    Simulator::Run();
+    CheckRoutes(c.Get(0),
+                {{Ipv4Address("10.0.0.2"), {Ipv4Address("10.0.0.2"), 1}},
+                 {Ipv4Address("10.0.0.3"), {Ipv4Address("10.0.0.2"), 2}},
+                 {Ipv4Address("10.0.0.4"), {Ipv4Address("10.0.0.4"), 1}}});
+    CheckRoutes(c.Get(2),
+                {{Ipv4Address("10.0.0.1"), {Ipv4Address("10.0.0.2"), 2}},
+                 {Ipv4Address("10.0.0.2"), {Ipv4Address("10.0.0.2"), 1}},
+                 {Ipv4Address("10.0.0.4"), {Ipv4Address("10.0.0.2"), 3}}});
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the HNA routes
+ */
+class OlsrHnaRoutesTestCase : public TestCase
+{
+  public:
+    OlsrHnaRoutesTestCase();
+    void DoRun() override;
+
+  private:
+    /**
+     * Checks the HNA routes of a node against the expected gateways and distances.
+     * \param protocol The OLSR routing protocol of the node.
+     * \param expected The expected (gateway, distance) of each network.
+     */
+    void CheckHnaRoutes(Ptr<RoutingProtocol> protocol,
+                        const std::map<Ipv4Address, std::pair<Ipv4Address, uint32_t>>& expected);
+};
+
+OlsrHnaRoutesTestCase::OlsrHnaRoutesTestCase()
+    : TestCase("Check the OLSR HNA routes")
+{
+}
+
+void
+OlsrHnaRoutesTestCase::CheckHnaRoutes(
+    Ptr<RoutingProtocol> protocol,
+    const std::map<Ipv4Address, std::pair<Ipv4Address, uint32_t>>& expected)
+{
+    Ptr<Ipv4StaticRouting> table = protocol->m_hnaRoutingTable;
+    NS_TEST_ASSERT_MSG_EQ(table->GetNRoutes(), expected.size(), "Wrong number of HNA routes");
+    NS_TEST_ASSERT_MSG_EQ(protocol->m_hnaRoutes.size(),
+                          expected.size(),
+                          "The HNA routes must mirror the routing table");
+    for (uint32_t i = 0; i < table->GetNRoutes(); i++)
+    {
+        Ipv4RoutingTableEntry route = table->GetRoute(i);
+        auto j = expected.find(route.GetDestNetwork());
+        NS_TEST_ASSERT_MSG_EQ((j != expected.end()),
+                              true,
+                              "Unexpected route to " << route.GetDestNetwork());
+        NS_TEST_EXPECT_MSG_EQ(route.GetGateway(), j->second.first, "Wrong gateway");
+        NS_TEST_EXPECT_MSG_EQ(table->GetMetric(i), j->second.second, "Wrong distance");
+        NS_TEST_EXPECT_MSG_EQ(route.GetInterface(), 1, "Wrong interface");
+        NS_TEST_EXPECT_MSG_EQ(protocol->m_hnaRoutes[i].first.networkAddr,
+                              route.GetDestNetwork(),
+                              "The HNA routes must be in the order of the routing table");
+        NS_TEST_EXPECT_MSG_EQ(protocol->m_hnaRoutes[i].second.nextAddr,
+                              route.GetGateway(),
+                              "The HNA routes must be in the order of the routing table");
+    }
+}
+
+void
+OlsrHnaRoutesTestCase::DoRun()
+{
+    // A single node, 10.0.0.1, with the neighbors 10.0.0.2 and 10.0.0.3 and
+    // the 2-hop neighbor 10.0.0.4, through 10.0.0.3.
+    NodeContainer c;
+    c.Create(1);
+    OlsrHelper olsr;
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(olsr);
+    internet.Install(c);
+    SimpleNetDeviceHelper simpleNetHelper;
+    NetDeviceContainer nd = simpleNetHelper.Install(c);
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase("10.0.0.0", "255.255.255.0");
+    ipv4.Assign(nd);
+
+    Ptr<RoutingProtocol> protocol =
+        DynamicCast<RoutingProtocol>(c.Get(0)->GetObject<Ipv4>()->GetRoutingProtocol());
+    NS_TEST_ASSERT_MSG_NE(protocol, nullptr, "OLSR must be the routing protocol");
+    protocol->m_mainAddress = Ipv4Address("10.0.0.1");
+    OlsrState& state = protocol->m_state;
+    for (const char* neighborAddr : {"10.0.0.2", "10.0.0.3"})
+    {
+        LinkTuple link;
+        link.localIfaceAddr = Ipv4Address("10.0.0.1");
+        link.neighborIfaceAddr = Ipv4Address(neighborAddr);
+        link.symTime = Seconds(100);
+        link.asymTime = Seconds(100);
+        link.time = Seconds(100);
+        state.InsertLinkTuple(link);
+        NeighborTuple neighbor;
+        neighbor.neighborMainAddr = Ipv4Address(neighborAddr);
+        neighbor.status = NeighborTuple::STATUS_SYM;
+        neighbor.willingness = Willingness::DEFAULT;
+        state.InsertNeighborTuple(neighbor);
+    }
+    TwoHopNeighborTuple twoHopNeighbor;
+    twoHopNeighbor.neighborMainAddr = Ipv4Address("10.0.0.3");
+    twoHopNeighbor.twoHopNeighborAddr = Ipv4Address("10.0.0.4");
+    twoHopNeighbor.expirationTime = Seconds(100);
+    state.InsertTwoHopNeighborTuple(twoHopNeighbor);
+
+    auto association = [&state](const char* gatewayAddr, const char* networkAddr) {
+        AssociationTuple tuple;
+        tuple.gatewayAddr = Ipv4Address(gatewayAddr);
+        tuple.networkAddr = Ipv4Address(networkAddr);
+        tuple.netmask = Ipv4Mask("255.255.255.0");
+        tuple.expirationTime = Seconds(100);
+        return tuple;
+    };
+    state.InsertAssociationTuple(association("10.0.0.2", "172.16.1.0"));
+    state.InsertAssociationTuple(association("10.0.0.4", "172.16.2.0"));
+    state.InsertAssociationTuple(association("10.0.0.2", "172.16.3.0"));
+    state.InsertAssociationTuple(association("10.0.0.2", "172.16.5.0"));
+    // 172.16.3.0 is also announced by the node itself: no route is added for it.
+    state.InsertAssociation(Association{Ipv4Address("172.16.3.0"), Ipv4Mask("255.255.255.0")});
+
+    protocol->RoutingTableComputation();
+    CheckHnaRoutes(protocol,
+                   {{Ipv4Address("172.16.1.0"), {Ipv4Address("10.0.0.2"), 1}},
+                    {Ipv4Address("172.16.2.0"), {Ipv4Address("10.0.0.3"), 2}},
+                    {Ipv4Address("172.16.5.0"), {Ipv4Address("10.0.0.2"), 1}}});
+
+    // 172.16.1.0 is removed, the gateway of 172.16.2.0 becomes a neighbor,
+    // 172.16.4.0 is added, and 172.16.5.0 is kept after a removed route.
+    state.EraseAssociationTuple(association("10.0.0.2", "172.16.1.0"));
+    state.EraseAssociationTuple(association("10.0.0.4", "172.16.2.0"));
+    state.InsertAssociationTuple(association("10.0.0.3", "172.16.2.0"));
+    state.InsertAssociationTuple(association("10.0.0.3", "172.16.4.0"));
+
+    protocol->RoutingTableComputation();
+    CheckHnaRoutes(protocol,
+                   {{Ipv4Address("172.16.2.0"), {Ipv4Address("10.0.0.3"), 1}},
+                    {Ipv4Address("172.16.4.0"), {Ipv4Address("10.0.0.3"), 1}},
+                    {Ipv4Address("172.16.5.0"), {Ipv4Address("10.0.0.2"), 1}}});
+
+    // Without any change, the routes are kept.
+    protocol->RoutingTableComputation();
+    CheckHnaRoutes(protocol,
+                   {{Ipv4Address("172.16.2.0"), {Ipv4Address("10.0.0.3"), 1}},
+                    {Ipv4Address("172.16.4.0"), {Ipv4Address("10.0.0.3"), 1}},
+                    {Ipv4Address("172.16.5.0"), {Ipv4Address("10.0.0.2"), 1}}});
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the packets of the queued messages
+ */
+class OlsrQueuedMessagesTestCase : public TestCase
+{
+  public:
+    OlsrQueuedMessagesTestCase();
+    void DoRun() override;
+
+  private:
+    /**
+     * Records the OLSR messages of a packet sent by the node.
+     * \param packet The packet, with its IPv4 header.
+     * \param ipv4 The IPv4 stack of the node.
+     * \param interface The interface of the packet.
+     */
+    void Tx(Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+
+    std::vector<std::vector<uint8_t>> m_sent; //!< Bytes of the messages of each sent packet.
+};
+
+OlsrQueuedMessagesTestCase::OlsrQueuedMessagesTestCase()
+    : TestCase("Check the OLSR packets of the queued messages")
+{
+}
+
+void
+OlsrQueuedMessagesTestCase::Tx(Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+    Ptr<Packet> copy = packet->Copy();
+    Ipv4Header ipHeader;
+    copy->RemoveHeader(ipHeader);
+    UdpHeader udpHeader;
+    copy->RemoveHeader(udpHeader);
+    PacketHeader olsrPacketHeader;
+    copy->RemoveHeader(olsrPacketHeader);
+    NS_TEST_EXPECT_MSG_EQ(olsrPacketHeader.GetPacketLength(),
+                          olsrPacketHeader.GetSerializedSize() + copy->GetSize(),
+                          "Wrong OLSR packet length");
+    std::vector<uint8_t> bytes(copy->GetSize());
+    copy->CopyData(bytes.data(), bytes.size());
+    m_sent.push_back(bytes);
+}
+
+void
+OlsrQueuedMessagesTestCase::DoRun()
+{
+    NodeContainer c;
+    c.Create(1);
+    OlsrHelper olsr;
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(olsr);
+    internet.Install(c);
+    SimpleNetDeviceHelper simpleNetHelper;
+    NetDeviceContainer nd = simpleNetHelper.Install(c);
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase("10.0.0.0", "255.255.255.0");
+    ipv4.Assign(nd);
+
+    // Start OLSR, then drop its first messages to only send ours.
+    Simulator::Stop(Seconds(0));
+    Simulator::Run();
+    Ptr<RoutingProtocol> protocol =
+        DynamicCast<RoutingProtocol>(c.Get(0)->GetObject<Ipv4>()->GetRoutingProtocol());
+    NS_TEST_ASSERT_MSG_NE(protocol, nullptr, "OLSR must be the routing protocol");
+    protocol->m_queuedMessagesTimer.Cancel();
+    protocol->m_queuedMessages.clear();
+    c.Get(0)->GetObject<Ipv4L3Protocol>()->TraceConnectWithoutContext(
+        "Tx",
+        MakeCallback(&OlsrQueuedMessagesTestCase::Tx, this));
+
+    // More messages than fit in two packets, of different sizes.
+    const uint32_t maxMessages = 64;
+    MessageList messages;
+    for (uint16_t i = 0; i < 2 * maxMessages + 1; i++)
+    {
+        MessageHeader message;
+        message.SetVTime(Seconds(15));
+        message.SetOriginatorAddress(Ipv4Address("10.0.0.1"));
+        message.SetTimeToLive(255);
+        message.SetHopCount(0);
+        message.SetMessageSequenceNumber(i);
+        MessageHeader::Mid& mid = message.GetMid();
+        for (uint32_t j = 0; j <= i % 3; j++)
+        {
+            mid.interfaceAddresses.emplace_back(Ipv4Address("10.1.0.1").Get() + j);
+        }
+        messages.push_back(message);
+        protocol->QueueMessage(message, Seconds(1));
+    }
+    protocol->m_queuedMessagesTimer.Cancel();
+    protocol->SendQueuedMessages();
+    NS_TEST_EXPECT_MSG_EQ(protocol->m_queuedMessages.size(), 0, "The queue must be emptied");
+
+    NS_TEST_ASSERT_MSG_EQ(m_sent.size(), 3, "The messages must be sent in three packets");
+    for (uint32_t n = 0; n < m_sent.size(); n++)
+    {
+        // The bytes of the messages added as headers of a packet, back to front.
+        Ptr<Packet> expected = Create<Packet>();
+        auto first = messages.begin() + n * maxMessages;
+        auto last = first + std::min<std::size_t>(maxMessages, messages.end() - first);
+        for (auto message = last; message != first;)
+        {
+            message--;
+            expected->AddHeader(*message);
+        }
+        std::vector<uint8_t> bytes(expected->GetSize());
+        expected->CopyData(bytes.data(), bytes.size());
+        NS_TEST_EXPECT_MSG_EQ((m_sent[n] == bytes),
+                              true,
+                              "The bytes of packet " << n << " must not change");
+    }
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the interface index cache
+ */
+class OlsrInterfaceIndexesTestCase : public TestCase
+{
+  public:
+    OlsrInterfaceIndexesTestCase();
+    void DoRun() override;
+};
+
+OlsrInterfaceIndexesTestCase::OlsrInterfaceIndexesTestCase()
+    : TestCase("Check the OLSR interface index cache")
+{
+}
+
+void
+OlsrInterfaceIndexesTestCase::DoRun()
+{
+    // A node with the interfaces 1 (10.0.0.1) and 2 (10.1.0.1).
+    NodeContainer c;
+    c.Create(1);
+    OlsrHelper olsr;
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(olsr);
+    internet.Install(c);
+    SimpleNetDeviceHelper simpleNetHelper;
+    NetDeviceContainer nd = simpleNetHelper.Install(c);
+    nd.Add(simpleNetHelper.Install(c));
+    Ipv4AddressHelper ipv4Address;
+    ipv4Address.SetBase("10.0.0.0", "255.255.255.0");
+    ipv4Address.Assign(nd.Get(0));
+    ipv4Address.SetBase("10.1.0.0", "255.255.255.0");
+    ipv4Address.Assign(nd.Get(1));
+
+    Ptr<Ipv4L3Protocol> ipv4 = c.Get(0)->GetObject<Ipv4L3Protocol>();
+    Ptr<RoutingProtocol> protocol = DynamicCast<RoutingProtocol>(ipv4->GetRoutingProtocol());
+    NS_TEST_ASSERT_MSG_NE(protocol, nullptr, "OLSR must be the routing protocol");
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetInterfaceForAddress(Ipv4Address("10.0.0.1")),
+                          1,
+                          "Wrong interface of 10.0.0.1");
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetInterfaceForAddress(Ipv4Address("10.1.0.1")),
+                          2,
+                          "Wrong interface of 10.1.0.1");
+    NS_TEST_EXPECT_MSG_EQ(protocol->m_interfaceForDevice[nd.Get(1)->GetIfIndex()],
+                          2,
+                          "Wrong interface of the second device");
+
+    // Adding and removing an address through the IPv4 stack notifies OLSR.
+    Ipv4InterfaceAddress added(Ipv4Address("10.0.1.1"), Ipv4Mask("255.255.255.0"));
+    ipv4->AddAddress(1, added);
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetInterfaceForAddress(Ipv4Address("10.0.1.1")),
+                          1,
+                          "The added address must be found");
+    ipv4->RemoveAddress(1, Ipv4Address("10.0.0.1"));
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetInterfaceForAddress(Ipv4Address("10.0.0.1")),
+                          -1,
+                          "The removed address must not be found");
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetInterfaceForAddress(Ipv4Address("10.0.1.1")),
+                          1,
+                          "The other address of the interface must be kept");
+
+    // An address added behind the back of OLSR is found once the interface
+    // goes down, and the next one once it goes up again.
+    ipv4->GetInterface(2)->AddAddress(
+        Ipv4InterfaceAddress(Ipv4Address("10.1.1.1"), Ipv4Mask("255.255.255.0")));
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetInterfaceForAddress(Ipv4Address("10.1.1.1")),
+                          -1,
+                          "The cache must only be refreshed on notifications");
+    ipv4->SetDown(2);
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetInterfaceForAddress(Ipv4Address("10.1.1.1")),
+                          ipv4->GetInterfaceForAddress(Ipv4Address("10.1.1.1")),
+                          "The cache must be refreshed when the interface goes down");
+    ipv4->GetInterface(2)->RemoveAddress(1);
+    ipv4->SetUp(2);
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetInterfaceForAddress(Ipv4Address("10.1.1.1")),
+                          -1,
+                          "The cache must be refreshed when the interface goes up");
+    NS_TEST_EXPECT_MSG_EQ(protocol->GetInterfaceForAddress(Ipv4Address("10.1.0.1")),
+                          2,
+                          "Wrong interface of 10.1.0.1");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the routes of the link quality extension
+ */
+class OlsrLinkQualityRoutesTestCase : public TestCase
+{
+  public:
+    OlsrLinkQualityRoutesTestCase();
+    void DoRun() override;
+};
+
+OlsrLinkQualityRoutesTestCase::OlsrLinkQualityRoutesTestCase()
+    : TestCase("Check OLSR link quality routes")
+{
+}
+
+void
+OlsrLinkQualityRoutesTestCase::DoRun()
+{
+    NodeContainer c;
+    c.Create(1);
+    OlsrHelper olsr;
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(olsr);
+    internet.Install(c);
+    SimpleNetDeviceHelper simpleNetHelper;
+    NetDeviceContainer nd = simpleNetHelper.Install(c);
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase("10.0.0.0", "255.255.255.0");
+    ipv4.Assign(nd);
+
+    Ptr<RoutingProtocol> protocol =
+        DynamicCast<RoutingProtocol>(c.Get(0)->GetObject<Ipv4>()->GetRoutingProtocol());
+    NS_TEST_ASSERT_MSG_NE(protocol, nullptr, "OLSR must be the routing protocol");
+    protocol->m_mainAddress = Ipv4Address("10.0.0.1");
+    OlsrState& state = protocol->m_state;
+
+    /*
+     *  1 -- 2 -- 4
+     *  |         |
+     *  3 -- 5 ---+
+     *
+     * The link to 2 is lossy (ETX 11.1) and the other links are perfect
+     * (ETX 1): the cheapest path to 4 goes through 3 and 5, in 3 hops.
+     */
+    LinkTuple link;
+    link.localIfaceAddr = Ipv4Address("10.0.0.1");
+    link.symTime = Seconds(3600);
+    link.asymTime = Seconds(3600);
+    link.time = Seconds(3600);
+    link.neighborIfaceAddr = Ipv4Address("10.0.0.2");
+    link.linkQuality = 0.3;
+    link.neighborLinkQuality = 0.3;
+    state.InsertLinkTuple(link);
+    link.neighborIfaceAddr = Ipv4Address("10.0.0.3");
+    link.linkQuality = 1;
+    link.neighborLinkQuality = 1;
+    state.InsertLinkTuple(link);
+
+    NeighborTuple neighbor;
+    neighbor.status = NeighborTuple::STATUS_SYM;
+    neighbor.willingness = Willingness::DEFAULT;
+    neighbor.neighborMainAddr = Ipv4Address("10.0.0.2");
+    state.InsertNeighborTuple(neighbor);
+    neighbor.neighborMainAddr = Ipv4Address("10.0.0.3");
+    state.InsertNeighborTuple(neighbor);
+
+    TwoHopNeighborTuple twoHopNeighbor;
+    twoHopNeighbor.expirationTime = Seconds(3600);
+    twoHopNeighbor.neighborMainAddr = Ipv4Address("10.0.0.2");
+    twoHopNeighbor.twoHopNeighborAddr = Ipv4Address("10.0.0.4");
+    state.InsertTwoHopNeighborTuple(twoHopNeighbor);
+    twoHopNeighbor.neighborMainAddr = Ipv4Address("10.0.0.3");
+    twoHopNeighbor.twoHopNeighborAddr = Ipv4Address("10.0.0.5");
+    state.InsertTwoHopNeighborTuple(twoHopNeighbor);
+
+    TopologyTuple topology;
+    topology.expirationTime = Seconds(3600);
+    topology.sequenceNumber = 1;
+    topology.lastAddr = Ipv4Address("10.0.0.5");
+    topology.destAddr = Ipv4Address("10.0.0.4");
+    state.InsertTopologyTuple(topology);
+
+    // Without the extension, the path with the fewest hops is chosen.
+    protocol->RoutingTableComputation();
+    const RoutingTableEntry* entry = protocol->FindRoutingTableEntry("10.0.0.4");
+    NS_TEST_ASSERT_MSG_EQ((entry != nullptr), true, "A route to 10.0.0.4 must exist");
+    NS_TEST_EXPECT_MSG_EQ(entry->nextAddr, Ipv4Address("10.0.0.2"), "Wrong min-hop next hop");
+    NS_TEST_EXPECT_MSG_EQ(entry->distance, 2, "Wrong min-hop distance");
+
+    protocol->SetAttribute("LinkQuality", BooleanValue(true));
+    protocol->RoutingTableComputation();
+    entry = protocol->FindRoutingTableEntry("10.0.0.4");
+    NS_TEST_ASSERT_MSG_EQ((entry != nullptr), true, "A route to 10.0.0.4 must exist");
+    NS_TEST_EXPECT_MSG_EQ(entry->nextAddr, Ipv4Address("10.0.0.3"), "Wrong min-ETX next hop");
+    NS_TEST_EXPECT_MSG_EQ(entry->distance, 3, "The distance must stay in hops");
+    entry = protocol->FindRoutingTableEntry("10.0.0.2");
+    NS_TEST_ASSERT_MSG_EQ((entry != nullptr), true, "The lossy neighbor must stay reachable");
+    NS_TEST_EXPECT_MSG_EQ(entry->nextAddr, Ipv4Address("10.0.0.2"), "Wrong neighbor next hop");
+
+    // A link with an unknown quality is unusable.
+    state.FindLinkTuple(Ipv4Address("10.0.0.3"))->neighborLinkQuality = 0;
+    protocol->RoutingTableComputation();
+    entry = protocol->FindRoutingTableEntry("10.0.0.4");
+    NS_TEST_ASSERT_MSG_EQ((entry != nullptr), true, "A route to 10.0.0.4 must exist");
+    NS_TEST_EXPECT_MSG_EQ(entry->nextAddr, Ipv4Address("10.0.0.2"), "Wrong fallback next hop");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup olsr-test
+ * \ingroup tests
+ *
+ * Testcase for the link quality estimation
+ */
+class OlsrLinkQualityUpdateTestCase : public TestCase
+{
+  public:
+    OlsrLinkQualityUpdateTestCase();
+    void DoRun() override;
+};
+
+OlsrLinkQualityUpdateTestCase::OlsrLinkQualityUpdateTestCase()
+    : TestCase("Check OLSR link quality estimation")
+{
+}
+
+void
+OlsrLinkQualityUpdateTestCase::DoRun()
+{
+    Ptr<RoutingProtocol> protocol = CreateObject<RoutingProtocol>();
+    protocol->SetAttribute("LinkQualityAging", DoubleValue(0.5));
+    LinkTuple link;
+    link.neighborIfaceAddr = Ipv4Address("10.0.0.2");
+
+    // HELLO messages every second, at 1, 2 and 3 s, then at 6 s after two losses.
+    std::vector<double> qualities;
+    for (double t : {1.0, 2.0, 3.0, 6.0})
+    {
+        Simulator::Schedule(Seconds(t), [&protocol, &link, &qualities]() {
+            protocol->UpdateLinkQuality(link, Seconds(1));
+            qualities.push_back(link.linkQuality);
+        });
+    }
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(qualities.size(), 4, "One update per HELLO message");
+    NS_TEST_EXPECT_MSG_EQ_TOL(qualities[0], 0.5, 1e-9, "First HELLO message");
+    NS_TEST_EXPECT_MSG_EQ_TOL(qualities[1], 0.75, 1e-9, "Second HELLO message");
+    NS_TEST_EXPECT_MSG_EQ_TOL(qualities[2], 0.875, 1e-9, "Third HELLO message");
+    // The two lost HELLO messages age the estimation before the received one.
+    NS_TEST_EXPECT_MSG_EQ_TOL(qualities[3], 0.875 / 8 + 0.5, 1e-9, "HELLO after two losses");
+    NS_TEST_EXPECT_MSG_EQ(link.lastHelloTime, Seconds(6), "The last HELLO time must be updated");
+
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup olsr-test
  * \ingroup tests
@@ -190,6 +1709,23 @@ OlsrProtocolTestSuite::OlsrProtocolTestSuite()
     : TestSuite("routing-olsr", Type::UNIT)
 {
     AddTestCase(new OlsrMprTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new OlsrFisheyeTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new OlsrLinkQualityMprTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new OlsrDeltaTcTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new OlsrCheckpointTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new OlsrRoutingTableAccessTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new OlsrAdaptiveIntervalsTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new OlsrLinkLayerFeedbackTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new OlsrTxErrorFilterTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new OlsrProfilerTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new OlsrForwardAggregationTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new OlsrOracleTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new OlsrHelperOracleTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new OlsrHnaRoutesTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new OlsrQueuedMessagesTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new OlsrInterfaceIndexesTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new OlsrLinkQualityRoutesTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new OlsrLinkQualityUpdateTestCase(), TestCase::Duration::QUICK);
 }
 
 static OlsrProtocolTestSuite g_olsrProtocolTestSuite; //!< Static variable for test initialization
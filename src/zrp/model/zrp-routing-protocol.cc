@@ -142,13 +142,11 @@ bool ZrpRoutingProtocol::RouteInput (Ptr<const Packet> p, const Ipv4Header &head
 
 uint32_t ZrpRoutingProtocol::CalculateHopDistance (Ipv4Address dest){
 
-  std::vector<olsr::RoutingTableEntry> entries = m_olsr->GetRoutingTableEntries();
-  
-  for (const auto& entry : entries) {
-    NS_LOG_INFO("OLSR 경로 발견: 목적지 = " << entry.destAddr << ", 거리 = " << entry.distance);
-    if (entry.destAddr == dest) {
-      return entry.distance;
-    }
+  const olsr::RoutingTableEntry* entry = m_olsr->FindRoutingTableEntry (dest);
+
+  if (entry != nullptr) {
+    NS_LOG_INFO("OLSR 경로 발견: 목적지 = " << entry->destAddr << ", 거리 = " << entry->distance);
+    return entry->distance;
   }
   
   // 경로를 찾지 못한 경우